@@ -10,17 +10,17 @@ void setup() {
 
   Wire.setClock(100000);
 
-  chip.begin();       // Initialize the chip
-
-  delay(100);
-
-  //Optionally, configure the chip as needed
-  chip.ResetMCU(true);
-  delay(100);
-  chip.enableLoadOTP(false);
-  chip.enableCharger(true);
-  delay(100);
-  chip.setMaxInputPowerOrBatteryCurrent(5000); //5A
+  chip.begin();       // Initialize the chip, returns once it answers
+
+  //Optionally, configure the chip as needed: reset it, wait until it answers and apply the settings
+  IP2366::Profile profile = {};
+  profile.set(IP2366_REG_SYS_CTL0, 0x01, 0x81); // En_LOADOTP off, charger on
+  profile.set(IP2366_REG_SYS_CTL3, IP2366::encodeMaxInputPowerOrBatteryCurrent(5000)); //5A
+  IP2366::ProvisionReport report;
+  if (!chip.resetAndProvision(profile, &report))
+    Serial.println("Provisioning failed");
+  Serial.print("Ready after [us]: ");
+  Serial.println(report.ready_us);
   chip.setTypeCMode(IP2366::TypeCMode::UFP);
 }
 
@@ -0,0 +1,34 @@
+#include <Wire.h>
+
+#include "IP2366.h"
+#include "IP2366FaultMonitor.h"
+
+IP2366WireBus bus;
+IP2366 device(bus);
+IP2366FaultMonitor faults(device, 5); // poll the fault registers every 5 ms
+
+void onFault(const IP2366FaultMonitor::Event & event, IP2366 & chip, void * context) {
+  // The output is already off (setCutOutput), keep the callback short
+  Serial.print("Fault: 0x");
+  Serial.println(event.faults, HEX);
+}
+
+void setup() {
+  Serial.begin(9600);
+  bus.setByteDelay(0); // shortest transactions for the fault path
+  device.begin();
+
+  faults.setCutOutput(IP2366::FAULT_VSYS_OVERCURRENT | IP2366::FAULT_VSYS_SHORT_CIRCUIT);
+  faults.setCallback(onFault);
+}
+
+void loop() {
+  faults.update(); // first, before any other bus traffic
+
+  // ... telemetry ...
+
+  if (faults.getLatched() && Serial.read() == 'c') {
+    faults.clear();
+    device.setOutputFeatures(true, true, true, true);
+  }
+}
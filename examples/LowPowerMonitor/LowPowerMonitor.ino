@@ -0,0 +1,46 @@
+#include <Wire.h>
+#define INT_PIN 2  // Change this to your desired pin
+
+#include "IP2366.h"
+#include "IP2366Sampler.h"
+#include "IP2366LowPowerMonitor.h"
+
+IP2366 device;
+IP2366Sampler sampler(device);
+IP2366LowPowerMonitor monitor(device, sampler);
+
+void printSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * context) {
+  Serial.print("Battery Voltage [mV]: ");
+  Serial.println(adc.VBATVoltage);
+}
+
+void setup() {
+  Serial.begin(9600);
+  device.setIntPin(INT_PIN); // before begin(), so begin() can wake the chip
+  if (!device.begin()) {
+    Serial.println("IP2366 not responding");
+    while (true) {}
+  }
+
+  sampler.subscribe(printSample);
+
+  IP2366LowPowerMonitor::Config config;
+  config.period_ms = 30000; // one window every 30 s
+  config.samples = 3;
+  config.sampleSpacing_ms = 20;
+  monitor.setConfig(config);
+  monitor.begin();
+}
+
+void loop() {
+  if (monitor.update()) {
+    IP2366LowPowerMonitor::Report report = monitor.getReport();
+    Serial.print("Awake [ms]: ");
+    Serial.print(report.awake_ms);
+    Serial.print(" Asleep [ms]: ");
+    Serial.print(report.asleep_ms);
+    Serial.print(" Energy [mJ]: ");
+    Serial.println(report.energy_mJ);
+  }
+  // Put the MCU into a light sleep here for up to monitor.getTimeToNextWindow() ms
+}
@@ -0,0 +1,29 @@
+// Prints the charger state as OpenMetrics text every 5 seconds, streamed in 64 byte chunks.
+// The same loop can feed a network client instead of Serial.
+#include <Wire.h>
+
+#include "IP2366.h"
+#include "IP2366Sampler.h"
+#include "IP2366Metrics.h"
+
+IP2366 device;
+IP2366Sampler sampler(device, 5000);
+IP2366MetricsExporter exporter("ip2366", "pack=\"1\"");
+
+void setup() {
+  Serial.begin(115200);
+  device.begin();
+}
+
+void loop() {
+  if (!sampler.update() || !sampler.isValid())
+    return;
+
+  IP2366::LockStats lockStats = device.getLockStats();
+  exporter.begin(sampler, &lockStats);
+
+  char chunk[64];
+  size_t length;
+  while ((length = exporter.read(chunk, sizeof(chunk))) > 0)
+    Serial.write((const uint8_t *)chunk, length);
+}
@@ -0,0 +1,96 @@
+// Runs the driver against the simulated register map, no IP2366 needed.
+// Each built-in scenario is replayed in real time and the detected states,
+// detection latency and bus usage are printed.
+#include "IP2366.h"
+#include "IP2366Sampler.h"
+#include "IP2366PdObserver.h"
+#include "IP2366Sim.h"
+
+struct Scenario {
+  const char * name;
+  const IP2366Scenario::Step * steps;
+  uint8_t length;
+};
+
+const Scenario scenarios[] = {
+  {"PD attach 20V", IP2366Scenario::pdAttach20V, IP2366Scenario::pdAttach20VLength},
+  {"CC to CV", IP2366Scenario::ccToCv, IP2366Scenario::ccToCvLength},
+  {"Vsys over-current", IP2366Scenario::vsysOverCurrent, IP2366Scenario::vsysOverCurrentLength},
+  {"Sleep mid-read", IP2366Scenario::sleepMidRead, IP2366Scenario::sleepMidReadLength},
+};
+const uint8_t scenarioCount = sizeof(scenarios) / sizeof(scenarios[0]);
+#define SCENARIO_TAIL_MS 2000 // keep sampling after the last step
+
+IP2366SimBus simBus;
+IP2366 device(simBus);
+IP2366Sampler sampler(device, 100);
+IP2366PdObserver observer(device);
+IP2366Scenario scenario(simBus);
+
+uint8_t current = 0;
+uint32_t start = 0;
+uint32_t overCurrentAt = 0;
+
+void onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * context) {
+  if (overCurrentAt == 0 && status.getSystemStatus().has(IP2366::SystemStatus::VSYS_OVERCURRENT))
+    overCurrentAt = millis() - start;
+}
+
+void startScenario() {
+  simBus.reset();
+  simBus.resetStats();
+  observer.clearHistory();
+  overCurrentAt = 0;
+  start = millis();
+  scenario.start(scenarios[current].steps, scenarios[current].length, start);
+}
+
+void report() {
+  const IP2366SimBus::Stats & stats = simBus.getStats();
+  IP2366::SystemStatus status = sampler.getStatus().getSystemStatus();
+
+  Serial.println(scenarios[current].name);
+  Serial.print("  Reads: ");
+  Serial.print(stats.reads);
+  Serial.print(" Writes: ");
+  Serial.print(stats.writes);
+  Serial.print(" Bytes: ");
+  Serial.print(stats.bytes);
+  Serial.print(" NACKs: ");
+  Serial.print(stats.nacks);
+  Serial.print(" Bus time [us]: ");
+  Serial.println(stats.busTime_us);
+  Serial.print("  Last error: ");
+  Serial.print(sampler.getLastError());
+  Serial.print(" Charge state: ");
+  Serial.println(static_cast<uint8_t>(status.chargeState()));
+  if (observer.getHistorySize() > 0) {
+    Serial.print("  PD contract [ms]: ");
+    Serial.print(observer.getHistory(0).contractLatency);
+    Serial.print(" Voltage: ");
+    Serial.println(observer.getHistory(0).voltage);
+  }
+  if (overCurrentAt != 0) {
+    Serial.print("  Over-current detected after [ms]: ");
+    Serial.println(overCurrentAt);
+  }
+}
+
+void setup() {
+  Serial.begin(9600);
+  device.begin();
+  sampler.subscribe(onSample);
+  startScenario();
+}
+
+void loop() {
+  scenario.update();
+  sampler.update();
+  observer.update();
+
+  if (scenario.isFinished() && millis() - start > scenarios[current].steps[scenarios[current].length - 1].at_ms + SCENARIO_TAIL_MS) {
+    report();
+    current = (current + 1) % scenarioCount;
+    startScenario();
+  }
+}
@@ -0,0 +1,119 @@
+// Host benchmark of the driver on IP2366SimBus: CPU time per operation and the bus cost (transactions,
+// payload bytes, wire time at 100 kHz) that the operation would have on the real chip.
+// Each operation runs on IP2366 and on StaticIP2366 (checked and unchecked) over the same simulated chip.
+//
+//   cmake -S . -B build && cmake --build build && ./build/extras/Benchmark/ip2366_benchmark [iterations]
+#include "IP2366.h"
+#include "IP2366Sim.h"
+#include "IP2366Static.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static uint64_t nowNs()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static volatile uint32_t sink; // keeps the results alive
+
+template <class Operation>
+static void run(const char * name, IP2366SimBus & bus, uint32_t iterations, Operation operation)
+{
+    for (uint32_t i = 0; i < iterations / 10; i++) // warm up
+        operation();
+
+    bus.resetStats();
+    uint64_t start = nowNs();
+    for (uint32_t i = 0; i < iterations; i++)
+        operation();
+    uint64_t elapsed = nowNs() - start;
+
+    const IP2366SimBus::Stats & stats = bus.getStats();
+    printf("%-46s %9.1f %7.2f %7.2f %7.2f %9.1f\n", name, (double)elapsed / iterations,
+           (double)stats.reads / iterations, (double)stats.writes / iterations, (double)stats.bytes / iterations,
+           (double)stats.busTime_us / iterations);
+}
+
+static void setup(IP2366SimBus & bus)
+{
+    bus.setRegister16(IP2366_REG_BATVADC_DAT0, 8000);
+    bus.setRegister16(IP2366_REG_VsysVADC_DAT0, 20000);
+    bus.setRegister16(IP2366_REG_IBATIADC_DAT0, 3000);
+    bus.setRegister16(IP2366_REG_ISYS_IADC_DAT0, 1500);
+    bus.setRegister16(IP2366_REG_Vsys_POW_DAT0, 30000);
+    bus.setRegister(IP2366_REG_STATE_CTL0, 0x22);
+    bus.setRegister(IP2366_REG_STATE_CTL2, 0x87);
+    bus.setRegister(IP2366_REG_TypeC_STATE, 0x90);
+    bus.setRegister(IP2366_REG_RECEIVED_PDO, 0x1F);
+}
+
+int main(int argc, char ** argv)
+{
+    uint32_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+    if (iterations == 0)
+        iterations = 1;
+
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    setup(bus);
+
+    printf("%-46s %9s %7s %7s %7s %9s\n", "operation", "ns/op", "reads", "writes", "bytes", "wire us");
+
+    run("IP2366 getVBATVoltage", bus, iterations, [&]() { sink = chip.getVBATVoltage(); });
+    run("IP2366 5 ADC getters", bus, iterations, [&]() {
+        sink = chip.getVBATVoltage() + chip.getVsysVoltage() + chip.getBATCurrent() + chip.getVsysCurrent() + chip.getVsysPower();
+    });
+    run("IP2366 readAdcSnapshot", bus, iterations, [&]() {
+        IP2366::AdcSnapshot adc;
+        chip.readAdcSnapshot(adc);
+        sink = adc.VBATVoltage;
+    });
+    run("IP2366 8 status getters", bus, iterations, [&]() {
+        sink = chip.isCharging() + chip.isChargeFull() + chip.isDischarging() + chip.isFastCharge() +
+               chip.isVbusPresent() + chip.isTypeCSinkConnected() + chip.isVsysOverCurrent() +
+               static_cast<uint8_t>(chip.getChargeState());
+    });
+    run("IP2366 getSystemStatus", bus, iterations, [&]() { sink = chip.getSystemStatus().raw(); });
+    run("IP2366 setChargeStopCurrent", bus, iterations, [&]() { chip.setChargeStopCurrent(300); });
+    run("IP2366 setMaxInputPowerOrBatteryCurrent", bus, iterations, [&]() { chip.setMaxInputPowerOrBatteryCurrent(5000); });
+
+    IP2366BusRef<IP2366SimBus> ref(bus);
+    StaticIP2366<0x75, IP2366BusRef<IP2366SimBus>> fixed(ref);
+    StaticIP2366<0x75, IP2366BusRef<IP2366SimBus>, IP2366UncheckedPolicy> unchecked(ref);
+
+    run("StaticIP2366 getVBATVoltage", bus, iterations, [&]() { sink = fixed.getVBATVoltage(); });
+    run("StaticIP2366 5 ADC getters", bus, iterations, [&]() {
+        sink = fixed.getVBATVoltage() + fixed.getVsysVoltage() + fixed.getBATCurrent() + fixed.getVsysCurrent() + fixed.getVsysPower();
+    });
+    run("StaticIP2366 readAdcSnapshot", bus, iterations, [&]() {
+        IP2366::AdcSnapshot adc;
+        fixed.readAdcSnapshot(adc);
+        sink = adc.VBATVoltage;
+    });
+    run("StaticIP2366 8 status getters", bus, iterations, [&]() {
+        sink = fixed.isCharging() + fixed.isChargeFull() + fixed.isDischarging() + fixed.isFastCharge() +
+               fixed.isVbusPresent() + fixed.isTypeCSinkConnected() + fixed.isVsysOverCurrent() +
+               static_cast<uint8_t>(fixed.getChargeState());
+    });
+    run("StaticIP2366 getSystemStatus", bus, iterations, [&]() { sink = fixed.getSystemStatus().raw(); });
+    run("StaticIP2366 setChargeStopCurrent", bus, iterations, [&]() { fixed.setChargeStopCurrent(300); });
+    run("StaticIP2366 setMaxInputPowerOrBatteryCurrent", bus, iterations, [&]() { fixed.setMaxInputPowerOrBatteryCurrent(5000); });
+    run("StaticIP2366 unchecked 5 ADC getters", bus, iterations, [&]() {
+        sink = unchecked.getVBATVoltage() + unchecked.getVsysVoltage() + unchecked.getBATCurrent() +
+               unchecked.getVsysCurrent() + unchecked.getVsysPower();
+    });
+    run("StaticIP2366 unchecked readAdcSnapshot", bus, iterations, [&]() {
+        IP2366::AdcSnapshot adc;
+        unchecked.readAdcSnapshot(adc);
+        sink = adc.VBATVoltage;
+    });
+
+    // RAM per driver instance; the static driver keeps only its bus (here a reference)
+    printf("\n%-46s %9u bytes\n", "sizeof(IP2366)", (unsigned)sizeof(IP2366));
+    printf("%-46s %9u bytes\n", "sizeof(StaticIP2366<..., IP2366BusRef>)", (unsigned)sizeof(fixed));
+    return 0;
+}
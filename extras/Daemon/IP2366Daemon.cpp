@@ -0,0 +1,356 @@
+// Telemetry daemon for a Linux gateway: owns the I2C bus, samples the chip with batched burst reads, publishes
+// the latest snapshot in shared memory and serves clients over a Unix socket, so N readers cost one poller.
+//
+//   cmake -S . -B build && cmake --build build && ./build/ip2366d [-b /dev/i2c-1] [-i interval_ms]
+//       [-u socket] [-m snapshot file]
+//   ./build/ip2366d -s ...       simulated chip replaying the CC -> CV -> full scenario, no hardware needed
+//   ./build/ip2366d -r [-m file] print the latest snapshot straight from shared memory and exit
+//
+// Socket protocol, one text line per command and reply:
+//   get                  latest sample, or "none" before the first one
+//   subscribe [changes]  a sample line for every sample, or only when the status changes
+//   unsubscribe
+//   map                  path of the shared memory snapshot (IP2366SnapshotMapping), for lock-free reads
+// Sample line: sample <sequence> <timestamp ms> <VBAT mV> <IBAT mA> <Vsys mV> <Isys mA> <Psys> <status hex>
+// Notifications never block the poller: a client whose socket buffer is full misses the sample.
+#include "IP2366.h"
+#include "IP2366LinuxI2CBus.h"
+#include "IP2366Sampler.h"
+#include "IP2366Sim.h"
+#include "IP2366Snapshot.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define MAX_CLIENTS 32
+#define COMMAND_LENGTH 64
+
+enum Mode : uint8_t
+{
+    MODE_NONE = 0,
+    MODE_ALL = 1,
+    MODE_CHANGES = 2
+};
+
+struct Client
+{
+    int fd;
+    Mode mode;
+    uint8_t length; // bytes of a command received so far
+    char command[COMMAND_LENGTH];
+};
+
+struct Daemon
+{
+    IP2366SnapshotPublisher * publisher;
+    const char * mapPath;
+    Client clients[MAX_CLIENTS];
+    uint32_t previousStatus; // SystemStatus of the previous sample, for "subscribe changes"
+    uint32_t dropped;        // notifications lost to full client buffers
+};
+
+static volatile sig_atomic_t running = 1;
+
+static void onSignal(int)
+{
+    running = 0;
+}
+
+static int formatSample(char * line, size_t size, const IP2366SnapshotRecord & record)
+{
+    return snprintf(line, size, "sample %lu %lu %u %u %u %u %u %08lx\n", (unsigned long)record.sequence,
+                    (unsigned long)record.adc.timestamp, record.adc.VBATVoltage, record.adc.BATCurrent,
+                    record.adc.VsysVoltage, record.adc.VsysCurrent, record.adc.VsysPower,
+                    (unsigned long)record.status.getSystemStatus().raw());
+}
+
+static bool sendLine(Client & client, const char * line, size_t length)
+{
+    return ::send(client.fd, line, length, MSG_DONTWAIT | MSG_NOSIGNAL) == (ssize_t)length;
+}
+
+static void disconnect(Client & client)
+{
+    close(client.fd);
+    client.fd = -1;
+}
+
+// IP2366Sampler callback, after the publisher: fans the new snapshot out to the subscribed clients
+static void notify(const IP2366::AdcSnapshot &, const IP2366::StatusSnapshot & status, void * context)
+{
+    Daemon * daemon = static_cast<Daemon *>(context);
+    bool changed = status.getSystemStatus().raw() != daemon->previousStatus;
+    daemon->previousStatus = status.getSystemStatus().raw();
+
+    IP2366SnapshotRecord record;
+    if (!daemon->publisher->read(record))
+        return;
+    char line[128];
+    int length = formatSample(line, sizeof(line), record);
+
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++)
+    {
+        Client & client = daemon->clients[i];
+        if (client.fd < 0 || client.mode == MODE_NONE || (client.mode == MODE_CHANGES && !changed))
+            continue;
+        if (!sendLine(client, line, length))
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                daemon->dropped++;
+            else
+                disconnect(client);
+        }
+    }
+}
+
+static void execute(Daemon & daemon, Client & client, const char * command)
+{
+    char line[160];
+    int length;
+    IP2366SnapshotRecord record;
+
+    if (strcmp(command, "get") == 0)
+        length = daemon.publisher->read(record) ? formatSample(line, sizeof(line), record) : snprintf(line, sizeof(line), "none\n");
+    else if (strcmp(command, "subscribe") == 0 || strcmp(command, "subscribe changes") == 0)
+    {
+        client.mode = command[9] ? MODE_CHANGES : MODE_ALL;
+        length = snprintf(line, sizeof(line), "ok\n");
+    }
+    else if (strcmp(command, "unsubscribe") == 0)
+    {
+        client.mode = MODE_NONE;
+        length = snprintf(line, sizeof(line), "ok\n");
+    }
+    else if (strcmp(command, "map") == 0)
+        length = snprintf(line, sizeof(line), "map %s\n", daemon.mapPath);
+    else
+        length = snprintf(line, sizeof(line), "error unknown command\n");
+
+    if (!sendLine(client, line, length) && errno != EAGAIN && errno != EWOULDBLOCK)
+        disconnect(client);
+}
+
+static void receive(Daemon & daemon, Client & client)
+{
+    char data[256];
+    ssize_t received = recv(client.fd, data, sizeof(data), MSG_DONTWAIT);
+    if (received <= 0)
+    {
+        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+            disconnect(client);
+        return;
+    }
+    for (ssize_t i = 0; i < received && client.fd >= 0; i++)
+    {
+        char c = data[i];
+        if (c == '\r')
+            continue;
+        if (c != '\n')
+        {
+            if (client.length < COMMAND_LENGTH - 1)
+                client.command[client.length++] = c;
+            continue;
+        }
+        client.command[client.length] = 0;
+        client.length = 0;
+        execute(daemon, client, client.command);
+    }
+}
+
+static int listenOn(const char * path)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path))
+        return -1;
+    strcpy(address.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    unlink(path);
+    if (bind(fd, (sockaddr *)&address, sizeof(address)) != 0 || listen(fd, 8) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int readMapping(const char * path)
+{
+    IP2366SnapshotMapping mapping;
+    IP2366SnapshotRecord record;
+    if (!mapping.open(path))
+    {
+        fprintf(stderr, "%s: no compatible snapshot\n", path);
+        return 1;
+    }
+    if (!mapping.get()->read(record))
+    {
+        printf("none\n");
+        return 0;
+    }
+    char line[128];
+    formatSample(line, sizeof(line), record);
+    fputs(line, stdout);
+    return 0;
+}
+
+int main(int argc, char ** argv)
+{
+    const char * device = "/dev/i2c-1";
+    const char * socketPath = "/tmp/ip2366.sock";
+    const char * mapPath = "/tmp/ip2366.snapshot";
+    uint32_t interval = 1000;
+    bool simulate = false;
+    bool reader = false;
+    int option;
+    while ((option = getopt(argc, argv, "b:i:u:m:sr")) != -1)
+    {
+        switch (option)
+        {
+        case 'b': device = optarg; break;
+        case 'i': interval = atoi(optarg); break;
+        case 'u': socketPath = optarg; break;
+        case 'm': mapPath = optarg; break;
+        case 's': simulate = true; break;
+        case 'r': reader = true; break;
+        default:
+            fprintf(stderr, "usage: %s [-b i2c device | -s] [-i interval_ms] [-u socket] [-m snapshot file] [-r]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (reader)
+        return readMapping(mapPath);
+
+    IP2366LinuxI2CBus i2c(device);
+    IP2366SimBus sim;
+    IP2366Scenario scenario(sim);
+    IP2366 chip(simulate ? (IP2366Bus &)sim : (IP2366Bus &)i2c);
+    if (!simulate)
+    {
+        i2c.begin();
+        if (!i2c.isOpen())
+        {
+            perror(device);
+            return 1;
+        }
+    }
+    if (!chip.begin())
+    {
+        fprintf(stderr, "IP2366 not responding\n");
+        return 1;
+    }
+
+    IP2366SnapshotMapping mapping;
+    if (!mapping.create(mapPath))
+    {
+        perror(mapPath);
+        return 1;
+    }
+
+    static Daemon daemon; // large, keep it off the stack
+    daemon.publisher = mapping.get();
+    daemon.mapPath = mapPath;
+    daemon.previousStatus = 0xFFFFFFFF;
+    daemon.dropped = 0;
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++)
+        daemon.clients[i].fd = -1;
+
+    IP2366Sampler sampler(chip, interval);
+    sampler.subscribe(IP2366SnapshotPublisher::onSample, daemon.publisher);
+    sampler.subscribe(notify, &daemon);
+
+    int listener = listenOn(socketPath);
+    if (listener < 0)
+    {
+        perror(socketPath);
+        return 1;
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    uint32_t due = millis();
+    while (running)
+    {
+        if (simulate)
+        {
+            if (scenario.isFinished())
+                scenario.start(IP2366Scenario::ccToCv, IP2366Scenario::ccToCvLength);
+            scenario.update();
+        }
+
+        uint32_t now = millis();
+        if ((int32_t)(now - due) >= 0)
+        {
+            if (!sampler.sample())
+                fprintf(stderr, "sample failed, error %u\n", sampler.getLastError());
+            due += interval;
+            if ((int32_t)(now - due) >= 0) // fell behind by more than one interval, do not burst
+                due = now + interval;
+        }
+
+        // wait for clients until the next sample is due
+        pollfd fds[MAX_CLIENTS + 1];
+        Client * owners[MAX_CLIENTS + 1];
+        nfds_t count = 0;
+        fds[count] = {listener, POLLIN, 0};
+        owners[count++] = nullptr;
+        for (uint8_t i = 0; i < MAX_CLIENTS; i++)
+        {
+            if (daemon.clients[i].fd < 0)
+                continue;
+            fds[count] = {daemon.clients[i].fd, POLLIN, 0};
+            owners[count++] = &daemon.clients[i];
+        }
+        int32_t timeout = (int32_t)(due - millis());
+        if (poll(fds, count, timeout > 0 ? timeout : 0) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("poll");
+            break;
+        }
+
+        for (nfds_t i = 1; i < count; i++)
+        {
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR))
+                receive(daemon, *owners[i]);
+        }
+        if (fds[0].revents & POLLIN)
+        {
+            int fd = accept(listener, nullptr, nullptr);
+            Client * free = nullptr;
+            for (uint8_t i = 0; i < MAX_CLIENTS && free == nullptr && fd >= 0; i++)
+            {
+                if (daemon.clients[i].fd < 0)
+                    free = &daemon.clients[i];
+            }
+            if (free != nullptr)
+                *free = {fd, MODE_NONE, 0, {0}};
+            else if (fd >= 0)
+                close(fd); // full
+        }
+    }
+
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++)
+    {
+        if (daemon.clients[i].fd >= 0)
+            disconnect(daemon.clients[i]);
+    }
+    close(listener);
+    unlink(socketPath);
+    fprintf(stderr, "%lu samples, %lu notifications dropped\n", (unsigned long)sampler.getSequence(), (unsigned long)daemon.dropped);
+    return 0;
+}
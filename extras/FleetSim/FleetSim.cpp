@@ -0,0 +1,101 @@
+// Fleet load test on a Linux host, see IP2366Fleet.h.
+//
+//   g++ -O2 -std=gnu++11 -Isrc src/*.cpp extras/FleetSim/FleetSim.cpp -o fleetsim -lpthread
+//   ./fleetsim -n 5000 -i 1000 -d 30 [-t 8] [-o telemetry.txt]
+//
+// Every sample is formatted as one text line (the stand-in for an ingestion path) and written to the
+// -o file, or discarded: device, timestamp on the fleet clock (ms), VBAT, IBAT, Vsys, Isys, status.
+#include "IP2366Fleet.h"
+
+#include <atomic>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct Output
+{
+    int fd;
+    std::atomic<uint64_t> bytes;
+};
+
+struct LineBuffer
+{
+    char data[4096];
+    size_t length;
+    int fd;
+
+    void flush()
+    {
+        if (fd >= 0 && length > 0 && write(fd, data, length) < 0)
+            perror("write");
+        length = 0;
+    }
+    ~LineBuffer() { flush(); }
+};
+
+static thread_local LineBuffer buffer = {{0}, 0, -1};
+
+static void onSample(uint32_t device, const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * context)
+{
+    Output * output = static_cast<Output *>(context);
+    buffer.fd = output->fd;
+    if (sizeof(buffer.data) - buffer.length < 128)
+        buffer.flush();
+    int length = snprintf(buffer.data + buffer.length, sizeof(buffer.data) - buffer.length,
+                          "%u %lu %u %u %u %u %lu\n", device, (unsigned long)adc.timestamp, adc.VBATVoltage,
+                          adc.BATCurrent, adc.VsysVoltage, adc.VsysCurrent, (unsigned long)status.getSystemStatus().raw());
+    buffer.length += length;
+    output->bytes.fetch_add(length, std::memory_order_relaxed);
+}
+
+int main(int argc, char ** argv)
+{
+    IP2366Fleet::Config config;
+    const char * path = nullptr;
+    int option;
+    while ((option = getopt(argc, argv, "n:t:i:d:o:")) != -1)
+    {
+        switch (option)
+        {
+        case 'n': config.devices = atoi(optarg); break;
+        case 't': config.threads = atoi(optarg); break;
+        case 'i': config.interval_ms = atoi(optarg); break;
+        case 'd': config.duration_ms = atoi(optarg) * 1000; break;
+        case 'o': path = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-n devices] [-t threads] [-i interval_ms] [-d seconds] [-o file]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Output output;
+    output.fd = path ? open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644) : -1;
+    output.bytes = 0;
+    if (path && output.fd < 0)
+    {
+        perror(path);
+        return 1;
+    }
+
+    IP2366Fleet fleet(config);
+    IP2366Fleet::Report report;
+    if (!fleet.run(onSample, &output, report))
+    {
+        fprintf(stderr, "invalid configuration\n");
+        return 2;
+    }
+    buffer.flush();
+
+    printf("devices %u, interval %u ms, %u ms\n", config.devices, config.interval_ms, report.elapsed_ms);
+    printf("samples %llu (%u/s), errors %llu, telemetry %llu bytes\n", (unsigned long long)report.samples,
+           report.samplesPerSecond, (unsigned long long)report.errors, (unsigned long long)output.bytes.load());
+    printf("latency us (tick dispatch to sink return): p50 %u, p99 %u, p99.9 %u, max %u\n", report.p50_us,
+           report.p99_us, report.p999_us, report.max_us);
+    printf("tick quantization us (due to dispatch): mean %u, max %u\n", report.quantization_us, report.maxQuantization_us);
+    printf("per sample ns: driver %u, sink %u, cpu %u\n", report.driver_ns, report.sink_ns, report.cpu_ns);
+    printf("steals %llu, late ticks %u\n", (unsigned long long)report.steals, report.lateTicks);
+    if (output.fd >= 0)
+        close(output.fd);
+    return 0;
+}
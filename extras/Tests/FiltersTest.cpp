@@ -0,0 +1,153 @@
+// The streaming filters of IP2366Filters.h against brute-force references over the same window.
+#include "IP2366Filters.h"
+#include "IP2366Test.h"
+
+#include <stdlib.h>
+
+#define WINDOW 5
+
+// Small value range, so the windows hold many duplicates
+static uint16_t nextSample(uint32_t & seed)
+{
+    seed = seed * 1103515245 + 12345;
+    return 100 + (seed >> 16) % 8 * 10;
+}
+
+static int compareSamples(const void * a, const void * b)
+{
+    return *(const uint16_t *)a - *(const uint16_t *)b;
+}
+
+TEST(medianMatchesASortedWindow)
+{
+    IP2366MedianFilter<WINDOW> filter;
+    uint16_t history[1000];
+    uint32_t seed = 1;
+    for (uint16_t i = 0; i < 1000; i++)
+    {
+        history[i] = nextSample(seed);
+        uint16_t median = filter.update(history[i]);
+
+        uint8_t count = i + 1 < WINDOW ? i + 1 : WINDOW;
+        uint16_t sorted[WINDOW];
+        for (uint8_t j = 0; j < count; j++)
+            sorted[j] = history[i + 1 - count + j];
+        qsort(sorted, count, sizeof(sorted[0]), compareSamples);
+        if (!CHECK_EQUAL(sorted[count / 2], median))
+            break;
+        CHECK_EQUAL(count, filter.size());
+    }
+
+    filter.reset();
+    CHECK_EQUAL(0, filter.size());
+    CHECK_EQUAL(0, filter.value());
+    CHECK_EQUAL(7, filter.update(7));
+}
+
+TEST(medianEvictsOneOfSeveralDuplicates)
+{
+    IP2366MedianFilter<3> filter;
+    filter.update(5);
+    filter.update(5);
+    filter.update(9);
+    CHECK_EQUAL(5, filter.value());
+    CHECK_EQUAL(9, filter.update(9)); // evicts one 5: 5 9 9
+    CHECK_EQUAL(9, filter.update(1)); // evicts the other 5: 9 9 1
+    CHECK_EQUAL(1, filter.update(1)); // evicts one 9: 9 1 1
+    CHECK_EQUAL(3, filter.size());
+}
+
+TEST(windowStatsMatchTheWindow)
+{
+    IP2366WindowStats<WINDOW> stats;
+    uint16_t history[1000];
+    uint32_t seed = 7;
+    for (uint16_t i = 0; i < 1000; i++)
+    {
+        history[i] = nextSample(seed);
+        stats.update(history[i]);
+
+        uint8_t count = i + 1 < WINDOW ? i + 1 : WINDOW;
+        uint16_t min = 0xFFFF, max = 0;
+        uint32_t sum = 0;
+        for (uint8_t j = 0; j < count; j++)
+        {
+            uint16_t sample = history[i + 1 - count + j];
+            min = sample < min ? sample : min;
+            max = sample > max ? sample : max;
+            sum += sample;
+        }
+        bool ok = CHECK_EQUAL(min, stats.min());
+        ok &= CHECK_EQUAL(max, stats.max());
+        ok &= CHECK_EQUAL((sum + count / 2) / count, stats.mean());
+        if (!ok)
+            break;
+    }
+}
+
+TEST(windowExtremesLeaveAtTheEdge)
+{
+    IP2366WindowStats<3> stats;
+    stats.update(50); // the extremes arrive first and leave the window first
+    stats.update(10);
+    stats.update(30);
+    CHECK_EQUAL(10, stats.min());
+    CHECK_EQUAL(50, stats.max());
+    stats.update(20); // 50 leaves
+    CHECK_EQUAL(10, stats.min());
+    CHECK_EQUAL(30, stats.max());
+    stats.update(40); // 10 leaves
+    CHECK_EQUAL(20, stats.min());
+    CHECK_EQUAL(40, stats.max());
+    stats.update(40); // 30 leaves, duplicate maximum
+    stats.update(20); // 20 leaves, the new 20 is the minimum
+    CHECK_EQUAL(20, stats.min());
+    CHECK_EQUAL(40, stats.max());
+    CHECK_EQUAL(33, stats.mean());
+
+    stats.reset();
+    CHECK_EQUAL(0, stats.size());
+    CHECK_EQUAL(0, stats.min());
+    CHECK_EQUAL(60, stats.update(60));
+    CHECK_EQUAL(60, stats.max());
+}
+
+TEST(outlierFilterRejectsGlitchesAndFollowsSteps)
+{
+    IP2366OutlierFilter<WINDOW, 100, 3> filter;
+    for (uint8_t i = 0; i < WINDOW; i++)
+        filter.update(1000 + i);
+    CHECK_EQUAL(1004, filter.value());
+
+    // a single glitch is replaced by the median
+    CHECK_EQUAL(1002, filter.update(5000));
+    CHECK_EQUAL(1005, filter.update(1005));
+    CHECK_EQUAL(1, filter.getRejected());
+
+    // a real step is rejected MaxRejects times, then accepted and the reference restarts at the new level
+    CHECK_EQUAL(1003, filter.update(2000));
+    CHECK_EQUAL(1003, filter.update(2000));
+    CHECK_EQUAL(1003, filter.update(2000));
+    CHECK_EQUAL(2010, filter.update(2010));
+    CHECK_EQUAL(4, filter.getRejected());
+    CHECK_EQUAL(2020, filter.update(2020));
+    CHECK_EQUAL(1900, filter.update(1900)); // too few samples at the new level to reject anything yet
+    CHECK_EQUAL(2010, filter.update(9000));
+    CHECK_EQUAL(5, filter.getRejected());
+
+    filter.reset();
+    CHECK_EQUAL(0, filter.value());
+    CHECK_EQUAL(3000, filter.update(3000));
+}
+
+TEST(emaPrimesWithTheFirstSample)
+{
+    IP2366EmaFilter<2> filter;
+    CHECK_EQUAL(800, filter.update(800));
+    CHECK_EQUAL(700, filter.update(400)); // 800 + (400 - 800) / 4
+    for (uint8_t i = 0; i < 100; i++)
+        filter.update(400);
+    CHECK(filter.value() >= 400 && filter.value() <= 401); // the truncated state settles up to 1 LSB high
+    filter.reset();
+    CHECK_EQUAL(1000, filter.update(1000));
+}
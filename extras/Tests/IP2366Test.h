@@ -0,0 +1,36 @@
+#ifndef IP2366_TEST_H
+#define IP2366_TEST_H
+
+#include <stdint.h>
+
+// Minimal host test harness, no dependencies: TEST() registers a case, CHECK()/CHECK_EQUAL() report a
+// failure and let the case continue, main() in IP2366TestMain.cpp runs every case of the executable and
+// returns non-zero if any check failed. One executable per test file, each registered with CTest.
+struct IP2366TestCase
+{
+    typedef void (*Function)();
+
+    IP2366TestCase(const char * name, Function function);
+
+    const char * name;
+    Function function;
+    IP2366TestCase * next;
+
+    static IP2366TestCase *& first();
+    static IP2366TestCase *& last();
+};
+
+bool ip2366Check(bool condition, const char * expression, const char * file, int line);
+bool ip2366CheckEqual(long long expected, long long actual, const char * expectedText, const char * actualText,
+                      const char * file, int line);
+
+#define TEST(name)                                          \
+    static void name();                                     \
+    static IP2366TestCase name##Case(#name, name);          \
+    static void name()
+
+#define CHECK(condition) ip2366Check((condition), #condition, __FILE__, __LINE__)
+#define CHECK_EQUAL(expected, actual) \
+    ip2366CheckEqual((long long)(expected), (long long)(actual), #expected, #actual, __FILE__, __LINE__)
+
+#endif
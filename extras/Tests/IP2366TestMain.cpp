@@ -0,0 +1,62 @@
+#include "IP2366Test.h"
+
+#include <stdio.h>
+
+static int failures = 0;
+
+IP2366TestCase::IP2366TestCase(const char * name, Function function) : name(name), function(function), next(nullptr)
+{
+    if (last() == nullptr)
+        first() = this;
+    else
+        last()->next = this;
+    last() = this;
+}
+
+IP2366TestCase *& IP2366TestCase::first()
+{
+    static IP2366TestCase * head = nullptr;
+    return head;
+}
+
+IP2366TestCase *& IP2366TestCase::last()
+{
+    static IP2366TestCase * tail = nullptr;
+    return tail;
+}
+
+bool ip2366Check(bool condition, const char * expression, const char * file, int line)
+{
+    if (!condition)
+    {
+        printf("%s:%d: CHECK(%s) failed\n", file, line, expression);
+        failures++;
+    }
+    return condition;
+}
+
+bool ip2366CheckEqual(long long expected, long long actual, const char * expectedText, const char * actualText,
+                      const char * file, int line)
+{
+    if (expected != actual)
+    {
+        printf("%s:%d: CHECK_EQUAL(%s, %s) failed: expected %lld, got %lld\n", file, line, expectedText, actualText,
+               expected, actual);
+        failures++;
+    }
+    return expected == actual;
+}
+
+int main()
+{
+    int cases = 0;
+    for (IP2366TestCase * test = IP2366TestCase::first(); test != nullptr; test = test->next)
+    {
+        int before = failures;
+        test->function();
+        printf("%s %s\n", failures == before ? "PASS" : "FAIL", test->name);
+        cases++;
+    }
+    printf("%d cases, %d failed checks\n", cases, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,441 @@
+// Every register accessor of IP2366 against the register definitions, on IP2366SimBus:
+// setters must write the documented bits (and leave the others alone), getters must decode them.
+#include "IP2366.h"
+#include "IP2366Sim.h"
+#include "IP2366Test.h"
+
+#include <string.h>
+
+struct BitAccessor
+{
+    void (IP2366::*set)(bool, uint8_t *);
+    bool (IP2366::*get)(uint8_t *);
+    uint8_t regAddress;
+    uint8_t bit;
+};
+
+struct FlagGetter
+{
+    bool (IP2366::*get)(uint8_t *);
+    uint8_t regAddress;
+    uint8_t bit;
+};
+
+static void checkBits(const BitAccessor * accessors, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        IP2366SimBus bus;
+        IP2366 chip(bus);
+        const BitAccessor & accessor = accessors[i];
+        bus.setRegister(accessor.regAddress, 0x00);
+
+        uint8_t errorCode = 0xFF;
+        (chip.*accessor.set)(true, &errorCode);
+        CHECK_EQUAL(0, errorCode);
+        CHECK_EQUAL(1 << accessor.bit, bus.getRegister(accessor.regAddress));
+        CHECK((chip.*accessor.get)(nullptr));
+
+        uint8_t others = accessor.regAddress == IP2366_REG_SYS_CTL0 ? 0xBF : 0xFF; // writing En_RESETMCU resets the chip
+        bus.setRegister(accessor.regAddress, others);
+        (chip.*accessor.set)(false, nullptr);
+        CHECK_EQUAL(others & ~(1 << accessor.bit), bus.getRegister(accessor.regAddress));
+        CHECK(!(chip.*accessor.get)(nullptr));
+    }
+}
+
+static void checkFlags(const FlagGetter * getters, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        IP2366SimBus bus;
+        IP2366 chip(bus);
+        const FlagGetter & getter = getters[i];
+
+        bus.setRegister(getter.regAddress, 1 << getter.bit);
+        CHECK((chip.*getter.get)(nullptr));
+        bus.setRegister(getter.regAddress, 0xFF & ~(1 << getter.bit));
+        CHECK(!(chip.*getter.get)(nullptr));
+    }
+}
+
+TEST(sysCtl0Bits)
+{
+    static const BitAccessor accessors[] = {
+        {&IP2366::enableCharger, &IP2366::isChargerEnabled, IP2366_REG_SYS_CTL0, 0},
+        {&IP2366::enableVbusSinkSCP, &IP2366::isVbusSinkSCPEnabled, IP2366_REG_SYS_CTL0, 2},
+        {&IP2366::enableVbusSinkPD, &IP2366::isVbusSinkPDEnabled, IP2366_REG_SYS_CTL0, 3},
+        {&IP2366::enableVbusSinkDPdM, &IP2366::isVbusSinkDPdMEnabled, IP2366_REG_SYS_CTL0, 4},
+        {&IP2366::enableINTLow, &IP2366::isINTLowEnabled, IP2366_REG_SYS_CTL0, 5},
+        {&IP2366::enableLoadOTP, &IP2366::isLoadOTPEnabled, IP2366_REG_SYS_CTL0, 7},
+    };
+    checkBits(accessors, sizeof(accessors) / sizeof(accessors[0]));
+}
+
+TEST(sysCtl9Bits)
+{
+    static const BitAccessor accessors[] = {
+        {&IP2366::enableStandbyMode, &IP2366::isStandbyModeEnabled, IP2366_REG_SYS_CTL9, 7},
+        {&IP2366::Standby, &IP2366::isStandby, IP2366_REG_SYS_CTL9, 6},
+        {&IP2366::enableBATLow, &IP2366::isBATLowEnabled, IP2366_REG_SYS_CTL9, 5},
+    };
+    checkBits(accessors, sizeof(accessors) / sizeof(accessors[0]));
+}
+
+TEST(resetMcuResetsRegisters)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    bus.setRegister(IP2366_REG_SYS_CTL0, 0x01);
+    bus.setRegister(IP2366_REG_SYS_CTL3, 0x20);
+    chip.ResetMCU(true);
+    CHECK_EQUAL(0, bus.getRegister(IP2366_REG_SYS_CTL0));
+    CHECK_EQUAL(0, bus.getRegister(IP2366_REG_SYS_CTL3));
+}
+
+TEST(sysCtl11OutputFeatures)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    bus.setRegister(IP2366_REG_SYS_CTL11, 0x0F); // low nibble must survive
+    chip.setOutputFeatures(true, false, true, false);
+    CHECK_EQUAL(0x80 | 0x20 | 0x0F, bus.getRegister(IP2366_REG_SYS_CTL11));
+    CHECK(chip.isDcDcOutputEnabled());
+    CHECK(!chip.isVbusSrcDPdMEnabled());
+    CHECK(chip.isVbusSrcPdEnabled());
+    CHECK(!chip.isVbusSrcSCPEnabled());
+
+    chip.setOutputFeatures(false, true, false, true);
+    CHECK_EQUAL(0x40 | 0x10 | 0x0F, bus.getRegister(IP2366_REG_SYS_CTL11));
+}
+
+TEST(scaledSettings)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+
+    chip.setFullChargeVoltage(4200);
+    CHECK_EQUAL((4200 - 2500) / 10, bus.getRegister(IP2366_REG_SYS_CTL2));
+    CHECK_EQUAL(4200, chip.getFullChargeVoltage());
+    chip.setFullChargeVoltage(5000); // clamped
+    CHECK_EQUAL(4400, chip.getFullChargeVoltage());
+    chip.setFullChargeVoltage(1000);
+    CHECK_EQUAL(2500, chip.getFullChargeVoltage());
+
+    chip.setMaxInputPowerOrBatteryCurrent(3500);
+    CHECK_EQUAL(35, bus.getRegister(IP2366_REG_SYS_CTL3));
+    CHECK_EQUAL(3500, chip.getMaxInputPowerOrBatteryCurrent());
+    chip.setMaxInputPowerOrBatteryCurrent(3550); // rounded down to the 100 mA step
+    CHECK_EQUAL(3500, chip.getMaxInputPowerOrBatteryCurrent());
+    chip.setMaxInputPowerOrBatteryCurrent(20000);
+    CHECK_EQUAL(9700, chip.getMaxInputPowerOrBatteryCurrent());
+
+    chip.setTrickleChargeCurrent(250);
+    CHECK_EQUAL(5, bus.getRegister(IP2366_REG_SYS_CTL6));
+    CHECK_EQUAL(250, chip.getTrickleChargeCurrent());
+}
+
+TEST(sysCtl8SharedFields)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    bus.setRegister(IP2366_REG_SYS_CTL8, 0x03); // reserved low bits must survive
+
+    chip.setChargeStopCurrent(300);
+    CHECK_EQUAL((6 << 4) | 0x03, bus.getRegister(IP2366_REG_SYS_CTL8));
+    CHECK_EQUAL(300, chip.getChargeStopCurrent());
+
+    static const uint16_t drops[] = {0, 50, 100, 200};
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        chip.setCellRechargeThreshold(drops[i]);
+        CHECK_EQUAL((6 << 4) | (i << 2) | 0x03, bus.getRegister(IP2366_REG_SYS_CTL8));
+        CHECK_EQUAL(drops[i], chip.getCellRechargeThreshold());
+    }
+    CHECK_EQUAL(300, chip.getChargeStopCurrent());
+
+    chip.setChargeStopCurrent(5000); // clamped to 750 mA
+    CHECK_EQUAL(750, chip.getChargeStopCurrent());
+    CHECK_EQUAL(200, chip.getCellRechargeThreshold());
+}
+
+TEST(lowBatteryVoltage)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    bus.setRegister(IP2366_REG_SYS_CTL10, 0x1F);
+    for (uint16_t voltage = 2500; voltage <= 3200; voltage += 100)
+    {
+        chip.setLowBatteryVoltage(voltage);
+        CHECK_EQUAL((((voltage - 2500) / 100) << 5) | 0x1F, bus.getRegister(IP2366_REG_SYS_CTL10));
+        CHECK_EQUAL(voltage, chip.getLowBatteryVoltage());
+    }
+}
+
+TEST(enumSettings)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+
+    bus.setRegister(IP2366_REG_SYS_CTL12, 0x1F);
+    chip.setMaxOutputPower(IP2366::Vbus1OutputPower::W100);
+    CHECK_EQUAL((4 << 5) | 0x1F, bus.getRegister(IP2366_REG_SYS_CTL12));
+    CHECK(chip.getMaxOutputPower() == IP2366::Vbus1OutputPower::W100);
+
+    bus.setRegister(IP2366_REG_SELECT_PDO, 0xF8);
+    chip.setChargingPDOmode(IP2366::ChargingPDOmode::V15);
+    CHECK_EQUAL(0xF8 | 3, bus.getRegister(IP2366_REG_SELECT_PDO));
+    CHECK(chip.getChargingPDOmode() == IP2366::ChargingPDOmode::V15);
+
+    bus.setRegister(IP2366_REG_TypeC_CTL8, 0x3F);
+    chip.setTypeCMode(IP2366::TypeCMode::DFP);
+    CHECK_EQUAL(0x40 | 0x3F, bus.getRegister(IP2366_REG_TypeC_CTL8));
+    CHECK(chip.getTypeCMode() == IP2366::TypeCMode::DFP);
+    chip.setTypeCMode(IP2366::TypeCMode::DRP);
+    CHECK(chip.getTypeCMode() == IP2366::TypeCMode::DRP);
+}
+
+TEST(pdoCurrents)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+
+    void (IP2366::*setters[])(uint16_t, uint8_t *) = {&IP2366::setPDOCurrent5V, &IP2366::setPDOCurrent9V, &IP2366::setPDOCurrent12V,
+                                                      &IP2366::setPDOCurrent15V, &IP2366::setPDOCurrent20V};
+    uint16_t (IP2366::*getters[])(uint8_t *) = {&IP2366::getPDOCurrent5V, &IP2366::getPDOCurrent9V, &IP2366::getPDOCurrent12V,
+                                                &IP2366::getPDOCurrent15V, &IP2366::getPDOCurrent20V};
+    static const uint8_t registers[] = {IP2366_REG_TypeC_CTL10, IP2366_REG_TypeC_CTL11, IP2366_REG_TypeC_CTL12,
+                                        IP2366_REG_TypeC_CTL13, IP2366_REG_TypeC_CTL14};
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        (chip.*setters[i])(2240, nullptr);
+        CHECK_EQUAL(2240 / 20, bus.getRegister(registers[i]));
+        CHECK_EQUAL(2240, (chip.*getters[i])(nullptr));
+        (chip.*setters[i])(6000, nullptr); // clamped to the PDO maximum
+        CHECK_EQUAL(i == 4 ? 5000 : 3000, (chip.*getters[i])(nullptr));
+    }
+
+    chip.setPDOCurrentPPS1(2150);
+    CHECK_EQUAL(2150 / 50, bus.getRegister(IP2366_REG_TypeC_CTL23));
+    CHECK_EQUAL(2150, chip.getPDOCurrentPPS1());
+    chip.setPDOCurrentPPS2(9000);
+    CHECK_EQUAL(5000 / 50, bus.getRegister(IP2366_REG_TypeC_CTL24));
+    CHECK_EQUAL(5000, chip.getPDOCurrentPPS2());
+}
+
+TEST(pdoEnableRegisters)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+
+    chip.enablePdoCurrentOutputSet(true, false, true, false, true, false, true, false);
+    CHECK_EQUAL(0x01 | 0x02 | 0x08 | 0x20, bus.getRegister(IP2366_REG_TypeC_CTL9));
+    CHECK(chip.is5VPdoIsetEnabled());
+    CHECK(!chip.is5VPdo3AEnabled());
+    CHECK(chip.is9VPdoIsetEnabled());
+    CHECK(!chip.is12VPdoIsetEnabled());
+    CHECK(chip.is15VPdoIsetEnabled());
+    CHECK(!chip.is20VPdoIsetEnabled());
+    CHECK(chip.isPps1PdoIsetEnabled());
+    CHECK(!chip.isPps2PdoIsetEnabled());
+
+    bus.setRegister(IP2366_REG_TypeC_CTL17, 0x81);
+    chip.enableSrcPdo(true, false, true, false, true, false);
+    CHECK_EQUAL(0x81 | 0x02 | 0x08 | 0x20, bus.getRegister(IP2366_REG_TypeC_CTL17));
+    CHECK(chip.isSrcPdo9VEnabled());
+    CHECK(!chip.isSrcPdo12VEnabled());
+    CHECK(chip.isSrcPdo15VEnabled());
+    CHECK(!chip.isSrcPdo20VEnabled());
+    CHECK(chip.isSrcPps1PdoEnabled());
+    CHECK(!chip.isSrcPps2PdoEnabled());
+
+    bus.setRegister(IP2366_REG_TypeC_CTL18, 0xE0);
+    chip.enableSrcPdoAdd10mA(true, false, true, false, true);
+    CHECK_EQUAL(0xE0 | 0x01 | 0x04 | 0x10, bus.getRegister(IP2366_REG_TypeC_CTL18));
+    CHECK(chip.isSrcPdoAdd10mA5VEnabled());
+    CHECK(!chip.isSrcPdoAdd10mA9VEnabled());
+    CHECK(chip.isSrcPdoAdd10mA12VEnabled());
+    CHECK(!chip.isSrcPdoAdd10mA15VEnabled());
+    CHECK(chip.isSrcPdoAdd10mA20VEnabled());
+}
+
+TEST(statusFlags)
+{
+    static const FlagGetter getters[] = {
+        {&IP2366::isCharging, IP2366_REG_STATE_CTL0, 5},
+        {&IP2366::isChargeFull, IP2366_REG_STATE_CTL0, 4},
+        {&IP2366::isDischarging, IP2366_REG_STATE_CTL0, 3},
+        {&IP2366::isFastCharge, IP2366_REG_STATE_CTL1, 6},
+        {&IP2366::isVbusPresent, IP2366_REG_STATE_CTL2, 7},
+        {&IP2366::isVbusOvervoltage, IP2366_REG_STATE_CTL2, 6},
+        {&IP2366::isTypeCSinkConnected, IP2366_REG_TypeC_STATE, 7},
+        {&IP2366::isTypeCSrcConnected, IP2366_REG_TypeC_STATE, 6},
+        {&IP2366::isTypeCSrcPdConnected, IP2366_REG_TypeC_STATE, 5},
+        {&IP2366::isTypeCSinkPdConnected, IP2366_REG_TypeC_STATE, 4},
+        {&IP2366::isVbusSinkQcActive, IP2366_REG_TypeC_STATE, 3},
+        {&IP2366::isVbusSrcQcActive, IP2366_REG_TypeC_STATE, 2},
+        {&IP2366::isReceives5VPdo, IP2366_REG_RECEIVED_PDO, 0},
+        {&IP2366::isReceives9VPdo, IP2366_REG_RECEIVED_PDO, 1},
+        {&IP2366::isReceives12VPdo, IP2366_REG_RECEIVED_PDO, 2},
+        {&IP2366::isReceives15VPdo, IP2366_REG_RECEIVED_PDO, 3},
+        {&IP2366::isReceives20VPdo, IP2366_REG_RECEIVED_PDO, 4},
+        {&IP2366::isVsysOverCurrent, IP2366_REG_STATE_CTL3, 5},
+        {&IP2366::isVsysSdortCircuitDt, IP2366_REG_STATE_CTL3, 4},
+    };
+    checkFlags(getters, sizeof(getters) / sizeof(getters[0]));
+}
+
+TEST(chargeStateAndVoltage)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    for (uint8_t state = 0; state <= 6; state++)
+    {
+        bus.setRegister(IP2366_REG_STATE_CTL0, 0x20 | state);
+        CHECK_EQUAL(state, static_cast<uint8_t>(chip.getChargeState()));
+    }
+
+    static const uint8_t volts[] = {0, 0, 5, 7, 9, 12, 15, 20};
+    for (uint8_t code = 0; code < 8; code++)
+    {
+        bus.setRegister(IP2366_REG_STATE_CTL2, 0x80 | code);
+        CHECK_EQUAL(volts[code], chip.getChargeVoltage());
+    }
+}
+
+TEST(clearVsysFaults)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    bus.setRegister(IP2366_REG_STATE_CTL3, 0x30);
+    CHECK_EQUAL(IP2366::FAULT_VSYS_OVERCURRENT | IP2366::FAULT_VSYS_SHORT_CIRCUIT, chip.readFaults());
+    chip.clearVsysFaults();
+    CHECK_EQUAL(0, bus.getRegister(IP2366_REG_STATE_CTL3));
+    CHECK_EQUAL(0, chip.readFaults());
+
+    bus.setRegister(IP2366_REG_STATE_CTL2, 0x40);
+    CHECK_EQUAL(IP2366::FAULT_VBUS_OVERVOLTAGE, chip.readFaults());
+
+    // a failed read reports no faults, only the error
+    uint8_t errorCode = 0;
+    bus.sleep();
+    CHECK_EQUAL(0, chip.readFaults(&errorCode));
+    CHECK(errorCode != 0);
+}
+
+TEST(adcChannels)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    bus.setRegister16(IP2366_REG_BATVADC_DAT0, 7950);
+    bus.setRegister16(IP2366_REG_VsysVADC_DAT0, 20050);
+    bus.setRegister16(IP2366_REG_IBATIADC_DAT0, 3125);
+    bus.setRegister16(IP2366_REG_ISYS_IADC_DAT0, 1480);
+    bus.setRegister16(IP2366_REG_Vsys_POW_DAT0, 29674);
+
+    CHECK_EQUAL(7950, chip.getVBATVoltage());
+    CHECK_EQUAL(20050, chip.getVsysVoltage());
+    CHECK_EQUAL(3125, chip.getBATCurrent());
+    CHECK_EQUAL(1480, chip.getVsysCurrent());
+    CHECK_EQUAL(29674, chip.getVsysPower());
+}
+
+TEST(ntcVoltageAndResistanceAgree)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    bus.setRegister16(IP2366_REG_VGPIO0_NTC_DAT0, 200); // mV
+    bus.setRegister(IP2366_REG_INTC_IADC_DAT0, 0x00);   // 20 uA
+
+    CHECK_EQUAL(200, chip.getNTCVoltage());
+    CHECK_EQUAL(10000, chip.getNTCResistance());
+    CHECK(!chip.isOverHeat());
+
+    bus.setRegister(IP2366_REG_INTC_IADC_DAT0, 0x80); // 80 uA
+    CHECK_EQUAL(2500, chip.getNTCResistance());
+    CHECK(chip.isOverHeat()); // the raw bit only, no fault
+    CHECK_EQUAL(0, chip.readFaults());
+
+    IP2366::AdcSnapshot adc;
+    CHECK(chip.readAdcSnapshot(adc));
+    CHECK_EQUAL(chip.getNTCVoltage(), adc.NTCVoltage);
+    CHECK_EQUAL(IP2366::ntcResistance(adc.NTCVoltage, adc.ntcCurrent80uA), adc.NTCResistance);
+    CHECK(adc.ntcCurrent80uA);
+}
+
+TEST(snapshotsUseBurstReads)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    bus.setRegister16(IP2366_REG_BATVADC_DAT0, 8000);
+    bus.setRegister16(IP2366_REG_IBATIADC_DAT0, 2000);
+    bus.setRegister(IP2366_REG_STATE_CTL0, 0x22);
+    bus.setRegister(IP2366_REG_RECEIVED_PDO, 0x1F);
+    bus.setRegister(IP2366_REG_STATE_CTL3, 0x20);
+
+    IP2366::AdcSnapshot adc;
+    CHECK(chip.readAdcSnapshot(adc));
+    CHECK_EQUAL(3, bus.getStats().reads);
+    CHECK_EQUAL(8000, adc.VBATVoltage);
+    CHECK_EQUAL(2000, adc.BATCurrent);
+
+    bus.resetStats();
+    IP2366::SystemStatus status = chip.getSystemStatus();
+    CHECK_EQUAL(1, bus.getStats().reads);
+    CHECK(status.has(IP2366::SystemStatus::CHARGING));
+    CHECK(status.chargeState() == IP2366::ChargeState::CONSTANT_CURRENT);
+    CHECK_EQUAL(0x1F, status.receivedPdo());
+    CHECK(status.has(IP2366::SystemStatus::VSYS_OVERCURRENT));
+    CHECK(!status.has(IP2366::SystemStatus::VSYS_SHORT_CIRCUIT));
+}
+
+TEST(timenode)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    const char id[] = "H2310";
+    for (uint8_t i = 0; i < 5; i++)
+        bus.setRegister(IP2366_REG_TIMENODE1 + i, id[i]);
+
+    char timenode[5];
+    chip.getTimenode(timenode);
+    CHECK(memcmp(timenode, id, 5) == 0);
+}
+
+TEST(errorsAreReportedAndNothingIsWritten)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    bus.setRegister(IP2366_REG_SYS_CTL8, 0x00);
+    bus.sleep();
+
+    uint8_t errorCode = 0;
+    chip.setChargeStopCurrent(300, &errorCode);
+    CHECK_EQUAL(2, errorCode);
+    chip.getVBATVoltage(&errorCode);
+    CHECK_EQUAL(2, errorCode);
+
+    bus.wake();
+    CHECK_EQUAL(0, bus.getRegister(IP2366_REG_SYS_CTL8));
+    chip.getVBATVoltage(&errorCode);
+    CHECK_EQUAL(0, errorCode);
+}
+
+TEST(compileTimeEncoders)
+{
+    static_assert(IP2366::encodeFullChargeVoltage(4200) == 170, "SYS_CTL2");
+    static_assert(IP2366::decodeFullChargeVoltage(170) == 4200, "SYS_CTL2");
+    static_assert(IP2366::encodeMaxInputPowerOrBatteryCurrent(9700) == 97, "SYS_CTL3");
+    static_assert(IP2366::encodeChargeStopCurrent(750) == 15, "SYS_CTL8");
+    static_assert(IP2366::encodeCellRechargeThreshold(60) == 1, "SYS_CTL8");
+    static_assert(IP2366::encodeLowBatteryVoltage(3200) == 7, "SYS_CTL10");
+    static_assert(IP2366::encodePDOCurrent(5000, 5000) == 250, "TypeC_CTL14");
+    static_assert(IP2366::encodePPSCurrent(5000) == 100, "TypeC_CTL23");
+
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    chip.setFullChargeVoltage<4350>();
+    CHECK_EQUAL(4350, chip.getFullChargeVoltage());
+    chip.setPDOCurrent20V<4000>();
+    CHECK_EQUAL(4000, chip.getPDOCurrent20V());
+}
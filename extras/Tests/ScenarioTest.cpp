@@ -0,0 +1,390 @@
+// The built-in IP2366Scenario scripts replayed on simulated time against the real driver, with assertions on
+// the detected states, the detection latency and the bus transactions they cost; the policies that write the
+// chip are checked the same way, on register contents and write transactions.
+#include "IP2366.h"
+#include "IP2366ChargeAnalytics.h"
+#include "IP2366FaultMonitor.h"
+#include "IP2366LowPowerMonitor.h"
+#include "IP2366PdObserver.h"
+#include "IP2366Sampler.h"
+#include "IP2366Sim.h"
+#include "IP2366SourcePdoManager.h"
+#include "IP2366Test.h"
+
+#include <string.h>
+
+// Read of length bytes at 100 kHz: start, address, register, repeated start, address, data, stop
+static uint32_t readTime_us(uint8_t length)
+{
+    return (1 + 9 * 2 + 1 + 9 * (1 + length) + 1) * 10;
+}
+
+struct Harness
+{
+    IP2366SimClock clock;
+    IP2366SimBus bus;
+    IP2366 chip;
+    IP2366Scenario scenario;
+
+    Harness() : chip(bus), scenario(bus)
+    {
+        clock.install();
+        bus.setSimClock(&clock);
+    }
+
+    // 1 ms steps: apply the due scenario steps, then run the driver code
+    template <class Loop>
+    void run(uint32_t duration_ms, Loop loop)
+    {
+        uint64_t end = clock.now_us() + (uint64_t)duration_ms * 1000;
+        while (clock.now_us() < end)
+        {
+            scenario.update();
+            loop();
+            clock.advance(1);
+        }
+    }
+};
+
+TEST(pdAttachIsSeenWithinOnePoll)
+{
+    Harness h;
+    IP2366Sampler sampler(h.chip, 10);
+    uint32_t contractAt = 0, voltageAt = 0, chargingAt = 0;
+
+    h.scenario.start(IP2366Scenario::pdAttach20V, IP2366Scenario::pdAttach20VLength);
+    uint32_t start = millis();
+    h.run(600, [&]() {
+        if (!sampler.update())
+            return;
+        IP2366::SystemStatus status = sampler.getStatus().getSystemStatus();
+        uint32_t now = sampler.getStatus().timestamp - start;
+        if (!contractAt && status.has(IP2366::SystemStatus::TYPEC_SINK_PD))
+            contractAt = now;
+        if (!voltageAt && status.chargeVoltage() == 20)
+            voltageAt = now;
+        if (!chargingAt && status.has(IP2366::SystemStatus::CHARGING))
+            chargingAt = now;
+    });
+
+    CHECK(h.scenario.isFinished());
+    CHECK(contractAt >= 150 && contractAt <= 160);
+    CHECK(voltageAt >= 350 && voltageAt <= 360);
+    CHECK(chargingAt >= 400 && chargingAt <= 410);
+
+    IP2366::SystemStatus status = sampler.getStatus().getSystemStatus();
+    CHECK(status.has(IP2366::SystemStatus::FAST_CHARGE));
+    CHECK_EQUAL(0x1F, status.receivedPdo());
+    CHECK_EQUAL(3000, sampler.getAdc().BATCurrent);
+
+    // one status burst and three ADC bursts per sample, nothing else
+    const IP2366SimBus::Stats & stats = h.bus.getStats();
+    CHECK_EQUAL(sampler.getSequence() * 4, stats.reads);
+    CHECK_EQUAL(0, stats.writes);
+    CHECK_EQUAL(0, stats.nacks);
+    CHECK_EQUAL(sampler.getSequence() * (8 + 4 + 4 + 6), stats.bytes);
+}
+
+TEST(pdObserverTimesAnAttachAfterIdle)
+{
+    Harness h;
+    IP2366PdObserver observer(h.chip); // 10 ms fast, 500 ms slow
+    CHECK_EQUAL(0, observer.getHistorySize());
+    CHECK_EQUAL(0, observer.getHistory(0).attachTime);
+    CHECK_EQUAL(0, observer.getHistory(0).voltage);
+
+    h.run(1234, [&]() { observer.update(); }); // idle, nothing attached
+    uint32_t start = millis();
+    h.scenario.start(IP2366Scenario::pdAttach20V, IP2366Scenario::pdAttach20VLength);
+    h.run(2500, [&]() { observer.update(); });
+
+    CHECK_EQUAL(1, observer.getHistorySize());
+    const IP2366PdObserver::Negotiation & negotiation = observer.getHistory(0);
+    CHECK(negotiation.attachTime - start <= 10);
+    CHECK(negotiation.attachTime + negotiation.contractLatency >= start + 150);
+    CHECK(negotiation.attachTime + negotiation.contractLatency <= start + 160);
+    CHECK(negotiation.attachTime + negotiation.voltageLatency >= start + 350);
+    CHECK(negotiation.attachTime + negotiation.voltageLatency <= start + 360);
+    CHECK_EQUAL(20, negotiation.voltage);
+    CHECK_EQUAL(0x1F, negotiation.receivedPdo);
+    CHECK(negotiation.fastCharge);
+    CHECK_EQUAL(0, observer.getHistory(1).attachTime);
+}
+
+TEST(ccToCvCycleIsMeasured)
+{
+    Harness h;
+    IP2366Sampler sampler(h.chip, 100);
+    IP2366ChargeAnalytics analytics;
+    CHECK_EQUAL(0, analytics.getHistory(0).startTime);
+    CHECK_EQUAL(0, analytics.getHistory(0).getDuration());
+    sampler.subscribe(IP2366ChargeAnalytics::onSample, &analytics);
+
+    h.scenario.start(IP2366Scenario::ccToCv, IP2366Scenario::ccToCvLength);
+    h.run(26000, [&]() { sampler.update(); });
+
+    CHECK(h.scenario.isFinished());
+    CHECK_EQUAL(1, analytics.getHistorySize());
+    const IP2366ChargeAnalytics::Cycle & cycle = analytics.getHistory(0);
+    CHECK(cycle.result == IP2366ChargeAnalytics::Result::FULL);
+
+    uint32_t cc = cycle.phases[IP2366ChargeAnalytics::CONSTANT_CURRENT].duration_ms;
+    uint32_t cv = cycle.phases[IP2366ChargeAnalytics::CONSTANT_VOLTAGE].duration_ms;
+    CHECK(cc >= 9900 && cc <= 10100);
+    CHECK(cv >= 14900 && cv <= 15100);
+    CHECK_EQUAL(3000, cycle.phases[IP2366ChargeAnalytics::CONSTANT_CURRENT].peakCurrent_mA);
+    CHECK(analytics.getHistory(1).result == IP2366ChargeAnalytics::Result::IN_PROGRESS);
+    CHECK_EQUAL(0, analytics.getHistory(1).getDuration());
+    CHECK_EQUAL(0, h.bus.getStats().nacks);
+}
+
+TEST(vsysOverCurrentCutsTheOutput)
+{
+    Harness h;
+    IP2366FaultMonitor monitor(h.chip, 5);
+    monitor.setCutOutput(IP2366::FAULT_VSYS_OVERCURRENT);
+    h.bus.setRegister(IP2366_REG_SYS_CTL11, 0xF0);
+
+    h.scenario.start(IP2366Scenario::vsysOverCurrent, IP2366Scenario::vsysOverCurrentLength);
+    uint32_t start = millis();
+    h.run(1100, [&]() { monitor.update(); });
+
+    CHECK(monitor.getLatched() & IP2366::FAULT_VSYS_OVERCURRENT);
+    uint32_t latency = monitor.getLatchTime(IP2366::FAULT_VSYS_OVERCURRENT) - start - 1000;
+    CHECK(latency <= 5);
+    CHECK_EQUAL(0x00, h.bus.getRegister(IP2366_REG_SYS_CTL11) & 0xF0);
+
+    // one 6 byte burst per poll, plus the read-modify-write that cut the output
+    const IP2366FaultMonitor::Stats & stats = monitor.getStats();
+    CHECK_EQUAL(readTime_us(6), stats.maxRead_us);
+    CHECK_EQUAL(stats.polls + 1, h.bus.getStats().reads);
+    CHECK_EQUAL(1, h.bus.getStats().writes);
+    CHECK_EQUAL(0, stats.errors);
+    CHECK(stats.maxPollGap_us <= 5000 + readTime_us(6) + 1000);
+}
+
+TEST(sleepMidReadKeepsTheLastGoodSample)
+{
+    Harness h;
+    IP2366Sampler sampler(h.chip, 100);
+
+    h.scenario.start(IP2366Scenario::sleepMidRead, IP2366Scenario::sleepMidReadLength);
+    h.run(1000, [&]() { sampler.update(); });
+
+    CHECK(h.bus.isAsleep());
+    CHECK(sampler.getLastError() != 0);
+    CHECK(h.bus.getStats().nacks >= 5); // the cut read at 500 ms and every poll after it
+    CHECK(sampler.isValid());
+    CHECK_EQUAL(8000, sampler.getAdc().VBATVoltage); // the torn read was not published
+    uint32_t sequence = sampler.getSequence();
+
+    h.run(1000, [&]() { sampler.update(); });
+    CHECK(!h.bus.isAsleep());
+    CHECK_EQUAL(0, sampler.getLastError());
+    CHECK(sampler.getSequence() > sequence);
+}
+
+static IP2366SimBus::Stats replay()
+{
+    Harness h;
+    IP2366Sampler sampler(h.chip, 10);
+    h.scenario.start(IP2366Scenario::pdAttach20V, IP2366Scenario::pdAttach20VLength);
+    h.run(600, [&]() { sampler.update(); });
+    return h.bus.getStats();
+}
+
+TEST(replayIsDeterministic)
+{
+    IP2366SimBus::Stats first = replay();
+    IP2366SimBus::Stats second = replay();
+    CHECK_EQUAL(first.reads, second.reads);
+    CHECK_EQUAL(first.bytes, second.bytes);
+    CHECK_EQUAL(first.busTime_us, second.busTime_us);
+}
+
+TEST(beginMeasuresStartupToTheFirstSample)
+{
+    Harness h;
+    CHECK(h.chip.begin());
+    const IP2366::Identity & identity = h.chip.getIdentity();
+    CHECK(identity.valid);
+
+    // probe, TIMENODE, config block and the first status block, all on simulated wire time
+    const IP2366SimBus::Stats & stats = h.bus.getStats();
+    CHECK_EQUAL(4, stats.reads);
+    CHECK_EQUAL(readTime_us(1) + readTime_us(5) + readTime_us(IP2366_CONFIG_BLOCK_SIZE) + readTime_us(8),
+                identity.startup_us);
+
+    h.bus.sleep();
+    CHECK(!h.chip.begin(20));
+    CHECK(!h.chip.getIdentity().valid);
+}
+
+TEST(provisioningFillsTheReportOnEveryPath)
+{
+    Harness h;
+    IP2366::Profile profile = {};
+    profile.set(IP2366_REG_SYS_CTL3, IP2366::encodeMaxInputPowerOrBatteryCurrent(5000));
+    IP2366::ProvisionReport report;
+    uint8_t errorCode = 0;
+
+    // success: the chip resets for 20 ms, then the profile is written and verified
+    h.bus.setResetTime(20);
+    CHECK(h.chip.resetAndProvision(profile, &report, 200, &errorCode));
+    CHECK_EQUAL(0, errorCode);
+    CHECK(report.ready_us >= 20000);
+    CHECK(report.total_us > report.ready_us);
+    CHECK(report.probes > 1);
+    CHECK_EQUAL(1, report.writes);
+    CHECK_EQUAL(0, report.mismatches);
+    CHECK_EQUAL(50, h.bus.getRegister(IP2366_REG_SYS_CTL3));
+
+    // the first read fails: nothing was done, but the report is written
+    memset(&report, 0xA5, sizeof(report));
+    h.bus.sleep();
+    CHECK(!h.chip.resetAndProvision(profile, &report, 200, &errorCode));
+    CHECK(errorCode != 0);
+    CHECK_EQUAL(0, report.probes);
+    CHECK_EQUAL(0, report.writes);
+    CHECK_EQUAL(0, report.ready_us);
+    CHECK(report.total_us < 10000);
+
+    // the chip never comes back from the reset: timeout, report with the probes made
+    h.bus.wake();
+    h.bus.setResetTime(1000);
+    memset(&report, 0xA5, sizeof(report));
+    CHECK(!h.chip.resetAndProvision(profile, &report, 50, &errorCode));
+    CHECK_EQUAL(5, errorCode);
+    CHECK(report.probes > 1);
+    CHECK_EQUAL(0, report.writes);
+    CHECK(report.total_us >= 50000);
+}
+
+// The advertisement as the chip holds it
+static IP2366SourcePdoManager::Advertisement advertisedBy(const IP2366SimBus & bus)
+{
+    uint8_t block[IP2366_SRC_PDO_BLOCK_SIZE];
+    for (uint8_t i = 0; i < IP2366_SRC_PDO_BLOCK_SIZE; i++)
+        block[i] = bus.getRegister(IP2366_REG_TypeC_CTL9 + i);
+    return IP2366SourcePdoManager::decode(block);
+}
+
+TEST(sourcePdoManagerDebouncesAndWritesOnlyChanges)
+{
+    Harness h;
+    IP2366SourcePdoManager manager(h.chip); // 60 W, 500 ms down, 5 s up, 200 mA hysteresis
+    auto poll = [&]() {
+        if (millis() % 10 == 0)
+            manager.update();
+    };
+
+    // from reset (5V 2400 mA only) up to 60 W: a raise waits debounceUp_ms, then the whole block goes in one burst
+    h.run(4900, poll);
+    CHECK_EQUAL(0, h.bus.getStats().writes);
+    CHECK_EQUAL(2400, advertisedBy(h.bus).current_mA[IP2366SourcePdoManager::PDO_5V]);
+    h.run(200, poll);
+    CHECK_EQUAL(1, manager.getUpdates());
+    CHECK_EQUAL(1, manager.getWrites());
+    CHECK_EQUAL(1, h.bus.getStats().writes);
+    IP2366SourcePdoManager::Advertisement chip = advertisedBy(h.bus);
+    CHECK_EQUAL(3000, chip.current_mA[IP2366SourcePdoManager::PDO_5V]);
+    CHECK_EQUAL(3000, chip.current_mA[IP2366SourcePdoManager::PDO_20V]);
+    CHECK_EQUAL(3000, chip.current_mA[IP2366SourcePdoManager::PDO_PPS1]);
+    CHECK_EQUAL(2850, chip.current_mA[IP2366SourcePdoManager::PDO_PPS2]);
+    CHECK_EQUAL(0x7E, h.bus.getRegister(IP2366_REG_TypeC_CTL17) & 0x7E);
+
+    // down to 30 W: after debounceDown_ms, one burst over the 12V - PPS2 registers only
+    uint8_t ctl9 = h.bus.getRegister(IP2366_REG_TypeC_CTL9), ctl10 = h.bus.getRegister(IP2366_REG_TypeC_CTL10);
+    manager.setBudget(30000);
+    h.run(480, poll);
+    CHECK_EQUAL(1, manager.getWrites());
+    h.run(40, poll);
+    CHECK_EQUAL(2, manager.getWrites());
+    CHECK_EQUAL(2, h.bus.getStats().writes);
+    chip = advertisedBy(h.bus);
+    CHECK_EQUAL(3000, chip.current_mA[IP2366SourcePdoManager::PDO_9V]);
+    CHECK_EQUAL(2500, chip.current_mA[IP2366SourcePdoManager::PDO_12V]);
+    CHECK_EQUAL(1500, chip.current_mA[IP2366SourcePdoManager::PDO_20V]);
+    CHECK_EQUAL(2700, chip.current_mA[IP2366SourcePdoManager::PDO_PPS1]);
+    CHECK_EQUAL(ctl9, h.bus.getRegister(IP2366_REG_TypeC_CTL9));
+    CHECK_EQUAL(ctl10, h.bus.getRegister(IP2366_REG_TypeC_CTL10));
+
+    // changes below hysteresis_mA are ignored
+    manager.setBudget(30500);
+    h.run(6000, poll);
+    CHECK_EQUAL(2, manager.getWrites());
+
+    // a Vsys over-current backs the budget off by 10% at once
+    h.bus.setRegister(IP2366_REG_STATE_CTL3, 0x20);
+    h.run(20, poll);
+    CHECK_EQUAL(10, manager.getBackoff());
+    CHECK_EQUAL(30500 * 90 / 100, manager.getEffectiveBudget());
+    CHECK_EQUAL(3, manager.getWrites());
+    CHECK_EQUAL(2280, advertisedBy(h.bus).current_mA[IP2366SourcePdoManager::PDO_12V]);
+    CHECK_EQUAL(0, h.bus.getStats().nacks);
+}
+
+TEST(sourcePdoBlockWriteReportsFailures)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    uint8_t current[IP2366_SRC_PDO_BLOCK_SIZE] = {0};
+    uint8_t target[IP2366_SRC_PDO_BLOCK_SIZE] = {0};
+    target[0] = 0x7F;
+    target[IP2366_SRC_PDO_BLOCK_SIZE - 1] = 0x02;
+
+    // two runs of changed registers, two transactions
+    uint8_t writes = 0;
+    CHECK(chip.writeSourcePdoBlock(target, current, &writes));
+    CHECK_EQUAL(2, writes);
+    CHECK_EQUAL(0x7F, bus.getRegister(IP2366_REG_TypeC_CTL9));
+    CHECK_EQUAL(0x02, bus.getRegister(IP2366_REG_TypeC_CTL17));
+    CHECK_EQUAL(0, memcmp(target, current, sizeof(target)));
+
+    // nothing changed, nothing written
+    CHECK(chip.writeSourcePdoBlock(target, current, &writes));
+    CHECK_EQUAL(0, writes);
+
+    // a failed write is reported without an errorCode, current keeps what the chip holds
+    target[1] = 0x10;
+    bus.sleep();
+    CHECK(!chip.writeSourcePdoBlock(target, current, &writes));
+    CHECK_EQUAL(1, writes);
+    CHECK_EQUAL(0, current[1]);
+}
+
+TEST(lowPowerMonitorCountsOnlyWrittenStandby)
+{
+    Harness h;
+    IP2366Sampler sampler(h.chip, 100);
+    IP2366LowPowerMonitor monitor(h.chip, sampler);
+    IP2366LowPowerMonitor::Config config;
+    config.period_ms = 1000;
+    monitor.setConfig(config);
+    h.chip.setIntPin(2);
+    monitor.begin();
+
+    h.run(2500, [&]() { monitor.update(); }); // windows at 0, 1000 and 2000 ms, each 100 ms of wake-up
+    IP2366LowPowerMonitor::Report report = monitor.getReport();
+    CHECK_EQUAL(3, report.windows);
+    CHECK_EQUAL(3, report.standbyWindows);
+    CHECK_EQUAL(3, report.samples);
+    CHECK_EQUAL(0xC0, h.bus.getRegister(IP2366_REG_SYS_CTL9) & 0xC0);
+
+    // the chip stops answering: the windows still close, but not in standby
+    h.bus.sleep();
+    h.run(2000, [&]() { monitor.update(); });
+    report = monitor.getReport();
+    CHECK_EQUAL(5, report.windows);
+    CHECK_EQUAL(3, report.standbyWindows);
+    CHECK_EQUAL(2, report.failures);
+
+    // back: standby is enabled again before it is requested
+    h.bus.wake();
+    h.bus.setRegister(IP2366_REG_SYS_CTL9, 0x00);
+    h.run(1000, [&]() { monitor.update(); });
+    report = monitor.getReport();
+    CHECK_EQUAL(6, report.windows);
+    CHECK_EQUAL(4, report.standbyWindows);
+    CHECK_EQUAL(0xC0, h.bus.getRegister(IP2366_REG_SYS_CTL9) & 0xC0);
+}
@@ -0,0 +1,105 @@
+// StaticIP2366 against IP2366: each accessor must produce the same register contents, transactions and
+// decoded values as the runtime driver it mirrors.
+#include "IP2366.h"
+#include "IP2366Sim.h"
+#include "IP2366Static.h"
+#include "IP2366Test.h"
+
+typedef StaticIP2366<0x75, IP2366BusRef<IP2366SimBus>> Static;
+
+// Runs the same call on both drivers, each on its own simulated chip preset to fill, and compares the result
+template <class RuntimeCall, class StaticCall>
+static void checkSame(uint8_t regAddress, uint8_t fill, RuntimeCall runtimeCall, StaticCall staticCall)
+{
+    IP2366SimBus runtimeBus, staticBus;
+    IP2366 runtime(runtimeBus);
+    IP2366BusRef<IP2366SimBus> ref(staticBus);
+    Static fixed(ref);
+    runtimeBus.setRegister(regAddress, fill);
+    staticBus.setRegister(regAddress, fill);
+
+    runtimeCall(runtime);
+    staticCall(fixed);
+    CHECK_EQUAL(runtimeBus.getRegister(regAddress), staticBus.getRegister(regAddress));
+    CHECK_EQUAL(runtimeBus.getStats().reads, staticBus.getStats().reads);
+    CHECK_EQUAL(runtimeBus.getStats().writes, staticBus.getStats().writes);
+}
+
+#define CHECK_SETTER(reg, fill, call)                                                                 \
+    checkSame(reg, fill, [&](IP2366 & chip) { chip.call; }, [&](Static & chip) { chip.call; })
+
+TEST(settersMatchTheRuntimeDriver)
+{
+    for (uint16_t fill = 0; fill <= 0xFF; fill += 0x55)
+    {
+        CHECK_SETTER(IP2366_REG_SYS_CTL0, fill & 0xBF, enableVbusSinkPD(fill & 1));
+        CHECK_SETTER(IP2366_REG_SYS_CTL0, fill & 0xBF, enableVbusSinkSCP(!(fill & 1)));
+        CHECK_SETTER(IP2366_REG_SYS_CTL0, fill & 0xBF, enableVbusSinkDPdM(true));
+        CHECK_SETTER(IP2366_REG_SYS_CTL2, fill, setFullChargeVoltage(4200));
+        CHECK_SETTER(IP2366_REG_SYS_CTL3, fill, setMaxInputPowerOrBatteryCurrent(4500));
+        CHECK_SETTER(IP2366_REG_SYS_CTL6, fill, setTrickleChargeCurrent(300));
+        CHECK_SETTER(IP2366_REG_SYS_CTL8, fill, setChargeStopCurrent(250));
+        CHECK_SETTER(IP2366_REG_SYS_CTL8, fill, setCellRechargeThreshold(100));
+        CHECK_SETTER(IP2366_REG_SYS_CTL9, fill, enableBATLow(true));
+        CHECK_SETTER(IP2366_REG_SYS_CTL9, fill, Standby(false));
+        CHECK_SETTER(IP2366_REG_SYS_CTL10, fill, setLowBatteryVoltage(3000));
+        CHECK_SETTER(IP2366_REG_SYS_CTL11, fill, setOutputFeatures(true, false, true, false));
+        CHECK_SETTER(IP2366_REG_SYS_CTL12, fill, setMaxOutputPower(IP2366::Vbus1OutputPower::W100));
+        CHECK_SETTER(IP2366_REG_SELECT_PDO, fill, setChargingPDOmode(IP2366::ChargingPDOmode::V15));
+        CHECK_SETTER(IP2366_REG_TypeC_CTL8, fill, setTypeCMode(IP2366::TypeCMode::UFP));
+        CHECK_SETTER(IP2366_REG_TypeC_CTL10, fill, setPDOCurrent5V(2000));
+        CHECK_SETTER(IP2366_REG_TypeC_CTL14, fill, setPDOCurrent20V(4500));
+        CHECK_SETTER(IP2366_REG_TypeC_CTL23, fill, setPDOCurrentPPS1(2500));
+        CHECK_SETTER(IP2366_REG_TypeC_CTL17, fill, enableSrcPdo(true, false, true, false, true, false));
+    }
+}
+
+TEST(gettersMatchTheRuntimeDriver)
+{
+    IP2366SimBus bus;
+    IP2366 runtime(bus);
+    IP2366BusRef<IP2366SimBus> ref(bus);
+    Static fixed(ref);
+    bus.setRegister(IP2366_REG_SYS_CTL2, 170);
+    bus.setRegister(IP2366_REG_SYS_CTL8, 0x5C);
+    bus.setRegister(IP2366_REG_SYS_CTL10, 0x60);
+    bus.setRegister(IP2366_REG_TypeC_CTL14, 200);
+    bus.setRegister(IP2366_REG_STATE_CTL0, 0x22);
+    bus.setRegister(IP2366_REG_STATE_CTL1, 0x40);
+    bus.setRegister(IP2366_REG_STATE_CTL2, 0x87);
+    bus.setRegister(IP2366_REG_TypeC_STATE, 0x90);
+    bus.setRegister16(IP2366_REG_BATVADC_DAT0, 8123);
+
+    CHECK_EQUAL(runtime.getFullChargeVoltage(), fixed.getFullChargeVoltage());
+    CHECK_EQUAL(runtime.getChargeStopCurrent(), fixed.getChargeStopCurrent());
+    CHECK_EQUAL(runtime.getLowBatteryVoltage(), fixed.getLowBatteryVoltage());
+    CHECK_EQUAL(runtime.getPDOCurrent20V(), fixed.getPDOCurrent20V());
+    CHECK_EQUAL(runtime.isFastCharge(), fixed.isFastCharge());
+    CHECK_EQUAL(runtime.isVbusPresent(), fixed.isVbusPresent());
+    CHECK_EQUAL(runtime.isTypeCSinkConnected(), fixed.isTypeCSinkConnected());
+    CHECK_EQUAL(runtime.isTypeCSinkPdConnected(), fixed.isTypeCSinkPdConnected());
+    CHECK_EQUAL(runtime.getChargeVoltage(), fixed.getChargeVoltage());
+    CHECK(fixed.getChargeState() == runtime.getChargeState());
+    CHECK_EQUAL(runtime.getVBATVoltage(), fixed.getVBATVoltage());
+    CHECK_EQUAL(runtime.getSystemStatus().raw(), fixed.getSystemStatus().raw());
+}
+
+TEST(errorPolicies)
+{
+    IP2366SimBus bus;
+    IP2366BusRef<IP2366SimBus> ref(bus);
+    Static checked(ref);
+    StaticIP2366<0x75, IP2366BusRef<IP2366SimBus>, IP2366UncheckedPolicy> unchecked(ref);
+    bus.sleep();
+
+    uint8_t errorCode = 0;
+    checked.getVBATVoltage(&errorCode);
+    CHECK(errorCode != 0);
+    errorCode = 0;
+    unchecked.getVBATVoltage(&errorCode);
+    CHECK_EQUAL(0, errorCode);
+
+    checked.setChargeStopCurrent(200, &errorCode); // read-modify-write stops at the failed read
+    CHECK(errorCode != 0);
+    CHECK_EQUAL(0, bus.getStats().writes);
+}
@@ -0,0 +1,164 @@
+// IP2366ThermalPolicy zone selection, hysteresis and write failures on IP2366SimBus, and the IP2366Ntc
+// resistance table against the Beta equation.
+#include "IP2366.h"
+#include "IP2366Ntc.h"
+#include "IP2366Sim.h"
+#include "IP2366Test.h"
+#include "IP2366ThermalPolicy.h"
+
+#include <math.h>
+
+// IP2366SimBus that NACKs the data of every write touching one register
+class NackingBus : public IP2366Bus
+{
+public:
+    IP2366SimBus sim;
+    int16_t failing = -1;
+
+    uint8_t writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length) override
+    {
+        if (failing >= regAddress && failing < regAddress + length)
+            return 3;
+        return sim.writeRegisters(address, regAddress, data, length);
+    }
+
+    uint8_t readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length) override
+    {
+        return sim.readRegisters(address, regAddress, data, length);
+    }
+};
+
+// The tests drive the temperature directly: resistance = 1000 + temperature in 0.1 degC
+static int16_t direct(uint32_t resistance_ohm)
+{
+    return (int16_t)((int32_t)resistance_ohm - 1000);
+}
+
+static bool heatTo(IP2366ThermalPolicy & policy, int16_t temperature)
+{
+    IP2366::AdcSnapshot adc = {};
+    adc.NTCResistance = 1000 + temperature;
+    return policy.update(adc);
+}
+
+static uint8_t outputPower(IP2366SimBus & bus)
+{
+    return bus.getRegister(IP2366_REG_SYS_CTL12) >> 5;
+}
+
+TEST(zonesFollowTheTemperatureWithHysteresis)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    IP2366ThermalPolicy policy(chip, direct); // default zones, 5000 mA, 2 degC hysteresis
+
+    CHECK(heatTo(policy, 250)); // the first update always applies its zone
+    CHECK_EQUAL(2, policy.getZone());
+    CHECK_EQUAL(1, bus.getRegister(IP2366_REG_SYS_CTL0) & 0x01);
+    CHECK_EQUAL(IP2366::encodeMaxInputPowerOrBatteryCurrent(5000), bus.getRegister(IP2366_REG_SYS_CTL3));
+    CHECK_EQUAL((uint8_t)IP2366::Vbus1OutputPower::W140, outputPower(bus));
+
+    // the 45 degC boundary is crossed at 46 degC heating and below 44 degC cooling
+    CHECK(!heatTo(policy, 455));
+    CHECK_EQUAL(2, policy.getZone());
+    CHECK(heatTo(policy, 460));
+    CHECK_EQUAL(3, policy.getZone());
+    CHECK_EQUAL(IP2366::encodeMaxInputPowerOrBatteryCurrent(2500), bus.getRegister(IP2366_REG_SYS_CTL3));
+    CHECK_EQUAL((uint8_t)IP2366::Vbus1OutputPower::W65, outputPower(bus));
+    CHECK(!heatTo(policy, 440));
+    CHECK_EQUAL(3, policy.getZone());
+    CHECK(heatTo(policy, 439));
+    CHECK_EQUAL(2, policy.getZone());
+
+    // a jump across several zones goes straight to the last one
+    CHECK(heatTo(policy, 700));
+    CHECK_EQUAL(5, policy.getZone());
+    CHECK_EQUAL(0, bus.getRegister(IP2366_REG_SYS_CTL0) & 0x01);
+    CHECK(heatTo(policy, -50));
+    CHECK_EQUAL(0, policy.getZone());
+    CHECK_EQUAL(0, bus.getRegister(IP2366_REG_SYS_CTL0) & 0x01);
+    CHECK(heatTo(policy, 50));
+    CHECK_EQUAL(1, policy.getZone());
+    CHECK_EQUAL(1, bus.getRegister(IP2366_REG_SYS_CTL0) & 0x01);
+    CHECK_EQUAL(IP2366::encodeMaxInputPowerOrBatteryCurrent(2500), bus.getRegister(IP2366_REG_SYS_CTL3));
+
+    // no writes while the zone holds
+    uint32_t writes = bus.getStats().writes;
+    CHECK(!heatTo(policy, 60));
+    CHECK_EQUAL(writes, bus.getStats().writes);
+}
+
+TEST(failedDeratingIsRetried)
+{
+    NackingBus bus;
+    IP2366 chip(bus);
+    IP2366ThermalPolicy policy(chip, direct);
+    CHECK(heatTo(policy, 250));
+
+    // SYS_CTL3 NACKs: the zone change fails before SYS_CTL12 is written and stays pending
+    bus.failing = IP2366_REG_SYS_CTL3;
+    CHECK(!heatTo(policy, 460));
+    CHECK_EQUAL(2, policy.getZone());
+    CHECK_EQUAL(IP2366::encodeMaxInputPowerOrBatteryCurrent(5000), bus.sim.getRegister(IP2366_REG_SYS_CTL3));
+    CHECK_EQUAL((uint8_t)IP2366::Vbus1OutputPower::W140, outputPower(bus.sim));
+    CHECK(!heatTo(policy, 460));
+    CHECK_EQUAL(2, policy.getZone());
+
+    bus.failing = -1;
+    CHECK(heatTo(policy, 460));
+    CHECK_EQUAL(3, policy.getZone());
+    CHECK_EQUAL(IP2366::encodeMaxInputPowerOrBatteryCurrent(2500), bus.sim.getRegister(IP2366_REG_SYS_CTL3));
+    CHECK_EQUAL((uint8_t)IP2366::Vbus1OutputPower::W65, outputPower(bus.sim));
+}
+
+TEST(updateReadsTheNtcFromTheChip)
+{
+    IP2366SimBus bus;
+    IP2366 chip(bus);
+    IP2366ThermalPolicy policy(chip, IP2366Ntc<3950, 10000>::toDeciCelsius);
+
+    // 10 kOhm at 20 uA: 200 mV on VGPIO0, 25 degC
+    bus.setRegister16(IP2366_REG_VGPIO0_NTC_DAT0, 200);
+    CHECK(policy.update());
+    CHECK_EQUAL(250, policy.getTemperature());
+    CHECK_EQUAL(2, policy.getZone());
+
+    bus.sleep();
+    CHECK(!policy.update());
+    CHECK_EQUAL(2, policy.getZone());
+}
+
+typedef IP2366Ntc<3950, 10000> Ntc;
+
+TEST(ntcTableFollowsTheBetaEquation)
+{
+    for (uint8_t i = 0; i < IP2366_NTC_POINTS; i++)
+    {
+        int celsius = IP2366_NTC_MIN_C + i * IP2366_NTC_STEP_C;
+        double exact = 10000 * exp(3950 * (1.0 / (celsius + 273.15) - 1.0 / 298.15));
+        CHECK(fabs(Ntc::Table::values[i] - exact) <= exact * 0.001 + 1);
+        CHECK(Ntc::toDeciCelsius(Ntc::Table::values[i]) >= celsius * 10 - 1);
+        CHECK(Ntc::toDeciCelsius(Ntc::Table::values[i]) <= celsius * 10 + 1);
+    }
+    CHECK_EQUAL(10000, Ntc::resistanceAt(25));
+    CHECK_EQUAL(250, Ntc::toDeciCelsius(10000));
+}
+
+TEST(ntcInterpolatesAndClamps)
+{
+    // between two table points, and monotonic over the whole range
+    int16_t middle = Ntc::toDeciCelsius((Ntc::resistanceAt(25) + Ntc::resistanceAt(30)) / 2);
+    CHECK(middle > 250 && middle < 300);
+    int16_t previous = Ntc::toDeciCelsius(400000);
+    for (uint32_t resistance = 400000; resistance > 300; resistance -= resistance / 64 + 1)
+    {
+        int16_t temperature = Ntc::toDeciCelsius(resistance);
+        CHECK(temperature >= previous);
+        previous = temperature;
+    }
+
+    CHECK_EQUAL(-400, Ntc::toDeciCelsius(Ntc::resistanceAt(-40)));
+    CHECK_EQUAL(-400, Ntc::toDeciCelsius(1000000));
+    CHECK_EQUAL(1250, Ntc::toDeciCelsius(Ntc::resistanceAt(125)));
+    CHECK_EQUAL(1250, Ntc::toDeciCelsius(0));
+}
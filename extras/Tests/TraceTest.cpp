@@ -0,0 +1,129 @@
+// IP2366TraceBus and IP2366ReplayBus: a driver session recorded over IP2366SimBus must replay through a fresh
+// driver with the same results, and any divergence from the recording must be counted.
+#include "IP2366.h"
+#include "IP2366Sim.h"
+#include "IP2366Test.h"
+#include "IP2366Trace.h"
+
+struct Results
+{
+    uint16_t vbat;
+    uint16_t stopCurrent;
+    uint32_t status;
+    IP2366::AdcSnapshot adc;
+    uint8_t writeError;
+    uint8_t sleepError;
+};
+
+// Reads, a read-modify-write and a read the sleeping chip NACKs
+static Results session(IP2366 & chip, IP2366SimBus * sim, uint16_t stopCurrent)
+{
+    Results results = {};
+    uint8_t errorCode = 0;
+    results.vbat = chip.getVBATVoltage();
+    results.status = chip.getSystemStatus().raw();
+    chip.readAdcSnapshot(results.adc);
+    chip.setChargeStopCurrent(stopCurrent, &errorCode);
+    results.writeError = errorCode;
+    results.stopCurrent = chip.getChargeStopCurrent();
+    if (sim != nullptr)
+        sim->sleep();
+    chip.getVBATVoltage(&errorCode);
+    results.sleepError = errorCode;
+    return results;
+}
+
+static void checkSame(const Results & expected, const Results & actual)
+{
+    CHECK_EQUAL(expected.vbat, actual.vbat);
+    CHECK_EQUAL(expected.stopCurrent, actual.stopCurrent);
+    CHECK_EQUAL(expected.status, actual.status);
+    CHECK_EQUAL(expected.adc.VBATVoltage, actual.adc.VBATVoltage);
+    CHECK_EQUAL(expected.adc.BATCurrent, actual.adc.BATCurrent);
+    CHECK_EQUAL(expected.adc.VsysPower, actual.adc.VsysPower);
+    CHECK_EQUAL(expected.adc.NTCResistance, actual.adc.NTCResistance);
+    CHECK_EQUAL(expected.writeError, actual.writeError);
+    CHECK_EQUAL(expected.sleepError, actual.sleepError);
+}
+
+struct Recording
+{
+    IP2366SimBus sim;
+    uint8_t buffer[512];
+    IP2366TraceBus trace;
+    Results results;
+
+    Recording() : trace(sim, buffer, sizeof(buffer))
+    {
+        sim.setRegister16(IP2366_REG_BATVADC_DAT0, 7650);
+        sim.setRegister16(IP2366_REG_IBATIADC_DAT0, 2100);
+        sim.setRegister16(IP2366_REG_VGPIO0_NTC_DAT0, 200);
+        sim.setRegister(IP2366_REG_STATE_CTL0, 0x22);
+        sim.setRegister(IP2366_REG_SYS_CTL8, 0x50);
+        IP2366 chip(trace);
+        results = session(chip, &sim, 250);
+    }
+};
+
+TEST(replayReproducesTheSession)
+{
+    Recording recording;
+    CHECK_EQUAL(0, recording.trace.getDropped());
+    CHECK_EQUAL(0, recording.results.writeError);
+    CHECK(recording.results.sleepError != 0);
+    CHECK_EQUAL(7650, recording.results.vbat);
+
+    IP2366ReplayBus replay(recording.trace.getData(), recording.trace.getSize());
+    IP2366 chip(replay);
+    checkSame(recording.results, session(chip, nullptr, 250));
+    CHECK_EQUAL(0, replay.getMismatches());
+    CHECK_EQUAL(recording.sim.getStats().reads + recording.sim.getStats().writes, replay.getTransactions());
+    CHECK(replay.isFinished());
+}
+
+TEST(divergenceIsCounted)
+{
+    Recording recording;
+    IP2366ReplayBus replay(recording.trace.getData(), recording.trace.getSize());
+    IP2366 chip(replay);
+
+    // a different value in the read-modify-write: the write payload differs, the rest still matches
+    Results results = session(chip, nullptr, 400);
+    CHECK_EQUAL(1, replay.getMismatches());
+    CHECK_EQUAL(recording.results.vbat, results.vbat);
+    CHECK_EQUAL(recording.results.sleepError, results.sleepError);
+
+    // the same session again runs past the end of the trace
+    replay.rewind();
+    session(chip, nullptr, 250);
+    CHECK_EQUAL(0, replay.getMismatches());
+    uint8_t errorCode = 0;
+    chip.getChargeStopCurrent(&errorCode);
+    CHECK(errorCode != 0);
+    CHECK_EQUAL(1, replay.getMismatches());
+}
+
+TEST(fullBufferDropsTransactions)
+{
+    IP2366SimBus sim;
+    uint8_t buffer[IP2366_TRACE_HEADER_SIZE + 1];
+    IP2366TraceBus trace(sim, buffer, sizeof(buffer));
+    IP2366 chip(trace);
+    sim.setRegister(IP2366_REG_SYS_CTL8, 0x5C);
+
+    chip.getChargeStopCurrent(); // one single byte read each
+    chip.getChargeStopCurrent();
+    CHECK_EQUAL(sizeof(buffer), trace.getSize());
+    CHECK_EQUAL(1, trace.getDropped());
+
+    IP2366TraceReader reader(trace.getData(), trace.getSize());
+    IP2366TraceRecord record;
+    CHECK(reader.next(record));
+    CHECK(record.read);
+    CHECK_EQUAL(0x75, record.address);
+    CHECK_EQUAL(IP2366_REG_SYS_CTL8, record.regAddress);
+    CHECK_EQUAL(1, record.length);
+    CHECK_EQUAL(0, record.error);
+    CHECK_EQUAL(0x5C, record.payload[0]);
+    CHECK(!reader.next(record));
+}
@@ -0,0 +1,95 @@
+// The Arduino build of the driver (IP2366_ARDUINO_API, Wire transport, Wire-default constructor),
+// compiled on the host against the shim in shim/ with IP2366SimBus behind Wire.
+#include <Wire.h>
+
+#include "IP2366.h"
+#include "IP2366Sim.h"
+#include "IP2366Static.h"
+#include "IP2366Test.h"
+
+TEST(defaultConstructorUsesWire)
+{
+    IP2366SimBus sim;
+    Wire.attach(&sim);
+    IP2366 chip;
+    sim.setRegister16(IP2366_REG_BATVADC_DAT0, 8123);
+
+    CHECK(chip.begin());
+    CHECK(Wire.isBegun());
+    CHECK_EQUAL(8123, chip.getVBATVoltage());
+
+    chip.setMaxInputPowerOrBatteryCurrent(4200);
+    CHECK_EQUAL(42, sim.getRegister(IP2366_REG_SYS_CTL3));
+    Wire.attach(nullptr);
+}
+
+TEST(burstReadThroughWire)
+{
+    IP2366SimBus sim;
+    Wire.attach(&sim);
+    IP2366WireBus bus(Wire);
+    bus.setByteDelay(0);
+    IP2366 chip(bus);
+    sim.setRegister(IP2366_REG_STATE_CTL0, 0x22);
+    sim.setRegister(IP2366_REG_STATE_CTL3, 0x10);
+
+    IP2366::SystemStatus status = chip.getSystemStatus();
+    CHECK_EQUAL(1, sim.getStats().reads);
+    CHECK(status.chargeState() == IP2366::ChargeState::CONSTANT_CURRENT);
+    CHECK(status.has(IP2366::SystemStatus::VSYS_SHORT_CIRCUIT));
+    Wire.attach(nullptr);
+}
+
+TEST(staticDriverSharesTheWireTransactions)
+{
+    IP2366SimBus sim;
+    Wire.attach(&sim);
+    StaticIP2366<0x75, IP2366StaticWireBus<0>> chip;
+    chip.begin();
+    sim.setRegister16(IP2366_REG_BATVADC_DAT0, 8123);
+    sim.setRegister(IP2366_REG_SYS_CTL8, 0x0F);
+
+    CHECK_EQUAL(8123, chip.getVBATVoltage());
+    chip.setChargeStopCurrent(250);
+    CHECK_EQUAL(0x5F, sim.getRegister(IP2366_REG_SYS_CTL8));
+    CHECK_EQUAL(2, sim.getStats().reads);
+    CHECK_EQUAL(1, sim.getStats().writes);
+
+    sim.sleep();
+    uint8_t errorCode = 0;
+    chip.getVBATVoltage(&errorCode);
+    CHECK(errorCode != 0);
+    Wire.attach(nullptr);
+}
+
+TEST(sleepingChipIsAnError)
+{
+    IP2366SimBus sim;
+    Wire.attach(&sim);
+    IP2366WireBus bus(Wire);
+    bus.setByteDelay(0);
+    IP2366 chip(bus);
+    sim.sleep();
+
+    uint8_t errorCode = 0;
+    chip.getVBATVoltage(&errorCode);
+    CHECK(errorCode != 0);
+    chip.enableCharger(true, &errorCode);
+    CHECK(errorCode != 0);
+    CHECK_EQUAL(0, sim.getStats().writes); // read-modify-write stops at the failed read
+    Wire.attach(nullptr);
+}
+
+TEST(intPinIsDriven)
+{
+    IP2366SimBus sim;
+    Wire.attach(&sim);
+    IP2366 chip;
+    chip.setIntPin(7);
+    CHECK_EQUAL(HIGH, digitalRead(7));
+    chip.allowSleep();
+    CHECK_EQUAL(LOW, digitalRead(7));
+    chip.wake();
+    CHECK_EQUAL(HIGH, digitalRead(7));
+    Wire.attach(nullptr);
+}
@@ -0,0 +1,34 @@
+#ifndef IP2366_SHIM_ARDUINO_H
+#define IP2366_SHIM_ARDUINO_H
+
+// Host stand-in for the Arduino core, enough to build the library with IP2366_ARDUINO_API (Wire transport
+// and Wire-default constructor included). Timing comes from IP2366Platform.h; pin levels are recorded
+// so tests can check the INT pin.
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define IP2366_HOST_TIMING
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+#define IP2366_SHIM_PINS 64
+
+inline uint8_t * ip2366ShimPins()
+{
+    static uint8_t pins[IP2366_SHIM_PINS];
+    return pins;
+}
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pin < IP2366_SHIM_PINS)
+        ip2366ShimPins()[pin] = value;
+}
+inline int digitalRead(uint8_t pin) { return pin < IP2366_SHIM_PINS ? ip2366ShimPins()[pin] : LOW; }
+
+#endif
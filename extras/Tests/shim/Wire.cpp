@@ -0,0 +1,51 @@
+#include "Wire.h"
+
+TwoWire Wire;
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    txAddress = address;
+    txLength = 0;
+    txOverflow = false;
+}
+
+size_t TwoWire::write(uint8_t value)
+{
+    if (txLength >= BUFFER_LENGTH)
+    {
+        txOverflow = true;
+        return 0;
+    }
+    tx[txLength++] = value;
+    return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool stop)
+{
+    if (txOverflow)
+        return 1; // data too long
+    if (device == nullptr || txLength == 0)
+        return 2; // nobody on the bus
+
+    if (!stop)
+    {
+        pointerSet = true;
+        pointer = tx[0];
+        return 0;
+    }
+    pointerSet = false;
+    return device->writeRegisters(txAddress, tx[0], tx + 1, txLength - 1);
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool stop)
+{
+    rxLength = 0;
+    rxIndex = 0;
+    if (device == nullptr || !pointerSet || quantity > BUFFER_LENGTH)
+        return 0;
+    pointerSet = !stop;
+    if (device->readRegisters(address, pointer, rx, quantity))
+        return 0;
+    rxLength = quantity;
+    return quantity;
+}
@@ -0,0 +1,44 @@
+#ifndef IP2366_SHIM_WIRE_H
+#define IP2366_SHIM_WIRE_H
+
+// Host stand-in for the Arduino Wire library. Transactions are forwarded to an IP2366Bus (usually an
+// IP2366SimBus) attached with attach(); like a real TwoWire, a write is sent by endTransmission() and a
+// read is the register write with endTransmission(false) followed by requestFrom().
+#include <Arduino.h>
+
+#include "IP2366Bus.h"
+
+#define BUFFER_LENGTH 32
+
+class TwoWire
+{
+public:
+    void attach(IP2366Bus * device) { this->device = device; };
+
+    void begin() { begun = true; };
+    bool isBegun() const { return begun; };
+
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t value);
+    uint8_t endTransmission(bool stop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, bool stop = true);
+    int available() { return rxLength - rxIndex; };
+    int read() { return rxIndex < rxLength ? rx[rxIndex++] : -1; };
+
+private:
+    IP2366Bus * device = nullptr;
+    bool begun = false;
+    uint8_t txAddress = 0;
+    uint8_t tx[BUFFER_LENGTH];
+    uint8_t txLength = 0;
+    bool txOverflow = false;
+    bool pointerSet = false; // register address sent without a stop, waiting for requestFrom()
+    uint8_t pointer = 0;
+    uint8_t rx[BUFFER_LENGTH];
+    uint8_t rxLength = 0;
+    uint8_t rxIndex = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -1,85 +1,260 @@
 #include "IP2366.h"
-#include <Arduino.h>
-
-// Registers
-
-// System Control Registers
-#define IP2366_REG_SYS_CTL0 0x00  // Charge enable and other control settings
-#define IP2366_REG_SYS_CTL2 0x02  // Vset full-charge voltage setting
-#define IP2366_REG_SYS_CTL3 0x03  // Iset charge power or current setting
-#define IP2366_REG_SYS_CTL4 0x04  // Battery capacity setting
-#define IP2366_REG_SYS_CTL6 0x06  // Trickle charge current, threshold and charge timeout setting
-#define IP2366_REG_SYS_CTL8 0x08  // Stop charge current and recharge threshold setting
-#define IP2366_REG_SYS_CTL9 0x09  // Standby enable and low battery voltage settings
-#define IP2366_REG_SYS_CTL10 0x0A // Low battery voltage setting
-#define IP2366_REG_SYS_CTL11 0x0B // Output enable register
-#define IP2366_REG_SYS_CTL12 0x0C // Output maximum power selection register
-
-// TYPE-C Control Registers
-#define IP2366_REG_SYS_CTL12 0x0C   // Output maximum power selection register
-#define IP2366_REG_SELECT_PDO 0x0D  // select charging PDO gear
-#define IP2366_REG_TypeC_CTL8 0x22  // TYPE-C mode control register
-#define IP2366_REG_TypeC_CTL9 0x23  // Output Pdo current setting register
-#define IP2366_REG_TypeC_CTL10 0x24 // 5VPdo current setting register
-#define IP2366_REG_TypeC_CTL11 0x25 // 9VPdo current setting register
-#define IP2366_REG_TypeC_CTL12 0x26 // 12VPdo current setting register
-#define IP2366_REG_TypeC_CTL13 0x27 // 15VPdo current setting register
-#define IP2366_REG_TypeC_CTL14 0x28 // 20VPdo current setting register
-#define IP2366_REG_TypeC_CTL17 0x2B // Output Pdo setting register
-#define IP2366_REG_TypeC_CTL23 0x29 // Pps1 Pdo current setting register
-#define IP2366_REG_TypeC_CTL24 0x2A // Pps2 Pdo current setting register
-#define IP2366_REG_TypeC_CTL18 0x2C // PDO plus 10mA current enable, needs to be configured together with the current setting register
-
-// Read-only Status Indication Registers
-#define IP2366_REG_STATE_CTL0 0x31   // Charge status control register
-#define IP2366_REG_STATE_CTL1 0x32   // Charge status control register 2
-#define IP2366_REG_STATE_CTL2 0x33   // Input Pd status control register
-#define IP2366_REG_TypeC_STATE 0x34  // System status indication register
-#define IP2366_REG_RECEIVED_PDO 0x35 // receive PDO gear
-#define IP2366_REG_STATE_CTL3 0x38   // System over-current indication register
-
-// ADC Data Registers
-#define IP2366_REG_BATVADC_DAT0 0x50         // VBAT voltage low 8 bits
-#define IP2366_REG_BATVADC_DAT1 0x51         // VBAT voltage high 8 bits
-#define IP2366_REG_VsysVADC_DAT0 0x52        // Vsys voltage low 8 bits
-#define IP2366_REG_VsysVADC_DAT1 0x53        // Vsys voltage high 8 bits
-#define IP2366_REG_TIMENODE1 0x69            // 1st bit of the timestamp register (the timestamp symbol is an ASCII character)
-#define IP2366_REG_TIMENODE2 0x6A            // 2nd bit of the timestamp register (the timestamp symbol is an ASCII character)
-#define IP2366_REG_TIMENODE3 0x6B            // 3rd bit of the timestamp register (the timestamp symbol is an ASCII character)
-#define IP2366_REG_TIMENODE4 0x6C            // 4th bit of the timestamp register (the timestamp symbol is an ASCII character)
-#define IP2366_REG_TIMENODE5 0x6D            // 4th bit of the timestamp register (the timestamp symbol is an ASCII character)
-#define IP2366_REG_IBATIADC_DAT0 0x6E        // BAT-end current low 8 bits
-#define IP2366_REG_IBATIADC_DAT1 0x6F        // BAT-end current high 8 bits
-#define IP2366_REG_ISYS_IADC_DAT0 0x70       // IVsys-end current low 8 bits
-#define IP2366_REG_IVsys_IADC_DAT1 0x71      // IVsys-end current high 8 bits
-#define IP2366_REG_Vsys_POW_DAT0 0x74        // Vsysterminal power low 8 bits
-#define IP2366_REG_Vsys_POW_DAT1 0x75        // Vsysterminal power high 8 bits
-
-// Additional ADC Data Registers for NTC, GPIOs
-#define IP2366_REG_INTC_IADC_DAT0 0x77     // NTC output current setting
-#define IP2366_REG_VGPIO0_NTC_DAT0 0x78    // VGPIO0_NTC ADC voltage low 8 bits
-#define IP2366_REG_VGPIO0_NTC_DAT1 0x79    // VGPIO0_NTC ADC voltage high 8 bits
-
-#define ADC_TO_MV(adc_val) ((uint16_t)((((uint32_t)(adc_val) * 3300) / 0xFFFF)))
+#include "IP2366Registers.h"
+#include <string.h>
+
 #define TwoWire_h
-void IP2366::begin()
+
+// Wire transport
+
+#ifdef IP2366_ARDUINO
+uint8_t IP2366WireBus::writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length)
 {
 #ifdef TwoWire_h
-    Wire.begin();
+    return IP2366WireTransfer::write(wire, address, regAddress, data, length, [this]() { pause(); });
+#else
+    return 4;
 #endif
 }
 
-uint8_t IP2366::writeRegister(uint8_t regAddress, uint8_t value, uint8_t * errorCode)
+uint8_t IP2366WireBus::readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length)
+{
+#ifdef TwoWire_h
+    return IP2366WireTransfer::read(wire, address, regAddress, data, length, [this]() { pause(); }); // delay between each byte, see setByteDelay()
+#else
+    memset(data, 0xFF, length);
+    return 4;
+#endif
+}
+
+void IP2366WireBus::begin()
 {
 #ifdef TwoWire_h
-    Wire.beginTransmission(IP2366_address);
-    delay (1);
-    Wire.write(regAddress);
-    delay (1);
-    Wire.write(value);
-    delay (1);
-    uint8_t _errorCode = Wire.endTransmission(); // Send a stop signal
-    delay (1);
+    wire.begin();
+#endif
+}
+
+void IP2366WireBus::pause()
+{
+    if (byteDelay)
+        delay(byteDelay);
+}
+#endif
+
+bool IP2366::begin(uint16_t timeout_ms)
+{
+    uint32_t start = micros();
+    identity.valid = false;
+    bus->begin();
+    wake(); // no-op without an INT pin or when already HIGH
+
+    if (!probe(timeout_ms))
+        return false;
+
+    uint8_t timenode[5];
+    if (readRegisters(IP2366_REG_TIMENODE1, timenode, sizeof(timenode)) ||
+        readRegisters(IP2366_REG_SYS_CTL0, identity.config, sizeof(identity.config)))
+        return false;
+
+    memcpy(identity.timenode, timenode, sizeof(timenode));
+    identity.timenode[5] = 0;
+    selectQuirks();
+
+    // startup ends with the first valid sample, read with the quirks of this revision
+    StatusSnapshot status;
+    if (!readStatusSnapshot(status))
+        return false;
+    identity.startup_us = micros() - start;
+    identity.valid = true;
+    return true;
+}
+
+bool IP2366::probe(uint16_t timeout_ms)
+{
+    uint32_t start = millis();
+    while (true)
+    {
+        uint8_t value;
+        lockBus();
+        uint8_t _errorCode = bus->readRegisters(IP2366_address, IP2366_REG_STATE_CTL0, &value, 1);
+        unlockBus();
+        if (!_errorCode)
+            return true;
+        if ((uint32_t)(millis() - start) >= timeout_ms)
+            return false;
+        delay(1);
+    }
+}
+
+bool IP2366::resetAndProvision(const Profile & profile, ProvisionReport * report, uint16_t timeout_ms, uint8_t * errorCode)
+{
+    if (errorCode != nullptr) *errorCode = 0; // reset error code
+    ProvisionReport _report = {0, 0, 0, 0, 0};
+    BusGuard guard(*this);
+    uint32_t start = micros();
+
+    // SECTION: reset, the write may not be acknowledged once the chip has started resetting
+    uint8_t sysCtl0;
+    if (readRegisters(IP2366_REG_SYS_CTL0, &sysCtl0, 1, errorCode))
+    {
+        _report.total_us = micros() - start;
+        if (report != nullptr) *report = _report;
+        return false;
+    }
+    writeRegister(IP2366_REG_SYS_CTL0, sysCtl0 | 0x40);
+
+    // SECTION: readiness, short reads instead of a fixed delay
+    uint32_t startPoll = millis();
+    while (true)
+    {
+        _report.probes++;
+        if (!readRegisters(IP2366_REG_SYS_CTL0, &sysCtl0, 1) && !(sysCtl0 & 0x40))
+            break;
+        if ((uint32_t)(millis() - startPoll) >= timeout_ms)
+        {
+            if (errorCode != nullptr) *errorCode = 5; // timeout
+            _report.total_us = micros() - start;
+            if (report != nullptr) *report = _report;
+            return false;
+        }
+        delay(1);
+    }
+    _report.ready_us = micros() - start;
+
+    // SECTION: apply, consecutive changed registers go out in one burst
+    uint8_t current[IP2366_CONFIG_BLOCK_SIZE];
+    uint8_t target[IP2366_CONFIG_BLOCK_SIZE];
+    bool ok = !readRegisters(IP2366_REG_SYS_CTL0, current, sizeof(current), errorCode);
+    for (uint8_t i = 0; i < sizeof(target); i++)
+        target[i] = (current[i] & ~profile.masks[i]) | (profile.values[i] & profile.masks[i]);
+
+    if (ok)
+        ok = writeChanged(IP2366_REG_SYS_CTL0, target, current, sizeof(current), _report.writes, errorCode);
+
+    // SECTION: verify
+    if (ok)
+        ok = !readRegisters(IP2366_REG_SYS_CTL0, current, sizeof(current), errorCode);
+    if (ok)
+    {
+        for (uint8_t j = 0; j < sizeof(current); j++)
+        {
+            if ((current[j] ^ target[j]) & profile.masks[j])
+                _report.mismatches++;
+        }
+        if (identity.valid)
+            memcpy(identity.config, current, sizeof(current));
+    }
+
+    _report.total_us = micros() - start;
+    if (report != nullptr) *report = _report;
+    return ok && _report.mismatches == 0;
+}
+
+bool IP2366::writeChanged(uint8_t regAddress, const uint8_t * target, uint8_t * current, uint8_t length, uint8_t & writes, uint8_t * errorCode)
+{
+    uint8_t i = 0;
+    while (i < length)
+    {
+        if (target[i] == current[i])
+        {
+            i++;
+            continue;
+        }
+        uint8_t first = i;
+        while (i < length && target[i] != current[i])
+            i++;
+        writes++;
+        if (writeRegisters(regAddress + first, target + first, i - first, errorCode))
+            return false;
+        memcpy(current + first, target + first, i - first);
+    }
+    return true;
+}
+
+void IP2366::selectQuirks()
+{
+    for (uint8_t i = 0; i < quirkRuleCount; i++)
+    {
+        const char * prefix = quirkRules[i].timenode;
+        if (strncmp(identity.timenode, prefix, strlen(prefix)) == 0)
+            identity.quirks |= quirkRules[i].quirks;
+    }
+}
+
+// INT pin
+
+void IP2366::setIntPin(int8_t pin)
+{
+    intPin = pin;
+    if (intPin >= 0)
+    {
+        pinMode(intPin, OUTPUT);
+        wake();
+    }
+}
+
+void IP2366::wake()
+{
+    if (intPin < 0)
+        return;
+    if (!intHigh)
+        wakeStart = millis();
+    digitalWrite(intPin, HIGH);
+    intHigh = true;
+}
+
+void IP2366::allowSleep()
+{
+    if (intPin < 0)
+        return;
+    digitalWrite(intPin, LOW);
+    intHigh = false;
+}
+
+bool IP2366::isWakeComplete() const
+{
+    return intPin < 0 || (intHigh && (uint32_t)(millis() - wakeStart) >= IP2366_WAKE_TIME_MS);
+}
+
+// Bus locking
+
+void IP2366::lockBus()
+{
+    if (busLock == nullptr)
+        return;
+    busLock->lock();
+    if (lockDepth++ == 0)
+        lockStart = micros();
+}
+
+void IP2366::unlockBus()
+{
+    if (busLock == nullptr)
+        return;
+    if (--lockDepth == 0)
+    {
+        uint32_t held = micros() - lockStart;
+        lockStats.count++;
+        lockStats.total_us += held;
+        if (held > lockStats.max_us)
+            lockStats.max_us = held;
+    }
+    busLock->unlock();
+}
+
+void IP2366::resetLockStats()
+{
+    lockBus();
+    lockStats = {0, 0, 0};
+    unlockBus();
+}
+
+// Register access
+
+uint8_t IP2366::writeRegister(uint8_t regAddress, uint8_t value, uint8_t * errorCode)
+{
+    lockBus();
+    uint8_t _errorCode = bus->writeRegisters(IP2366_address, regAddress, &value, 1);
+    unlockBus();
 
     if (_errorCode)
     {
@@ -90,21 +265,14 @@ uint8_t IP2366::writeRegister(uint8_t regAddress, uint8_t value, uint8_t * error
         return -1;
     }
     return 0;
-#else
-    return -1;
-#endif
 }
 
-uint8_t IP2366::readRegister(uint8_t regAddress, uint8_t * errorCode)
+uint8_t IP2366::writeRegisters(uint8_t regAddress, const uint8_t * data, uint8_t length, uint8_t * errorCode)
 {
-#ifdef TwoWire_h
-    Wire.beginTransmission(IP2366_address);
-    delay (1); // increase the delay by 1ms between each byte
-    Wire.write(regAddress);
-    delay (1); // increase the delay by 1ms between each byte
-    uint8_t _errorCode = Wire.endTransmission(false); // Do not send a stop signal
-    delay (1);
-    
+    lockBus();
+    uint8_t _errorCode = bus->writeRegisters(IP2366_address, regAddress, data, length);
+    unlockBus();
+
     if (_errorCode)
     {
         if (errorCode != nullptr)
@@ -113,21 +281,67 @@ uint8_t IP2366::readRegister(uint8_t regAddress, uint8_t * errorCode)
         }
         return -1;
     }
+    return 0;
+}
 
-    uint8_t bytesRead = Wire.requestFrom(IP2366_address, (uint8_t)1, (bool)true); // Request 1 byte and send a stop signal
+uint8_t IP2366::readRegister(uint8_t regAddress, uint8_t * errorCode)
+{
+    uint8_t value = 0;
+    lockBus();
+    uint8_t _errorCode = bus->readRegisters(IP2366_address, regAddress, &value, 1);
+    unlockBus();
 
-    if (bytesRead != 1)
+    if (_errorCode)
     {
         if (errorCode != nullptr)
         {
             *errorCode = _errorCode; // write error code only if it > 0
         }
-        return 0;
     }
-    return Wire.read(); //read from I2C internal buffer
-#else
-    return -1;
-#endif
+    return value;
+}
+
+uint8_t IP2366::readRegisters(uint8_t regAddress, uint8_t * data, uint8_t length, uint8_t * errorCode)
+{
+    uint8_t _errorCode = 0;
+    lockBus();
+    if (identity.quirks & QUIRK_SINGLE_BYTE_READS)
+    {
+        for (uint8_t i = 0; i < length && !_errorCode; i++)
+            _errorCode = bus->readRegisters(IP2366_address, regAddress + i, data + i, 1);
+    }
+    else
+    {
+        _errorCode = bus->readRegisters(IP2366_address, regAddress, data, length);
+    }
+    unlockBus();
+
+    if (_errorCode)
+    {
+        if (errorCode != nullptr)
+        {
+            *errorCode = _errorCode; // write error code only if it > 0
+        }
+        return -1;
+    }
+    return 0;
+}
+
+// Atomic read-modify-write of the bits selected by mask; nothing is written if the read fails
+uint8_t IP2366::updateRegister(uint8_t regAddress, uint8_t mask, uint8_t value, uint8_t * errorCode)
+{
+    uint8_t current;
+    lockBus();
+    uint8_t result = readRegisters(regAddress, &current, 1, errorCode);
+    if (result == 0)
+        result = writeRegister(regAddress, (current & ~mask) | (value & mask), errorCode);
+    unlockBus();
+    return result;
+}
+
+uint8_t IP2366::updateBit(uint8_t regAddress, uint8_t bit, bool enable, uint8_t * errorCode)
+{
+    return updateRegister(regAddress, 1 << bit, enable ? (1 << bit) : 0, errorCode);
 }
 
 uint8_t IP2366::setBit(uint8_t value, uint8_t bit, bool enable)
@@ -140,9 +354,7 @@ uint8_t IP2366::setBit(uint8_t value, uint8_t bit, bool enable)
 void IP2366::enableCharger(bool enable, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_SYS_CTL0, errorCode);
-    value = setBit(value, 0, enable);
-    writeRegister(IP2366_REG_SYS_CTL0, value, errorCode);
+    updateBit(IP2366_REG_SYS_CTL0, 0, enable, errorCode);
 }
 
 bool IP2366::isChargerEnabled(uint8_t * errorCode)
@@ -154,9 +366,7 @@ bool IP2366::isChargerEnabled(uint8_t * errorCode)
 void IP2366::enableVbusSinkSCP(bool enable, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_SYS_CTL0, errorCode);
-    value = setBit(value, 2, enable);
-    writeRegister(IP2366_REG_SYS_CTL0, value, errorCode);
+    updateBit(IP2366_REG_SYS_CTL0, 2, enable, errorCode);
 }
 
 bool IP2366::isVbusSinkSCPEnabled(uint8_t * errorCode)
@@ -168,9 +378,7 @@ bool IP2366::isVbusSinkSCPEnabled(uint8_t * errorCode)
 void IP2366::enableVbusSinkPD(bool enable, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_SYS_CTL0, errorCode);
-    value = setBit(value, 3, enable);
-    writeRegister(IP2366_REG_SYS_CTL0, value, errorCode);
+    updateBit(IP2366_REG_SYS_CTL0, 3, enable, errorCode);
 }
 
 bool IP2366::isVbusSinkPDEnabled(uint8_t * errorCode)
@@ -182,9 +390,7 @@ bool IP2366::isVbusSinkPDEnabled(uint8_t * errorCode)
 void IP2366::enableVbusSinkDPdM(bool enable, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_SYS_CTL0, errorCode);
-    value = setBit(value, 4, enable);
-    writeRegister(IP2366_REG_SYS_CTL0, value, errorCode);
+    updateBit(IP2366_REG_SYS_CTL0, 4, enable, errorCode);
 }
 
 bool IP2366::isVbusSinkDPdMEnabled(uint8_t * errorCode)
@@ -196,9 +402,7 @@ bool IP2366::isVbusSinkDPdMEnabled(uint8_t * errorCode)
 void IP2366::enableINTLow(bool enable, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_SYS_CTL0, errorCode);
-    value = setBit(value, 5, enable);
-    writeRegister(IP2366_REG_SYS_CTL0, value, errorCode);
+    updateBit(IP2366_REG_SYS_CTL0, 5, enable, errorCode);
 }
 
 bool IP2366::isINTLowEnabled(uint8_t * errorCode)
@@ -210,17 +414,13 @@ bool IP2366::isINTLowEnabled(uint8_t * errorCode)
 void IP2366::ResetMCU(bool enable, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_SYS_CTL0, errorCode);
-    value = setBit(value, 6, enable);
-    writeRegister(IP2366_REG_SYS_CTL0, value, errorCode);
+    updateBit(IP2366_REG_SYS_CTL0, 6, enable, errorCode);
 }
 
 void IP2366::enableLoadOTP(bool enable, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_SYS_CTL0, errorCode);
-    value = setBit(value, 7, enable);
-    writeRegister(IP2366_REG_SYS_CTL0, value, errorCode);
+    updateBit(IP2366_REG_SYS_CTL0, 7, enable, errorCode);
 }
 
 bool IP2366::isLoadOTPEnabled(uint8_t * errorCode)
@@ -234,27 +434,13 @@ bool IP2366::isLoadOTPEnabled(uint8_t * errorCode)
 void IP2366::setFullChargeVoltage(uint16_t voltage, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint16_t minVoltage, maxVoltage;
-    minVoltage = 2500;
-    maxVoltage = 4400;
-
-    if (voltage < minVoltage)
-        voltage = minVoltage;
-    else if (voltage > maxVoltage)
-        voltage = maxVoltage;
-
-    uint8_t regValue = (voltage - minVoltage) / 10;
-    writeRegister(IP2366_REG_SYS_CTL2, regValue, errorCode);
+    writeRegister(IP2366_REG_SYS_CTL2, encodeFullChargeVoltage(voltage), errorCode);
 }
 
 uint16_t IP2366::getFullChargeVoltage(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t regValue = readRegister(IP2366_REG_SYS_CTL2, errorCode);
-
-    uint16_t baseVoltage = 2500;
-
-    return baseVoltage + regValue * 10;
+    return decodeFullChargeVoltage(readRegister(IP2366_REG_SYS_CTL2, errorCode));
 }
 
 // SYS_CTL3
@@ -262,22 +448,13 @@ uint16_t IP2366::getFullChargeVoltage(uint8_t * errorCode)
 void IP2366::setMaxInputPowerOrBatteryCurrent(uint16_t current_mA, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t regValue;
-    uint16_t maxCurrent = 9700;
-    if (current > maxCurrent)
-        current = maxCurrent;
-
-    regValue = current / 100;
-
-    writeRegister(IP2366_REG_SYS_CTL3, regValue, errorCode);
+    writeRegister(IP2366_REG_SYS_CTL3, encodeMaxInputPowerOrBatteryCurrent(current_mA), errorCode);
 }
 
 uint16_t IP2366::getMaxInputPowerOrBatteryCurrent(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t regValue = readRegister(IP2366_REG_SYS_CTL3, errorCode);
-
-    return regValue * 100;
+    return decodeMaxInputPowerOrBatteryCurrent(readRegister(IP2366_REG_SYS_CTL3, errorCode));
 }
 
 // SYS_CTL6
@@ -285,15 +462,13 @@ uint16_t IP2366::getMaxInputPowerOrBatteryCurrent(uint8_t * errorCode)
 void IP2366::setTrickleChargeCurrent(uint16_t current, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t regValue = current / 50;
-    writeRegister(IP2366_REG_SYS_CTL6, regValue, errorCode);
+    writeRegister(IP2366_REG_SYS_CTL6, encodeTrickleChargeCurrent(current), errorCode);
 }
 
 uint16_t IP2366::getTrickleChargeCurrent(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t regValue = readRegister(IP2366_REG_SYS_CTL6, errorCode);
-    return static_cast<uint16_t>(regValue * 50);
+    return decodeTrickleChargeCurrent(readRegister(IP2366_REG_SYS_CTL6, errorCode));
 }
 
 // SYS_CTL8
@@ -301,44 +476,25 @@ uint16_t IP2366::getTrickleChargeCurrent(uint8_t * errorCode)
 void IP2366::setChargeStopCurrent(uint16_t current, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    if (current > 750)
-        current = 750;
-    uint8_t regValue = current / 50;
-
-    uint8_t currentValue = readRegister(IP2366_REG_SYS_CTL8, errorCode) & 0x0F;
-    writeRegister(IP2366_REG_SYS_CTL8, currentValue | (regValue << 4), errorCode);
+    updateRegister(IP2366_REG_SYS_CTL8, 0xF0, encodeChargeStopCurrent(current) << 4, errorCode);
 }
 
 uint16_t IP2366::getChargeStopCurrent(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = (readRegister(IP2366_REG_SYS_CTL8, errorCode) >> 4) & 0x0F;
-    return value * 50;
+    return decodeChargeStopCurrent(readRegister(IP2366_REG_SYS_CTL8, errorCode) >> 4);
 }
 
 void IP2366::setCellRechargeThreshold(uint16_t voltageDrop_mV, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t regValue = 0;
-
-    if (voltageDrop_mV >= 400)
-    {
-        regValue = 3;
-    }
-    else
-    {
-        regValue = voltageDrop_mV / 50;
-    }
-
-    uint8_t currentValue = readRegister(IP2366_REG_SYS_CTL8, errorCode) & 0xF3;
-    writeRegister(IP2366_REG_SYS_CTL8, currentValue | (regValue << 2), errorCode);
+    updateRegister(IP2366_REG_SYS_CTL8, 0x0C, encodeCellRechargeThreshold(voltageDrop_mV) << 2, errorCode);
 }
 
 uint16_t IP2366::getCellRechargeThreshold(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = (readRegister(IP2366_REG_SYS_CTL8, errorCode) >> 2) & 0x03;
-    return (value * 50);
+    return decodeCellRechargeThreshold(readRegister(IP2366_REG_SYS_CTL8, errorCode) >> 2);
 }
 
 // SYS_CTL9
@@ -346,9 +502,7 @@ uint16_t IP2366::getCellRechargeThreshold(uint8_t * errorCode)
 void IP2366::enableStandbyMode(bool enable, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_SYS_CTL9, errorCode);
-    value = setBit(value, 7, enable);
-    writeRegister(IP2366_REG_SYS_CTL9, value, errorCode);
+    updateBit(IP2366_REG_SYS_CTL9, 7, enable, errorCode);
 }
 
 bool IP2366::isStandbyModeEnabled(uint8_t * errorCode)
@@ -360,9 +514,7 @@ bool IP2366::isStandbyModeEnabled(uint8_t * errorCode)
 void IP2366::Standby(bool enable, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_SYS_CTL9, errorCode);
-    value = setBit(value, 6, enable);
-    writeRegister(IP2366_REG_SYS_CTL9, value, errorCode);
+    updateBit(IP2366_REG_SYS_CTL9, 6, enable, errorCode);
 }
 
 bool IP2366::isStandby(uint8_t * errorCode)
@@ -374,9 +526,7 @@ bool IP2366::isStandby(uint8_t * errorCode)
 void IP2366::enableBATLow(bool enable, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_SYS_CTL9, errorCode);
-    value = setBit(value, 5, enable);
-    writeRegister(IP2366_REG_SYS_CTL9, value, errorCode);
+    updateBit(IP2366_REG_SYS_CTL9, 5, enable, errorCode);
 }
 
 bool IP2366::isBATLowEnabled(uint8_t * errorCode)
@@ -390,33 +540,13 @@ bool IP2366::isBATLowEnabled(uint8_t * errorCode)
 void IP2366::setLowBatteryVoltage(uint16_t voltage_mV, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t voltageSetting;
-    uint16_t stepVoltage = 100;
-
-    uint16_t baseVoltage = 2500;
-
-    if (voltage_mV < baseVoltage)
-    {
-        voltage_mV = baseVoltage;
-    }
-    else if (voltage_mV > (baseVoltage + stepVoltage * 7))
-    {
-        voltage_mV = (baseVoltage + stepVoltage * 7);
-    }
-
-    voltageSetting = (voltage_mV - baseVoltage) / stepVoltage;
-
-    uint8_t currentValue = readRegister(IP2366_REG_SYS_CTL10, errorCode) & 0x1F;
-    writeRegister(IP2366_REG_SYS_CTL10, (voltageSetting << 5 | currentValue), errorCode);
+    updateRegister(IP2366_REG_SYS_CTL10, 0xE0, encodeLowBatteryVoltage(voltage_mV) << 5, errorCode);
 }
 
 uint16_t IP2366::getLowBatteryVoltage(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t voltageSetting = (readRegister(IP2366_REG_SYS_CTL10, errorCode) >> 5) & 0x03;
-
-    uint16_t baseVoltage = 2500;
-    return baseVoltage + voltageSetting * 100;
+    return decodeLowBatteryVoltage(readRegister(IP2366_REG_SYS_CTL10, errorCode) >> 5);
 }
 
 // SYS_CTL11
@@ -424,9 +554,8 @@ uint16_t IP2366::getLowBatteryVoltage(uint8_t * errorCode)
 void IP2366::setOutputFeatures(bool enableDcDcOutput, bool enableVbusSrcDPdM, bool enableVbusSrcPd, bool enableVbusSrcSCP, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t currentValue = readRegister(IP2366_REG_SYS_CTL11, errorCode) & 0x0F;
-    currentValue |= (enableDcDcOutput << 7) | (enableVbusSrcDPdM << 6) | (enableVbusSrcPd << 5) | (enableVbusSrcSCP << 4);
-    writeRegister(IP2366_REG_SYS_CTL11, currentValue, errorCode);
+    uint8_t value = (enableDcDcOutput << 7) | (enableVbusSrcDPdM << 6) | (enableVbusSrcPd << 5) | (enableVbusSrcSCP << 4);
+    updateRegister(IP2366_REG_SYS_CTL11, 0xF0, value, errorCode);
 }
 
 bool IP2366::isDcDcOutputEnabled(uint8_t * errorCode)
@@ -458,15 +587,13 @@ bool IP2366::isVbusSrcSCPEnabled(uint8_t * errorCode)
 void IP2366::setMaxOutputPower(Vbus1OutputPower power, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_SYS_CTL12, errorCode) & 0x1F; 
-    value |= static_cast<uint8_t>(power) << 5;                 
-    writeRegister(IP2366_REG_SYS_CTL12, value, errorCode);
+    updateRegister(IP2366_REG_SYS_CTL12, 0xE0, static_cast<uint8_t>(power) << 5, errorCode);
 }
 
 IP2366::Vbus1OutputPower IP2366::getMaxOutputPower(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    return static_cast<Vbus1OutputPower>((readRegister(IP2366_REG_SYS_CTL12, errorCode) >> 5) & 0x03); 
+    return static_cast<Vbus1OutputPower>((readRegister(IP2366_REG_SYS_CTL12, errorCode) >> 5) & 0x07);
 }
 
 // SELECT_PDO
@@ -474,14 +601,13 @@ IP2366::Vbus1OutputPower IP2366::getMaxOutputPower(uint8_t * errorCode)
 void IP2366::setChargingPDOmode(ChargingPDOmode mode, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t currentValue = readRegister(IP2366_REG_SYS_CTL10, errorCode) & 0xF8;
-    writeRegister(IP2366_REG_SELECT_PDO, ((static_cast<uint8_t>(mode) | currentValue), errorCode);
+    updateRegister(IP2366_REG_SELECT_PDO, 0x07, static_cast<uint8_t>(mode), errorCode);
 }
 
 IP2366::ChargingPDOmode IP2366::getChargingPDOmode(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    return static_cast<ChargingPDOmode>(readRegister(IP2366_REG_SELECT_PDO, errorCode) & 0x03);
+    return static_cast<ChargingPDOmode>(readRegister(IP2366_REG_SELECT_PDO, errorCode) & 0x07);
 }
 
 // TypeC_CTL8
@@ -489,11 +615,7 @@ IP2366::ChargingPDOmode IP2366::getChargingPDOmode(uint8_t * errorCode)
 void IP2366::setTypeCMode(TypeCMode mode, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_TypeC_CTL8, errorCode) & ~0xC0; 
-
-    value |= (static_cast<uint8_t>(mode) << 6); 
-
-    writeRegister(IP2366_REG_TypeC_CTL8, value, errorCode);
+    updateRegister(IP2366_REG_TypeC_CTL8, 0xC0, static_cast<uint8_t>(mode) << 6, errorCode);
 }
 
 IP2366::TypeCMode IP2366::getTypeCMode(uint8_t * errorCode)
@@ -572,10 +694,7 @@ bool IP2366::is5VPdoIsetEnabled(uint8_t * errorCode)
 void IP2366::writeTypeCCurrentSetting(uint8_t reg, uint16_t current_mA, uint16_t step, uint16_t maxCurrent, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    if (current_mA > maxCurrent)
-        current_mA = maxCurrent;
-    uint8_t value = current_mA / step;
-    writeRegister(reg, value, errorCode);
+    writeRegister(reg, encodeScaled(current_mA, 0, step, maxCurrent), errorCode);
 }
 
 // TypeC_CTL10 - TypeC_CTL14
@@ -589,7 +708,7 @@ void IP2366::setPDOCurrent5V(uint16_t current_mA, uint8_t * errorCode)
 uint16_t IP2366::getPDOCurrent5V(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    return readRegister(IP2366_REG_TypeC_CTL10, errorCode) * 20;
+    return decodePDOCurrent(readRegister(IP2366_REG_TypeC_CTL10, errorCode));
 }
 
 void IP2366::setPDOCurrent9V(uint16_t current_mA, uint8_t * errorCode)
@@ -601,7 +720,7 @@ void IP2366::setPDOCurrent9V(uint16_t current_mA, uint8_t * errorCode)
 uint16_t IP2366::getPDOCurrent9V(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    return readRegister(IP2366_REG_TypeC_CTL11, errorCode) * 20;
+    return decodePDOCurrent(readRegister(IP2366_REG_TypeC_CTL11, errorCode));
 }
 
 void IP2366::setPDOCurrent12V(uint16_t current_mA, uint8_t * errorCode)
@@ -613,7 +732,7 @@ void IP2366::setPDOCurrent12V(uint16_t current_mA, uint8_t * errorCode)
 uint16_t IP2366::getPDOCurrent12V(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    return readRegister(IP2366_REG_TypeC_CTL12, errorCode) * 20;
+    return decodePDOCurrent(readRegister(IP2366_REG_TypeC_CTL12, errorCode));
 }
 
 void IP2366::setPDOCurrent15V(uint16_t current_mA, uint8_t * errorCode)
@@ -625,7 +744,7 @@ void IP2366::setPDOCurrent15V(uint16_t current_mA, uint8_t * errorCode)
 uint16_t IP2366::getPDOCurrent15V(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    return readRegister(IP2366_REG_TypeC_CTL13, errorCode) * 20;
+    return decodePDOCurrent(readRegister(IP2366_REG_TypeC_CTL13, errorCode));
 }
 
 void IP2366::setPDOCurrent20V(uint16_t current_mA, uint8_t * errorCode)
@@ -637,7 +756,7 @@ void IP2366::setPDOCurrent20V(uint16_t current_mA, uint8_t * errorCode)
 uint16_t IP2366::getPDOCurrent20V(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    return readRegister(IP2366_REG_TypeC_CTL14, errorCode) * 20;
+    return decodePDOCurrent(readRegister(IP2366_REG_TypeC_CTL14, errorCode));
 }
 
 // TypeC_CTL23 - TypeC_CTL24
@@ -651,7 +770,7 @@ void IP2366::setPDOCurrentPPS1(uint16_t current_mA, uint8_t * errorCode)
 uint16_t IP2366::getPDOCurrentPPS1(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    return readRegister(IP2366_REG_TypeC_CTL23, errorCode) * 50;
+    return decodePPSCurrent(readRegister(IP2366_REG_TypeC_CTL23, errorCode));
 }
 
 void IP2366::setPDOCurrentPPS2(uint16_t current_mA, uint8_t * errorCode)
@@ -663,7 +782,26 @@ void IP2366::setPDOCurrentPPS2(uint16_t current_mA, uint8_t * errorCode)
 uint16_t IP2366::getPDOCurrentPPS2(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    return readRegister(IP2366_REG_TypeC_CTL24, errorCode) * 50;
+    return decodePPSCurrent(readRegister(IP2366_REG_TypeC_CTL24, errorCode));
+}
+
+// TypeC_CTL9 - TypeC_CTL17 block
+
+bool IP2366::readSourcePdoBlock(uint8_t block[IP2366_SRC_PDO_BLOCK_SIZE], uint8_t * errorCode)
+{
+    if (errorCode != nullptr) *errorCode = 0; // reset error code
+    return readRegisters(IP2366_REG_TypeC_CTL9, block, IP2366_SRC_PDO_BLOCK_SIZE, errorCode) == 0;
+}
+
+bool IP2366::writeSourcePdoBlock(const uint8_t target[IP2366_SRC_PDO_BLOCK_SIZE], uint8_t current[IP2366_SRC_PDO_BLOCK_SIZE],
+                                 uint8_t * writes, uint8_t * errorCode)
+{
+    if (errorCode != nullptr) *errorCode = 0; // reset error code
+    uint8_t count = 0;
+    BusGuard guard(*this);
+    bool ok = writeChanged(IP2366_REG_TypeC_CTL9, target, current, IP2366_SRC_PDO_BLOCK_SIZE, count, errorCode);
+    if (writes != nullptr) *writes = count;
+    return ok;
 }
 
 // TypeC_CTL17
@@ -671,14 +809,14 @@ uint16_t IP2366::getPDOCurrentPPS2(uint8_t * errorCode)
 void IP2366::enableSrcPdo(bool en9VPdo, bool en12VPdo, bool en15VPdo, bool en20VPdo, bool enPps1Pdo, bool enPps2Pdo, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_TypeC_CTL17, errorCode);
+    uint8_t value = 0;
     value = setBit(value, 6, enPps2Pdo);
     value = setBit(value, 5, enPps1Pdo);
     value = setBit(value, 4, en20VPdo);
     value = setBit(value, 3, en15VPdo);
     value = setBit(value, 2, en12VPdo);
     value = setBit(value, 1, en9VPdo);
-    writeRegister(IP2366_REG_TypeC_CTL17, value, errorCode);
+    updateRegister(IP2366_REG_TypeC_CTL17, 0x7E, value, errorCode);
 }
 
 bool IP2366::isSrcPdo9VEnabled(uint8_t * errorCode)
@@ -722,13 +860,13 @@ bool IP2366::isSrcPps2PdoEnabled(uint8_t * errorCode)
 void IP2366::enableSrcPdoAdd10mA(bool en5VPdoAdd10mA, bool en9VPdoAdd10mA, bool en12VPdoAdd10mA, bool en15VPdoAdd10mA, bool en20VPdoAdd10mA, uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_TypeC_CTL18, errorCode);
+    uint8_t value = 0;
     value = setBit(value, 4, en20VPdoAdd10mA);
     value = setBit(value, 3, en15VPdoAdd10mA);
     value = setBit(value, 2, en12VPdoAdd10mA);
     value = setBit(value, 1, en9VPdoAdd10mA);
     value = setBit(value, 0, en5VPdoAdd10mA);
-    writeRegister(IP2366_REG_TypeC_CTL18, value, errorCode);
+    updateRegister(IP2366_REG_TypeC_CTL18, 0x1F, value, errorCode);
 }
 
 bool IP2366::isSrcPdoAdd10mA5VEnabled(uint8_t * errorCode)
@@ -815,37 +953,28 @@ bool IP2366::isVbusOvervoltage(uint8_t * errorCode)
 uint8_t IP2366::getChargeVoltage(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    uint8_t value = readRegister(IP2366_REG_STATE_CTL2, errorCode) & 0x07;
-    switch (value)
+    return decodeChargeVoltage(readRegister(IP2366_REG_STATE_CTL2, errorCode));
+}
+
+uint8_t IP2366::decodeChargeVoltage(uint8_t stateCtl2)
+{
+    switch (stateCtl2 & 0x07)
     {
     case 0x07:
-        value = 20;
-        break;
-
+        return 20;
     case 0x06:
-        value = 15;
-        break;
-
+        return 15;
     case 0x05:
-        value = 12;
-        break;
-
+        return 12;
     case 0x04:
-        value = 9;
-        break;
-
+        return 9;
     case 0x03:
-        value = 7;
-        break;
-
+        return 7;
     case 0x02:
-        value = 5;
-        break;
+        return 5;
     default:
-        value = 0;
-        break;
+        return 0;
     }
-    return value;
 }
 
 // TypeC_STATE
@@ -932,14 +1061,41 @@ bool IP2366::isVsysSdortCircuitDt(uint8_t * errorCode)
     return readRegister(IP2366_REG_STATE_CTL3, errorCode) & (1 << 4);
 }
 
+void IP2366::clearVsysFaults(uint8_t * errorCode)
+{
+    if (errorCode != nullptr) *errorCode = 0; // reset error code
+    writeRegister(IP2366_REG_STATE_CTL3, (1 << 5) | (1 << 4), errorCode);
+}
+
+uint8_t IP2366::readFaults(uint8_t * errorCode)
+{
+    if (errorCode != nullptr) *errorCode = 0; // reset error code
+    uint8_t data[IP2366_REG_STATE_CTL3 - IP2366_REG_STATE_CTL2 + 1]; // 0x33 - 0x38
+    if (readRegisters(IP2366_REG_STATE_CTL2, data, sizeof(data), errorCode))
+        return 0;
+
+    uint8_t stateCtl2 = data[0];
+    uint8_t stateCtl3 = data[IP2366_REG_STATE_CTL3 - IP2366_REG_STATE_CTL2];
+    uint8_t faults = 0;
+    if (stateCtl3 & (1 << 5))
+        faults |= FAULT_VSYS_OVERCURRENT;
+    if (stateCtl3 & (1 << 4))
+        faults |= FAULT_VSYS_SHORT_CIRCUIT;
+    if (stateCtl2 & (1 << 6))
+        faults |= FAULT_VBUS_OVERVOLTAGE;
+    return faults;
+}
+
 // TIMENODE
 
 void IP2366::getTimenode(char timenode[5], uint8_t * errorCode) {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    for (uint8_t i = 0; i < 5; i++)
+    if (identity.valid)
     {
-        timenode[i] = readRegister((IP2366_REG_TIMENODE1+i), errorCode);
+        memcpy(timenode, identity.timenode, 5);
+        return;
     }
+    readRegisters(IP2366_REG_TIMENODE1, (uint8_t *)timenode, 5, errorCode);
 }
 
 // ADC
@@ -985,5 +1141,103 @@ bool IP2366::isOverHeat(uint8_t * errorCode)
 uint16_t IP2366::getNTCVoltage(uint8_t * errorCode)
 {
     if (errorCode != nullptr) *errorCode = 0; // reset error code
-    return ADC_TO_MV(((uint16_t)readRegister(IP2366_REG_VGPIO0_NTC_DAT1, errorCode) << 8) | (uint16_t)readRegister(IP2366_REG_VGPIO0_NTC_DAT0, errorCode));
+    uint8_t data[2]; // 0x78 - 0x79
+    if (readRegisters(IP2366_REG_VGPIO0_NTC_DAT0, data, sizeof(data), errorCode))
+        return 0;
+    return ((uint16_t)data[1] << 8) | data[0]; // VGPIO0 reads in mV
+}
+
+// The NTC pin is driven by a 20 uA or 80 uA current source (INTC_IADC_DAT0 bit 7), VGPIO0 reads in mV
+uint32_t IP2366::getNTCResistance(uint8_t * errorCode)
+{
+    if (errorCode != nullptr) *errorCode = 0; // reset error code
+    uint8_t data[3]; // 0x77 - 0x79
+    if (readRegisters(IP2366_REG_INTC_IADC_DAT0, data, sizeof(data), errorCode))
+        return 0;
+    return ntcResistance(((uint16_t)data[2] << 8) | data[1], data[0] & (1 << 7));
+}
+
+uint32_t IP2366::ntcResistance(uint16_t ntc_mV, bool current80uA)
+{
+    return (uint32_t)ntc_mV * 1000 / (current80uA ? 80 : 20);
+}
+
+// Snapshots
+
+bool IP2366::readAdcSnapshot(AdcSnapshot & snapshot, uint8_t * errorCode)
+{
+    if (errorCode != nullptr) *errorCode = 0; // reset error code
+    uint8_t vadc[4];  // 0x50 - 0x53
+    uint8_t iadc[4];  // 0x6E - 0x71
+    uint8_t other[6]; // 0x74 - 0x79
+
+    if (readRegisters(IP2366_REG_BATVADC_DAT0, vadc, sizeof(vadc), errorCode) ||
+        readRegisters(IP2366_REG_IBATIADC_DAT0, iadc, sizeof(iadc), errorCode) ||
+        readRegisters(IP2366_REG_Vsys_POW_DAT0, other, sizeof(other), errorCode))
+        return false;
+
+    decodeAdcSnapshot(snapshot, vadc, iadc, other);
+    return true;
 }
+
+bool IP2366::readStatusSnapshot(StatusSnapshot & snapshot, uint8_t * errorCode)
+{
+    if (errorCode != nullptr) *errorCode = 0; // reset error code
+    uint8_t data[IP2366_REG_STATE_CTL3 - IP2366_REG_STATE_CTL0 + 1]; // 0x31 - 0x38
+
+    if (readRegisters(IP2366_REG_STATE_CTL0, data, sizeof(data), errorCode))
+        return false;
+
+    decodeStatusSnapshot(snapshot, data);
+    return true;
+}
+
+void IP2366::decodeAdcSnapshot(AdcSnapshot & snapshot, const uint8_t vadc[4], const uint8_t iadc[4], const uint8_t other[6])
+{
+    snapshot.timestamp = millis();
+    snapshot.VBATVoltage = ((uint16_t)vadc[1] << 8) | vadc[0];
+    snapshot.VsysVoltage = ((uint16_t)vadc[3] << 8) | vadc[2];
+    snapshot.BATCurrent = ((uint16_t)iadc[1] << 8) | iadc[0];
+    snapshot.VsysCurrent = ((uint16_t)iadc[3] << 8) | iadc[2];
+    snapshot.VsysPower = ((uint32_t)other[1] << 8) | other[0];
+    snapshot.ntcCurrent80uA = other[IP2366_REG_INTC_IADC_DAT0 - IP2366_REG_Vsys_POW_DAT0] & (1 << 7);
+    snapshot.NTCVoltage = ((uint16_t)other[5] << 8) | other[4]; // already mV, like getNTCVoltage()
+    snapshot.NTCResistance = ntcResistance(snapshot.NTCVoltage, snapshot.ntcCurrent80uA);
+}
+
+void IP2366::decodeStatusSnapshot(StatusSnapshot & snapshot, const uint8_t data[8])
+{
+    snapshot.timestamp = millis();
+    snapshot.stateCtl0 = data[IP2366_REG_STATE_CTL0 - IP2366_REG_STATE_CTL0];
+    snapshot.stateCtl1 = data[IP2366_REG_STATE_CTL1 - IP2366_REG_STATE_CTL0];
+    snapshot.stateCtl2 = data[IP2366_REG_STATE_CTL2 - IP2366_REG_STATE_CTL0];
+    snapshot.typeCState = data[IP2366_REG_TypeC_STATE - IP2366_REG_STATE_CTL0];
+    snapshot.receivedPdo = data[IP2366_REG_RECEIVED_PDO - IP2366_REG_STATE_CTL0];
+    snapshot.stateCtl3 = data[IP2366_REG_STATE_CTL3 - IP2366_REG_STATE_CTL0];
+}
+
+IP2366::SystemStatus IP2366::getSystemStatus(uint8_t * errorCode)
+{
+    StatusSnapshot snapshot;
+    if (!readStatusSnapshot(snapshot, errorCode))
+        return SystemStatus();
+    return snapshot.getSystemStatus();
+}
+
+constexpr uint32_t IP2366::SystemStatus::CHARGE_STATE;
+constexpr uint32_t IP2366::SystemStatus::DISCHARGING;
+constexpr uint32_t IP2366::SystemStatus::CHARGE_FULL;
+constexpr uint32_t IP2366::SystemStatus::CHARGING;
+constexpr uint32_t IP2366::SystemStatus::FAST_CHARGE;
+constexpr uint32_t IP2366::SystemStatus::CHARGE_VOLTAGE;
+constexpr uint32_t IP2366::SystemStatus::VBUS_OVERVOLTAGE;
+constexpr uint32_t IP2366::SystemStatus::VBUS_PRESENT;
+constexpr uint32_t IP2366::SystemStatus::VBUS_SRC_QC;
+constexpr uint32_t IP2366::SystemStatus::VBUS_SINK_QC;
+constexpr uint32_t IP2366::SystemStatus::TYPEC_SINK_PD;
+constexpr uint32_t IP2366::SystemStatus::TYPEC_SRC_PD;
+constexpr uint32_t IP2366::SystemStatus::TYPEC_SRC;
+constexpr uint32_t IP2366::SystemStatus::TYPEC_SINK;
+constexpr uint32_t IP2366::SystemStatus::RECEIVED_PDO;
+constexpr uint32_t IP2366::SystemStatus::VSYS_SHORT_CIRCUIT;
+constexpr uint32_t IP2366::SystemStatus::VSYS_OVERCURRENT;
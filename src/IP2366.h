@@ -1,309 +1,745 @@
-#ifndef IP2366_H
-#define IP2366_H
-
-// #include <Arduino.h>
-#include <Wire.h>
-
-#include <stdint.h>
-
-class IP2366
-{
-public:
-    IP2366(uint8_t address = 0x75) : IP2366_address(address) {};
-    void begin();
-
-    uint8_t IP2366_address;
-
-    // Enumeration for defining the charge state
-    enum class ChargeState
-    {
-        STANDBY = 0,
-        TRICKLE_CHARGE = 1,
-        CONSTANT_CURRENT = 2,
-        CONSTANT_VOLTAGE = 3,
-        CHARGE_WAIT = 4,
-        CHARGE_FULL = 5,
-        CHARGE_TIMEOUT = 6
-    };
-
-    // Enumeration for defining the USB Type-C operating mode
-    enum class TypeCMode
-    {
-        UFP = 0, // Upstream Facing Port (device connected as a consumer)
-        DFP = 1, // Downstream Facing Port (device connected as a power source)
-        DRP = 3  // Dual Role Port (device can act as both a source and a consumer)
-    };
-
-    // Enumeration for selecting Vbus1 output power
-    enum class Vbus1OutputPower
-    {
-        W30 = 0,
-        W45 = 1,
-        W60 = 2,
-        W65 = 3,
-        W100 = 4,
-        W140 = 5
-    };
-
-    // Enumeration for selecting charging PDO mode
-    enum class ChargingPDOmode
-    {
-        V5 = 0,
-        V9 = 1,
-        V12 = 2,
-        V15 = 3,
-        V20 = 4
-    };
-
-    ///////// IS? ////////
-
-    // SYS_CTL0
-
-    bool isChargerEnabled(uint8_t * errorCode = nullptr);
-    bool isVbusSinkSCPEnabled(uint8_t * errorCode = nullptr);
-    bool isVbusSinkPDEnabled(uint8_t * errorCode = nullptr);
-    bool isVbusSinkDPdMEnabled(uint8_t * errorCode = nullptr);
-    bool isINTLowEnabled(uint8_t * errorCode = nullptr);
-    bool isLoadOTPEnabled(uint8_t * errorCode = nullptr);
-
-    // SYS_CTL9
-    bool isStandbyModeEnabled(uint8_t * errorCode = nullptr);
-    bool isStandby(uint8_t * errorCode = nullptr);
-    bool isBATLowEnabled(uint8_t * errorCode = nullptr);
-
-    // SYS_CTL11
-
-    bool isDcDcOutputEnabled(uint8_t * errorCode = nullptr);
-    bool isVbusSrcDPdMEnabled(uint8_t * errorCode = nullptr);
-    bool isVbusSrcPdEnabled(uint8_t * errorCode = nullptr);
-    bool isVbusSrcSCPEnabled(uint8_t * errorCode = nullptr);
-
-    // TypeC_CTL9
-
-    bool is5VPdo3AEnabled(uint8_t * errorCode = nullptr);
-    bool isPps2PdoIsetEnabled(uint8_t * errorCode = nullptr);
-    bool isPps1PdoIsetEnabled(uint8_t * errorCode = nullptr);
-    bool is20VPdoIsetEnabled(uint8_t * errorCode = nullptr);
-    bool is15VPdoIsetEnabled(uint8_t * errorCode = nullptr);
-    bool is12VPdoIsetEnabled(uint8_t * errorCode = nullptr);
-    bool is9VPdoIsetEnabled(uint8_t * errorCode = nullptr);
-    bool is5VPdoIsetEnabled(uint8_t * errorCode = nullptr);
-
-    // TypeC_CTL17
-
-    bool isSrcPdo9VEnabled(uint8_t * errorCode = nullptr);
-    bool isSrcPdo12VEnabled(uint8_t * errorCode = nullptr);
-    bool isSrcPdo15VEnabled(uint8_t * errorCode = nullptr);
-    bool isSrcPdo20VEnabled(uint8_t * errorCode = nullptr);
-    bool isSrcPps1PdoEnabled(uint8_t * errorCode = nullptr);
-    bool isSrcPps2PdoEnabled(uint8_t * errorCode = nullptr);
-
-    // TypeC_CTL18
-
-    bool isSrcPdoAdd10mA5VEnabled(uint8_t * errorCode = nullptr);
-    bool isSrcPdoAdd10mA9VEnabled(uint8_t * errorCode = nullptr);
-    bool isSrcPdoAdd10mA12VEnabled(uint8_t * errorCode = nullptr);
-    bool isSrcPdoAdd10mA15VEnabled(uint8_t * errorCode = nullptr);
-    bool isSrcPdoAdd10mA20VEnabled(uint8_t * errorCode = nullptr);
-
-    // STATE_CTL0
-
-    bool isCharging(uint8_t * errorCode = nullptr);
-    bool isChargeFull(uint8_t * errorCode = nullptr);
-    bool isDischarging(uint8_t * errorCode = nullptr);
-
-    // STATE_CTL1
-
-    bool isFastCharge(uint8_t * errorCode = nullptr);
-
-    // STATE_CTL2
-
-    bool isVbusPresent(uint8_t * errorCode = nullptr);
-    bool isVbusOvervoltage(uint8_t * errorCode = nullptr);
-
-    // TypeC_STATE
-
-    bool isTypeCSinkConnected(uint8_t * errorCode = nullptr);
-    bool isTypeCSrcConnected(uint8_t * errorCode = nullptr);
-    bool isTypeCSrcPdConnected(uint8_t * errorCode = nullptr);
-    bool isTypeCSinkPdConnected(uint8_t * errorCode = nullptr);
-    bool isVbusSinkQcActive(uint8_t * errorCode = nullptr);
-    bool isVbusSrcQcActive(uint8_t * errorCode = nullptr);
-
-    // RECEIVED_PDO
-
-    bool isReceives5VPdo(uint8_t * errorCode);
-    bool isReceives9VPdo(uint8_t * errorCode);
-    bool isReceives12VPdo(uint8_t * errorCode);
-    bool isReceives15VPdo(uint8_t * errorCode);
-    bool isReceives20VPdo(uint8_t * errorCode);
-
-    // STATE_CTL3
-
-    bool isVsysOverCurrent(uint8_t * errorCode = nullptr);
-    bool isVsysSdortCircuitDt(uint8_t * errorCode = nullptr);
-
-    // ADC
-    bool isOverHeat(uint8_t * errorCode = nullptr);
-
-    ///////// SET ////////
-
-    // SYS_CTL0
-
-    void enableCharger(bool enable = true, uint8_t * errorCode = nullptr);
-    void enableVbusSinkSCP(bool enable = true, uint8_t * errorCode = nullptr);
-    void enableVbusSinkPD(bool enable = true, uint8_t * errorCode = nullptr);
-    void enableVbusSinkDPdM(bool enable = true, uint8_t * errorCode = nullptr);
-    void enableINTLow(bool enable = true, uint8_t * errorCode = nullptr);
-    void ResetMCU(bool enable = true, uint8_t * errorCode = nullptr);
-    void enableLoadOTP(bool enable = true, uint8_t * errorCode = nullptr);
-
-    // SYS_CTL2
-
-    void setFullChargeVoltage(uint16_t voltage = 4400, uint8_t * errorCode = nullptr);
-
-    // SYS_CTL3
-
-    void setMaxInputPowerOrBatteryCurrent(uint16_t current_mA = 9700, uint8_t * errorCode = nullptr);
-
-    // SYS_CTL6
-
-    void setTrickleChargeCurrent(uint16_t current = 200, uint8_t * errorCode = nullptr);
-
-    // SYS_CTL8
-
-    void setChargeStopCurrent(uint16_t current = 100, uint8_t * errorCode = nullptr);
-    void setCellRechargeThreshold(uint16_t voltageDrop_mV = 200, uint8_t * errorCode = nullptr);
-
-    // SYS_CTL9
-
-    void enableStandbyMode(bool enable = true, uint8_t * errorCode = nullptr);
-    void Standby(bool enable = true, uint8_t * errorCode = nullptr);
-    void enableBATLow(bool enable = true, uint8_t * errorCode = nullptr);
-
-    // SYS_CTL10
-
-    void setLowBatteryVoltage(uint16_t voltage_mV = 2700, uint8_t * errorCode = nullptr);
-
-    // SYS_CTL11
-
-    void setOutputFeatures(bool enableDcDcOutput = true, bool enableVbusSrcDPdM = true, bool enableVbusSrcPd = true, bool enableVbusSrcSCP = true, uint8_t * errorCode = nullptr);
-
-    // SYS_CTL12
-
-    void setMaxOutputPower(Vbus1OutputPower power = Vbus1OutputPower::W140, uint8_t * errorCode = nullptr);
-
-    // SELECT_PDO
-
-    void setChargingPDOmode(ChargingPDOmode mode = ChargingPDOmode::V20, uint8_t * errorCode);
-
-    // TypeC_CTL8
-    void setTypeCMode(TypeCMode mode = TypeCMode::DRP, uint8_t * errorCode = nullptr);
-
-    // TypeC_CTL9
-
-    void enablePdoCurrentOutputSet(bool en5VPdoIset = true, bool en5VPdo3A = true, bool en9VPdoIset = true,
-                                   bool en12VPdoIset = true, bool en15VPdoIset = true, bool en20VPdoIset = true,
-                                   bool enPps1PdoIset = true, bool enPps2PdoIset = true, uint8_t * errorCode = nullptr);
-
-    // TypeC_CTL10 - TypeC_CTL14
-
-    void setPDOCurrent5V(uint16_t current_mA = 3000, uint8_t * errorCode = nullptr);
-    void setPDOCurrent9V(uint16_t current_mA = 3000, uint8_t * errorCode = nullptr);
-    void setPDOCurrent12V(uint16_t current_mA = 3000, uint8_t * errorCode = nullptr);
-    void setPDOCurrent15V(uint16_t current_mA = 3000, uint8_t * errorCode = nullptr);
-    void setPDOCurrent20V(uint16_t current_mA = 5000, uint8_t * errorCode = nullptr);
-
-    // TypeC_CTL23 - TypeC_CTL24
-
-    void setPDOCurrentPPS1(uint16_t current_mA = 3000, uint8_t * errorCode = nullptr);
-    void setPDOCurrentPPS2(uint16_t current_mA = 3000, uint8_t * errorCode = nullptr);
-
-    // TypeC_CTL17
-
-    void enableSrcPdo(bool en9VPdo = true, bool en12VPdo = true, bool en15VPdo = true, bool en20VPdo = true,
-                      bool enPps1Pdo = true, bool enPps2Pdo = true, uint8_t * errorCode = nullptr);
-
-    // TypeC_CTL18
-
-    void enableSrcPdoAdd10mA(bool en5VPdoAdd10mA = true, bool en9VPdoAdd10mA = true, bool en12VPdoAdd10mA = true,
-                             bool en15VPdoAdd10mA = true, bool en20VPdoAdd10mA = true, uint8_t * errorCode);
-
-    ///////// GET ////////
-
-    // SYS_CTL2
-
-    uint16_t getFullChargeVoltage(uint8_t * errorCode = nullptr);
-
-    // SYS_CTL3
-
-    uint16_t getMaxInputPowerOrBatteryCurrent(uint8_t * errorCode = nullptr);
-
-    // SYS_CTL6
-
-    uint16_t getTrickleChargeCurrent(uint8_t * errorCode = nullptr);
-
-    // SYS_CTL8
-
-    uint16_t getChargeStopCurrent(uint8_t * errorCode = nullptr);
-    uint16_t getCellRechargeThreshold(uint8_t * errorCode = nullptr);
-
-    // SYS_CTL10
-
-    uint16_t getLowBatteryVoltage(uint8_t * errorCode = nullptr);
-
-    // SYS_CTL12
-
-    Vbus1OutputPower getMaxOutputPower(uint8_t * errorCode = nullptr);
-
-    // SELECT_PDO
-
-    ChargingPDOmode getChargingPDOmode(uint8_t * errorCode);
-
-    // TypeC_CTL8
-
-    TypeCMode getTypeCMode(uint8_t * errorCode = nullptr);
-
-    // TypeC_CTL10 - TypeC_CTL14
-
-    uint16_t getPDOCurrent5V(uint8_t * errorCode = nullptr);
-    uint16_t getPDOCurrent9V(uint8_t * errorCode = nullptr);
-    uint16_t getPDOCurrent12V(uint8_t * errorCode = nullptr);
-    uint16_t getPDOCurrent15V(uint8_t * errorCode = nullptr);
-    uint16_t getPDOCurrent20V(uint8_t * errorCode = nullptr);
-
-    // TypeC_CTL23 - TypeC_CTL24
-
-    uint16_t getPDOCurrentPPS1(uint8_t * errorCode = nullptr);
-    uint16_t getPDOCurrentPPS2(uint8_t * errorCode = nullptr);
-
-    // STATE_CTL0
-
-    ChargeState getChargeState(uint8_t * errorCode = nullptr);
-
-    uint8_t getChargeVoltage(uint8_t * errorCode = nullptr);
-
-    // TIMENODE
-
-    void getTimenode(char timenode[5], uint8_t * errorCode);
-
-    // ADC
-
-    uint16_t getVBATVoltage(uint8_t * errorCode = nullptr);
-    uint16_t getVsysVoltage(uint8_t * errorCode = nullptr);
-    uint16_t getBATCurrent(uint8_t * errorCode = nullptr);
-    uint16_t getVsysCurrent(uint8_t * errorCode = nullptr);
-    uint32_t getVsysPower(uint8_t * errorCode = nullptr);
-
-    // GPIO
-
-    uint16_t getNTCVoltage(uint8_t * errorCode = nullptr);
-
-private:
-    uint8_t writeRegister(uint8_t regAddress, uint8_t value, uint8_t * errorCode = nullptr);
-    uint8_t readRegister(uint8_t regAddress, uint8_t * errorCode = nullptr);
-    inline uint8_t setBit(uint8_t value, uint8_t bit, bool enable = true);
-    void writeTypeCCurrentSetting(uint8_t reg, uint16_t current_mA, uint16_t step, uint16_t maxCurrent, uint8_t * errorCode = nullptr);
-};
-
-#endif
+#ifndef IP2366_H
+#define IP2366_H
+
+#include "IP2366Platform.h"
+#ifdef IP2366_ARDUINO
+#include <Wire.h>
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+#include "IP2366Bus.h"
+#include "IP2366Lock.h"
+#include "IP2366Registers.h"
+
+#ifdef IP2366_ARDUINO
+// Wire transactions of IP2366WireBus and IP2366StaticWireBus; pause() runs between transaction phases
+struct IP2366WireTransfer
+{
+    template <class Pause>
+    static uint8_t write(TwoWire & wire, uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length, Pause pause)
+    {
+        wire.beginTransmission(address);
+        pause();
+        wire.write(regAddress);
+        pause();
+        for (uint8_t i = 0; i < length; i++)
+        {
+            wire.write(data[i]);
+            pause();
+        }
+        uint8_t errorCode = wire.endTransmission(); // Send a stop signal
+        pause();
+        return errorCode;
+    };
+
+    template <class Pause>
+    static uint8_t read(TwoWire & wire, uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length, Pause pause)
+    {
+        wire.beginTransmission(address);
+        pause();
+        wire.write(regAddress);
+        pause();
+        uint8_t errorCode = wire.endTransmission(false); // Do not send a stop signal
+        pause();
+        if (errorCode)
+        {
+            memset(data, 0xFF, length);
+            return errorCode;
+        }
+        if (wire.requestFrom(address, length, (bool)true) != length) // Request bytes and send a stop signal
+        {
+            memset(data, 0, length);
+            return 4; // other error
+        }
+        for (uint8_t i = 0; i < length; i++)
+            data[i] = wire.read(); // read from I2C internal buffer
+        return 0;
+    };
+};
+
+// Default transport: Arduino Wire (or any other TwoWire instance)
+class IP2366WireBus : public IP2366Bus
+{
+public:
+    IP2366WireBus(TwoWire & wire = Wire) : wire(wire) {};
+
+    void begin() override;
+    uint8_t writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length) override;
+    uint8_t readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length) override;
+
+    // Delay between transaction phases, 1 ms by default as recommended by the datasheet; 0 removes it
+    void setByteDelay(uint8_t delay_ms) { byteDelay = delay_ms; };
+
+private:
+    void pause();
+
+    TwoWire & wire;
+    uint8_t byteDelay = 1;
+};
+#endif
+
+#define IP2366_WAKE_TIME_MS 100
+#define IP2366_PROBE_TIMEOUT_MS 200 // begin() gives up when the chip does not ACK within this time
+
+class IP2366
+{
+public:
+#ifdef IP2366_ARDUINO
+    IP2366(uint8_t address = 0x75) : IP2366_address(address), bus(&wireBus) {};
+#endif
+    IP2366(IP2366Bus & bus, uint8_t address = 0x75) : IP2366_address(address), bus(&bus) {};
+    bool begin(uint16_t timeout_ms = IP2366_PROBE_TIMEOUT_MS); // false if the chip did not answer, see getIdentity()
+
+    uint8_t IP2366_address;
+
+    // INT pin control. The chip wakes up when INT is driven HIGH and accepts I2C about 100 ms later;
+    // with INT LOW it may go to sleep and the bus must not be accessed 16 ms after that.
+
+    void setIntPin(int8_t pin);
+    void wake();       // drive INT HIGH
+    void allowSleep(); // drive INT LOW
+    bool isWakeComplete() const; // INT is HIGH for at least IP2366_WAKE_TIME_MS
+
+    // Identity, read once by begin(): the chip is woken through INT (if set) and polled with 1 byte reads
+    // until it ACKs, then TIMENODE (0x69-0x6D) and the config block (0x00-0x0D) are each read in one burst.
+    // getTimenode() is served from this cache afterwards.
+
+    enum Quirks : uint8_t
+    {
+        QUIRK_SINGLE_BYTE_READS = 1 << 0 // split burst reads into single byte reads
+    };
+
+    struct QuirkRule
+    {
+        const char * timenode; // TIMENODE prefix, e.g. "H2" matches every TIMENODE starting with it
+        uint8_t quirks;
+    };
+
+    struct Identity
+    {
+        bool valid;
+        char timenode[6];     // TIMENODE1-5, null terminated
+        uint8_t config[IP2366_CONFIG_BLOCK_SIZE]; // SYS_CTL0 - SELECT_PDO at begin()
+        uint8_t quirks;       // Quirks selected from the rules
+        uint32_t startup_us;  // begin() to the first valid sample (status block read after identity and config)
+    };
+
+    void setQuirkRules(const QuirkRule * rules, uint8_t count) { quirkRules = rules; quirkRuleCount = count; }; // before begin()
+    void setQuirks(uint8_t quirks) { identity.quirks = quirks; };
+    const Identity & getIdentity() const { return identity; };
+    bool probe(uint16_t timeout_ms = IP2366_PROBE_TIMEOUT_MS); // 1 byte reads until the chip ACKs
+
+    // Provisioning: reset the registers to their defaults (SYS_CTL0 En_RESETMCU), poll until the chip ACKs
+    // and the reset bit has cleared, write the changed config registers in as few bursts as possible and
+    // read them back. Returns false on a bus error, a timeout (errorCode 5) or a verify mismatch.
+
+    struct Profile
+    {
+        uint8_t values[IP2366_CONFIG_BLOCK_SIZE]; // SYS_CTL0 - SELECT_PDO
+        uint8_t masks[IP2366_CONFIG_BLOCK_SIZE];  // bits to provision, 0 leaves the register at its default
+
+        // e.g. profile.set(IP2366_REG_SYS_CTL3, IP2366::encodeMaxInputPowerOrBatteryCurrent(5000))
+        Profile & set(uint8_t regAddress, uint8_t value, uint8_t mask = 0xFF)
+        {
+            if (regAddress == IP2366_REG_SYS_CTL0)
+                mask &= ~0x40; // En_RESETMCU clears itself
+            if (regAddress < IP2366_CONFIG_BLOCK_SIZE)
+            {
+                values[regAddress] = (values[regAddress] & ~mask) | (value & mask);
+                masks[regAddress] |= mask;
+            }
+            return *this;
+        };
+    };
+
+    struct ProvisionReport
+    {
+        uint32_t ready_us;  // reset issued to chip ready
+        uint32_t total_us;  // whole sequence including verify
+        uint8_t probes;     // readiness reads
+        uint8_t writes;     // write transactions for the profile
+        uint8_t mismatches; // registers that did not read back as written
+    };
+
+    bool resetAndProvision(const Profile & profile, ProvisionReport * report = nullptr,
+                           uint16_t timeout_ms = IP2366_PROBE_TIMEOUT_MS, uint8_t * errorCode = nullptr);
+
+    // Bus locking, see IP2366Lock.h. Without a lock the driver does no locking at all.
+
+    struct LockStats
+    {
+        uint32_t count;    // number of outermost lock acquisitions
+        uint32_t total_us; // total lock hold time
+        uint32_t max_us;   // longest single hold
+    };
+
+    void setLock(IP2366Lock * lock) { busLock = lock; };
+    void lockBus();   // hold the bus across several calls (batch), nests with the driver's own locking
+    void unlockBus();
+    LockStats getLockStats() const { return lockStats; };
+    void resetLockStats();
+
+    // Holds the bus for the lifetime of the guard
+    class BusGuard
+    {
+    public:
+        BusGuard(IP2366 & chip) : chip(chip) { chip.lockBus(); };
+        ~BusGuard() { chip.unlockBus(); };
+
+    private:
+        BusGuard(const BusGuard &);
+        BusGuard & operator=(const BusGuard &);
+        IP2366 & chip;
+    };
+
+    // Enumeration for defining the charge state
+    enum class ChargeState
+    {
+        STANDBY = 0,
+        TRICKLE_CHARGE = 1,
+        CONSTANT_CURRENT = 2,
+        CONSTANT_VOLTAGE = 3,
+        CHARGE_WAIT = 4,
+        CHARGE_FULL = 5,
+        CHARGE_TIMEOUT = 6
+    };
+
+    // Enumeration for defining the USB Type-C operating mode
+    enum class TypeCMode
+    {
+        UFP = 0, // Upstream Facing Port (device connected as a consumer)
+        DFP = 1, // Downstream Facing Port (device connected as a power source)
+        DRP = 3  // Dual Role Port (device can act as both a source and a consumer)
+    };
+
+    // Enumeration for selecting Vbus1 output power
+    enum class Vbus1OutputPower
+    {
+        W30 = 0,
+        W45 = 1,
+        W60 = 2,
+        W65 = 3,
+        W100 = 4,
+        W140 = 5
+    };
+
+    // Enumeration for selecting charging PDO mode
+    enum class ChargingPDOmode
+    {
+        V5 = 0,
+        V9 = 1,
+        V12 = 2,
+        V15 = 3,
+        V20 = 4
+    };
+
+    // ADC channels captured with three burst reads (0x50-0x53, 0x6E-0x71, 0x74-0x79)
+    struct AdcSnapshot
+    {
+        uint32_t timestamp;   // millis() at capture
+        uint16_t VBATVoltage; // mV
+        uint16_t VsysVoltage; // mV
+        uint16_t BATCurrent;  // mA
+        uint16_t VsysCurrent; // mA
+        uint32_t VsysPower;
+        uint16_t NTCVoltage;  // mV
+        uint32_t NTCResistance; // Ohm
+        bool ntcCurrent80uA;    // INTC_IADC_DAT0[7]: NTC current source 80 uA (20 uA otherwise), not a fault
+    };
+
+    // All status bits of STATE_CTL0-2, TypeC_STATE, RECEIVED_PDO and STATE_CTL3 packed into one word
+    // (reserved bits dropped), so comparing or logging the whole status is a single integer operation.
+    class SystemStatus
+    {
+    public:
+        static constexpr uint32_t CHARGE_STATE = 0x07UL << 0;       // STATE_CTL0[2:0], see ChargeState
+        static constexpr uint32_t DISCHARGING = 1UL << 3;           // STATE_CTL0[3] Output_En
+        static constexpr uint32_t CHARGE_FULL = 1UL << 4;           // STATE_CTL0[4] CHG_End
+        static constexpr uint32_t CHARGING = 1UL << 5;              // STATE_CTL0[5] CHG_En
+        static constexpr uint32_t FAST_CHARGE = 1UL << 6;           // STATE_CTL1[6]
+        static constexpr uint32_t CHARGE_VOLTAGE = 0x07UL << 8;     // STATE_CTL2[2:0], see decodeChargeVoltage()
+        static constexpr uint32_t VBUS_OVERVOLTAGE = 1UL << 11;     // STATE_CTL2[6]
+        static constexpr uint32_t VBUS_PRESENT = 1UL << 12;         // STATE_CTL2[7]
+        static constexpr uint32_t VBUS_SRC_QC = 1UL << 13;          // TypeC_STATE[2]
+        static constexpr uint32_t VBUS_SINK_QC = 1UL << 14;         // TypeC_STATE[3]
+        static constexpr uint32_t TYPEC_SINK_PD = 1UL << 15;        // TypeC_STATE[4]
+        static constexpr uint32_t TYPEC_SRC_PD = 1UL << 16;         // TypeC_STATE[5]
+        static constexpr uint32_t TYPEC_SRC = 1UL << 17;            // TypeC_STATE[6]
+        static constexpr uint32_t TYPEC_SINK = 1UL << 18;           // TypeC_STATE[7]
+        static constexpr uint32_t RECEIVED_PDO = 0x1FUL << 19;      // RECEIVED_PDO[4:0], 5V ... 20V
+        static constexpr uint32_t VSYS_SHORT_CIRCUIT = 1UL << 24;   // STATE_CTL3[4]
+        static constexpr uint32_t VSYS_OVERCURRENT = 1UL << 25;     // STATE_CTL3[5]
+
+        constexpr SystemStatus(uint32_t bits = 0) : bits(bits) {};
+
+        static constexpr SystemStatus fromRegisters(uint8_t stateCtl0, uint8_t stateCtl1, uint8_t stateCtl2,
+                                                    uint8_t typeCState, uint8_t receivedPdo, uint8_t stateCtl3)
+        {
+            return SystemStatus(((uint32_t)(stateCtl0 & 0x3F)) |
+                                ((uint32_t)(stateCtl1 & 0x40)) |
+                                ((uint32_t)(stateCtl2 & 0x07) << 8) |
+                                ((uint32_t)(stateCtl2 & 0xC0) << 5) |
+                                ((uint32_t)(typeCState & 0xFC) << 11) |
+                                ((uint32_t)(receivedPdo & 0x1F) << 19) |
+                                ((uint32_t)(stateCtl3 & 0x30) << 20));
+        };
+
+        constexpr uint32_t raw() const { return bits; };
+        constexpr bool has(uint32_t mask) const { return (bits & mask) != 0; };
+        constexpr uint32_t changed(SystemStatus other) const { return bits ^ other.bits; }; // mask of differing bits
+        constexpr ChargeState chargeState() const { return static_cast<ChargeState>(bits & CHARGE_STATE); };
+        constexpr uint8_t receivedPdo() const { return (bits & RECEIVED_PDO) >> 19; };
+        uint8_t chargeVoltage() const { return decodeChargeVoltage((bits & CHARGE_VOLTAGE) >> 8); }; // V
+
+        constexpr bool operator==(SystemStatus other) const { return bits == other.bits; };
+        constexpr bool operator!=(SystemStatus other) const { return bits != other.bits; };
+
+    private:
+        uint32_t bits;
+    };
+
+    // Status registers captured with one burst read (0x31-0x38)
+    struct StatusSnapshot
+    {
+        uint32_t timestamp; // millis() at capture
+        uint8_t stateCtl0;
+        uint8_t stateCtl1;
+        uint8_t stateCtl2;
+        uint8_t typeCState;
+        uint8_t receivedPdo;
+        uint8_t stateCtl3;
+
+        SystemStatus getSystemStatus() const
+        {
+            return SystemStatus::fromRegisters(stateCtl0, stateCtl1, stateCtl2, typeCState, receivedPdo, stateCtl3);
+        };
+    };
+
+    ///////// IS? ////////
+
+    // SYS_CTL0
+
+    bool isChargerEnabled(uint8_t * errorCode = nullptr);
+    bool isVbusSinkSCPEnabled(uint8_t * errorCode = nullptr);
+    bool isVbusSinkPDEnabled(uint8_t * errorCode = nullptr);
+    bool isVbusSinkDPdMEnabled(uint8_t * errorCode = nullptr);
+    bool isINTLowEnabled(uint8_t * errorCode = nullptr);
+    bool isLoadOTPEnabled(uint8_t * errorCode = nullptr);
+
+    // SYS_CTL9
+    bool isStandbyModeEnabled(uint8_t * errorCode = nullptr);
+    bool isStandby(uint8_t * errorCode = nullptr);
+    bool isBATLowEnabled(uint8_t * errorCode = nullptr);
+
+    // SYS_CTL11
+
+    bool isDcDcOutputEnabled(uint8_t * errorCode = nullptr);
+    bool isVbusSrcDPdMEnabled(uint8_t * errorCode = nullptr);
+    bool isVbusSrcPdEnabled(uint8_t * errorCode = nullptr);
+    bool isVbusSrcSCPEnabled(uint8_t * errorCode = nullptr);
+
+    // TypeC_CTL9
+
+    bool is5VPdo3AEnabled(uint8_t * errorCode = nullptr);
+    bool isPps2PdoIsetEnabled(uint8_t * errorCode = nullptr);
+    bool isPps1PdoIsetEnabled(uint8_t * errorCode = nullptr);
+    bool is20VPdoIsetEnabled(uint8_t * errorCode = nullptr);
+    bool is15VPdoIsetEnabled(uint8_t * errorCode = nullptr);
+    bool is12VPdoIsetEnabled(uint8_t * errorCode = nullptr);
+    bool is9VPdoIsetEnabled(uint8_t * errorCode = nullptr);
+    bool is5VPdoIsetEnabled(uint8_t * errorCode = nullptr);
+
+    // TypeC_CTL17
+
+    bool isSrcPdo9VEnabled(uint8_t * errorCode = nullptr);
+    bool isSrcPdo12VEnabled(uint8_t * errorCode = nullptr);
+    bool isSrcPdo15VEnabled(uint8_t * errorCode = nullptr);
+    bool isSrcPdo20VEnabled(uint8_t * errorCode = nullptr);
+    bool isSrcPps1PdoEnabled(uint8_t * errorCode = nullptr);
+    bool isSrcPps2PdoEnabled(uint8_t * errorCode = nullptr);
+
+    // TypeC_CTL18
+
+    bool isSrcPdoAdd10mA5VEnabled(uint8_t * errorCode = nullptr);
+    bool isSrcPdoAdd10mA9VEnabled(uint8_t * errorCode = nullptr);
+    bool isSrcPdoAdd10mA12VEnabled(uint8_t * errorCode = nullptr);
+    bool isSrcPdoAdd10mA15VEnabled(uint8_t * errorCode = nullptr);
+    bool isSrcPdoAdd10mA20VEnabled(uint8_t * errorCode = nullptr);
+
+    // STATE_CTL0
+
+    bool isCharging(uint8_t * errorCode = nullptr);
+    bool isChargeFull(uint8_t * errorCode = nullptr);
+    bool isDischarging(uint8_t * errorCode = nullptr);
+
+    // STATE_CTL1
+
+    bool isFastCharge(uint8_t * errorCode = nullptr);
+
+    // STATE_CTL2
+
+    bool isVbusPresent(uint8_t * errorCode = nullptr);
+    bool isVbusOvervoltage(uint8_t * errorCode = nullptr);
+
+    // TypeC_STATE
+
+    bool isTypeCSinkConnected(uint8_t * errorCode = nullptr);
+    bool isTypeCSrcConnected(uint8_t * errorCode = nullptr);
+    bool isTypeCSrcPdConnected(uint8_t * errorCode = nullptr);
+    bool isTypeCSinkPdConnected(uint8_t * errorCode = nullptr);
+    bool isVbusSinkQcActive(uint8_t * errorCode = nullptr);
+    bool isVbusSrcQcActive(uint8_t * errorCode = nullptr);
+
+    // RECEIVED_PDO
+
+    bool isReceives5VPdo(uint8_t * errorCode);
+    bool isReceives9VPdo(uint8_t * errorCode);
+    bool isReceives12VPdo(uint8_t * errorCode);
+    bool isReceives15VPdo(uint8_t * errorCode);
+    bool isReceives20VPdo(uint8_t * errorCode);
+
+    // STATE_CTL3
+
+    bool isVsysOverCurrent(uint8_t * errorCode = nullptr);
+    bool isVsysSdortCircuitDt(uint8_t * errorCode = nullptr);
+    void clearVsysFaults(uint8_t * errorCode = nullptr); // write 1 to clear the over-current and short circuit flags
+
+    // Fault flags of STATE_CTL2 and STATE_CTL3, see IP2366FaultMonitor
+    enum Faults : uint8_t
+    {
+        FAULT_VSYS_OVERCURRENT = 1 << 0,
+        FAULT_VSYS_SHORT_CIRCUIT = 1 << 1,
+        FAULT_VBUS_OVERVOLTAGE = 1 << 2,
+        FAULT_OVERHEAT = 1 << 3 // NTC temperature limit, set by IP2366FaultMonitor only (the chip has no such flag)
+    };
+
+    // One burst read of 0x33-0x38; 0 if the read failed, check errorCode
+    uint8_t readFaults(uint8_t * errorCode = nullptr);
+
+    // ADC
+    bool isOverHeat(uint8_t * errorCode = nullptr); // INTC_IADC_DAT0[7]: NTC current source is 80 uA, not a temperature fault
+
+    ///////// SET ////////
+
+    // SYS_CTL0
+
+    void enableCharger(bool enable = true, uint8_t * errorCode = nullptr);
+    void enableVbusSinkSCP(bool enable = true, uint8_t * errorCode = nullptr);
+    void enableVbusSinkPD(bool enable = true, uint8_t * errorCode = nullptr);
+    void enableVbusSinkDPdM(bool enable = true, uint8_t * errorCode = nullptr);
+    void enableINTLow(bool enable = true, uint8_t * errorCode = nullptr);
+    void ResetMCU(bool enable = true, uint8_t * errorCode = nullptr);
+    void enableLoadOTP(bool enable = true, uint8_t * errorCode = nullptr);
+
+    // SYS_CTL2
+
+    void setFullChargeVoltage(uint16_t voltage = 4400, uint8_t * errorCode = nullptr);
+
+    // SYS_CTL3
+
+    void setMaxInputPowerOrBatteryCurrent(uint16_t current_mA = 9700, uint8_t * errorCode = nullptr);
+
+    // SYS_CTL6
+
+    void setTrickleChargeCurrent(uint16_t current = 200, uint8_t * errorCode = nullptr);
+
+    // SYS_CTL8
+
+    void setChargeStopCurrent(uint16_t current = 100, uint8_t * errorCode = nullptr);
+    void setCellRechargeThreshold(uint16_t voltageDrop_mV = 200, uint8_t * errorCode = nullptr);
+
+    // SYS_CTL9
+
+    void enableStandbyMode(bool enable = true, uint8_t * errorCode = nullptr);
+    void Standby(bool enable = true, uint8_t * errorCode = nullptr);
+    void enableBATLow(bool enable = true, uint8_t * errorCode = nullptr);
+
+    // SYS_CTL10
+
+    void setLowBatteryVoltage(uint16_t voltage_mV = 2700, uint8_t * errorCode = nullptr);
+
+    // SYS_CTL11
+
+    void setOutputFeatures(bool enableDcDcOutput = true, bool enableVbusSrcDPdM = true, bool enableVbusSrcPd = true, bool enableVbusSrcSCP = true, uint8_t * errorCode = nullptr);
+
+    // SYS_CTL12
+
+    void setMaxOutputPower(Vbus1OutputPower power = Vbus1OutputPower::W140, uint8_t * errorCode = nullptr);
+
+    // SELECT_PDO
+
+    void setChargingPDOmode(ChargingPDOmode mode = ChargingPDOmode::V20, uint8_t * errorCode = nullptr);
+
+    // TypeC_CTL8
+    void setTypeCMode(TypeCMode mode = TypeCMode::DRP, uint8_t * errorCode = nullptr);
+
+    // TypeC_CTL9
+
+    void enablePdoCurrentOutputSet(bool en5VPdoIset = true, bool en5VPdo3A = true, bool en9VPdoIset = true,
+                                   bool en12VPdoIset = true, bool en15VPdoIset = true, bool en20VPdoIset = true,
+                                   bool enPps1PdoIset = true, bool enPps2PdoIset = true, uint8_t * errorCode = nullptr);
+
+    // TypeC_CTL10 - TypeC_CTL14
+
+    void setPDOCurrent5V(uint16_t current_mA = 3000, uint8_t * errorCode = nullptr);
+    void setPDOCurrent9V(uint16_t current_mA = 3000, uint8_t * errorCode = nullptr);
+    void setPDOCurrent12V(uint16_t current_mA = 3000, uint8_t * errorCode = nullptr);
+    void setPDOCurrent15V(uint16_t current_mA = 3000, uint8_t * errorCode = nullptr);
+    void setPDOCurrent20V(uint16_t current_mA = 5000, uint8_t * errorCode = nullptr);
+
+    // TypeC_CTL23 - TypeC_CTL24
+
+    void setPDOCurrentPPS1(uint16_t current_mA = 3000, uint8_t * errorCode = nullptr);
+    void setPDOCurrentPPS2(uint16_t current_mA = 3000, uint8_t * errorCode = nullptr);
+
+    // TypeC_CTL9 - TypeC_CTL17 (0x23-0x2B) as one block, see IP2366SourcePdoManager.
+    // writeSourcePdoBlock() writes only the registers where target differs from current, consecutive ones
+    // in one burst, and updates current as it goes. It returns false if a write failed, with current holding
+    // what the chip accepted; writes (optional) receives the number of write transactions either way.
+
+    bool readSourcePdoBlock(uint8_t block[IP2366_SRC_PDO_BLOCK_SIZE], uint8_t * errorCode = nullptr);
+    bool writeSourcePdoBlock(const uint8_t target[IP2366_SRC_PDO_BLOCK_SIZE], uint8_t current[IP2366_SRC_PDO_BLOCK_SIZE],
+                             uint8_t * writes = nullptr, uint8_t * errorCode = nullptr);
+
+    // TypeC_CTL17
+
+    void enableSrcPdo(bool en9VPdo = true, bool en12VPdo = true, bool en15VPdo = true, bool en20VPdo = true,
+                      bool enPps1Pdo = true, bool enPps2Pdo = true, uint8_t * errorCode = nullptr);
+
+    // TypeC_CTL18
+
+    void enableSrcPdoAdd10mA(bool en5VPdoAdd10mA = true, bool en9VPdoAdd10mA = true, bool en12VPdoAdd10mA = true,
+                             bool en15VPdoAdd10mA = true, bool en20VPdoAdd10mA = true, uint8_t * errorCode = nullptr);
+
+    ///////// SET, COMPILE TIME ////////
+
+    // Overloads for values known at build time, e.g. setFullChargeVoltage<4200>(): the register value is
+    // computed by the compiler and an out-of-range or off-step value fails to compile instead of being clamped.
+
+    template <uint16_t Voltage_mV>
+    void setFullChargeVoltage(uint8_t * errorCode = nullptr)
+    {
+        static_assert(isScaled(Voltage_mV, 2500, 10, 4400), "full charge voltage must be 2500-4400 mV in 10 mV steps");
+        if (errorCode != nullptr) *errorCode = 0; // reset error code
+        writeRegister(IP2366_REG_SYS_CTL2, encodeFullChargeVoltage(Voltage_mV), errorCode);
+    };
+
+    template <uint16_t Current_mA>
+    void setMaxInputPowerOrBatteryCurrent(uint8_t * errorCode = nullptr)
+    {
+        static_assert(isScaled(Current_mA, 0, 100, 9700), "charge current must be 0-9700 mA in 100 mA steps");
+        if (errorCode != nullptr) *errorCode = 0; // reset error code
+        writeRegister(IP2366_REG_SYS_CTL3, encodeMaxInputPowerOrBatteryCurrent(Current_mA), errorCode);
+    };
+
+    template <uint16_t Current_mA>
+    void setTrickleChargeCurrent(uint8_t * errorCode = nullptr)
+    {
+        static_assert(isScaled(Current_mA, 0, 50, 12750), "trickle current must be 0-12750 mA in 50 mA steps");
+        if (errorCode != nullptr) *errorCode = 0; // reset error code
+        writeRegister(IP2366_REG_SYS_CTL6, encodeTrickleChargeCurrent(Current_mA), errorCode);
+    };
+
+    template <uint16_t Current_mA>
+    void setChargeStopCurrent(uint8_t * errorCode = nullptr)
+    {
+        static_assert(isScaled(Current_mA, 0, 50, 750), "stop current must be 0-750 mA in 50 mA steps");
+        if (errorCode != nullptr) *errorCode = 0; // reset error code
+        updateRegister(IP2366_REG_SYS_CTL8, 0xF0, encodeChargeStopCurrent(Current_mA) << 4, errorCode);
+    };
+
+    template <uint16_t VoltageDrop_mV>
+    void setCellRechargeThreshold(uint8_t * errorCode = nullptr)
+    {
+        static_assert(VoltageDrop_mV == 0 || VoltageDrop_mV == 50 || VoltageDrop_mV == 100 || VoltageDrop_mV == 200,
+                      "recharge threshold must be 0 (off), 50, 100 or 200 mV");
+        if (errorCode != nullptr) *errorCode = 0; // reset error code
+        updateRegister(IP2366_REG_SYS_CTL8, 0x0C, encodeCellRechargeThreshold(VoltageDrop_mV) << 2, errorCode);
+    };
+
+    template <uint16_t Voltage_mV>
+    void setLowBatteryVoltage(uint8_t * errorCode = nullptr)
+    {
+        static_assert(isScaled(Voltage_mV, 2500, 100, 3200), "low battery voltage must be 2500-3200 mV in 100 mV steps");
+        if (errorCode != nullptr) *errorCode = 0; // reset error code
+        updateRegister(IP2366_REG_SYS_CTL10, 0xE0, encodeLowBatteryVoltage(Voltage_mV) << 5, errorCode);
+    };
+
+    template <uint16_t Current_mA> void setPDOCurrent5V(uint8_t * errorCode = nullptr) { setPDOCurrent<IP2366_REG_TypeC_CTL10, Current_mA, 3000>(errorCode); };
+    template <uint16_t Current_mA> void setPDOCurrent9V(uint8_t * errorCode = nullptr) { setPDOCurrent<IP2366_REG_TypeC_CTL11, Current_mA, 3000>(errorCode); };
+    template <uint16_t Current_mA> void setPDOCurrent12V(uint8_t * errorCode = nullptr) { setPDOCurrent<IP2366_REG_TypeC_CTL12, Current_mA, 3000>(errorCode); };
+    template <uint16_t Current_mA> void setPDOCurrent15V(uint8_t * errorCode = nullptr) { setPDOCurrent<IP2366_REG_TypeC_CTL13, Current_mA, 3000>(errorCode); };
+    template <uint16_t Current_mA> void setPDOCurrent20V(uint8_t * errorCode = nullptr) { setPDOCurrent<IP2366_REG_TypeC_CTL14, Current_mA, 5000>(errorCode); };
+
+    template <uint16_t Current_mA>
+    void setPDOCurrentPPS1(uint8_t * errorCode = nullptr)
+    {
+        static_assert(isScaled(Current_mA, 0, 50, 5000), "PPS current must be 0-5000 mA in 50 mA steps");
+        if (errorCode != nullptr) *errorCode = 0; // reset error code
+        writeRegister(IP2366_REG_TypeC_CTL23, encodePPSCurrent(Current_mA), errorCode);
+    };
+
+    template <uint16_t Current_mA>
+    void setPDOCurrentPPS2(uint8_t * errorCode = nullptr)
+    {
+        static_assert(isScaled(Current_mA, 0, 50, 5000), "PPS current must be 0-5000 mA in 50 mA steps");
+        if (errorCode != nullptr) *errorCode = 0; // reset error code
+        writeRegister(IP2366_REG_TypeC_CTL24, encodePPSCurrent(Current_mA), errorCode);
+    };
+
+    ///////// GET ////////
+
+    // SYS_CTL2
+
+    uint16_t getFullChargeVoltage(uint8_t * errorCode = nullptr);
+
+    // SYS_CTL3
+
+    uint16_t getMaxInputPowerOrBatteryCurrent(uint8_t * errorCode = nullptr);
+
+    // SYS_CTL6
+
+    uint16_t getTrickleChargeCurrent(uint8_t * errorCode = nullptr);
+
+    // SYS_CTL8
+
+    uint16_t getChargeStopCurrent(uint8_t * errorCode = nullptr);
+    uint16_t getCellRechargeThreshold(uint8_t * errorCode = nullptr);
+
+    // SYS_CTL10
+
+    uint16_t getLowBatteryVoltage(uint8_t * errorCode = nullptr);
+
+    // SYS_CTL12
+
+    Vbus1OutputPower getMaxOutputPower(uint8_t * errorCode = nullptr);
+
+    // SELECT_PDO
+
+    ChargingPDOmode getChargingPDOmode(uint8_t * errorCode = nullptr);
+
+    // TypeC_CTL8
+
+    TypeCMode getTypeCMode(uint8_t * errorCode = nullptr);
+
+    // TypeC_CTL10 - TypeC_CTL14
+
+    uint16_t getPDOCurrent5V(uint8_t * errorCode = nullptr);
+    uint16_t getPDOCurrent9V(uint8_t * errorCode = nullptr);
+    uint16_t getPDOCurrent12V(uint8_t * errorCode = nullptr);
+    uint16_t getPDOCurrent15V(uint8_t * errorCode = nullptr);
+    uint16_t getPDOCurrent20V(uint8_t * errorCode = nullptr);
+
+    // TypeC_CTL23 - TypeC_CTL24
+
+    uint16_t getPDOCurrentPPS1(uint8_t * errorCode = nullptr);
+    uint16_t getPDOCurrentPPS2(uint8_t * errorCode = nullptr);
+
+    // STATE_CTL0
+
+    ChargeState getChargeState(uint8_t * errorCode = nullptr);
+
+    uint8_t getChargeVoltage(uint8_t * errorCode = nullptr);
+    static uint8_t decodeChargeVoltage(uint8_t stateCtl2); // V, 0 if not charging
+
+    // TIMENODE
+
+    void getTimenode(char timenode[5], uint8_t * errorCode = nullptr); // cached by begin(), one burst read otherwise
+
+    // ADC
+
+    uint16_t getVBATVoltage(uint8_t * errorCode = nullptr);
+    uint16_t getVsysVoltage(uint8_t * errorCode = nullptr);
+    uint16_t getBATCurrent(uint8_t * errorCode = nullptr);
+    uint16_t getVsysCurrent(uint8_t * errorCode = nullptr);
+    uint32_t getVsysPower(uint8_t * errorCode = nullptr);
+
+    // GPIO
+
+    uint16_t getNTCVoltage(uint8_t * errorCode = nullptr); // mV, as read from VGPIO0_NTC
+    uint32_t getNTCResistance(uint8_t * errorCode = nullptr); // Ohm, see IP2366Ntc.h for temperature
+    static uint32_t ntcResistance(uint16_t ntc_mV, bool current80uA);
+
+    ///////// ENCODING ////////
+
+    // Register field <-> value conversions of the scaled settings. Encoders clamp to the valid range
+    // (recharge threshold: nearest of 0 (off), 50, 100, 200 mV); all are usable in constant expressions.
+
+    static constexpr uint8_t encodeFullChargeVoltage(uint16_t voltage_mV) { return encodeScaled(voltage_mV, 2500, 10, 4400); };
+    static constexpr uint16_t decodeFullChargeVoltage(uint8_t value) { return 2500 + value * 10; };
+    static constexpr uint8_t encodeMaxInputPowerOrBatteryCurrent(uint16_t current_mA) { return encodeScaled(current_mA, 0, 100, 9700); };
+    static constexpr uint16_t decodeMaxInputPowerOrBatteryCurrent(uint8_t value) { return value * 100; };
+    static constexpr uint8_t encodeTrickleChargeCurrent(uint16_t current_mA) { return encodeScaled(current_mA, 0, 50, 12750); };
+    static constexpr uint16_t decodeTrickleChargeCurrent(uint8_t value) { return value * 50; };
+    static constexpr uint8_t encodeChargeStopCurrent(uint16_t current_mA) { return encodeScaled(current_mA, 0, 50, 750); };     // SYS_CTL8[7:4]
+    static constexpr uint16_t decodeChargeStopCurrent(uint8_t value) { return (value & 0x0F) * 50; };
+    static constexpr uint8_t encodeCellRechargeThreshold(uint16_t voltageDrop_mV)                                              // SYS_CTL8[3:2]
+    {
+        return voltageDrop_mV == 0 ? 0 : voltageDrop_mV < 75 ? 1 : voltageDrop_mV < 150 ? 2 : 3;
+    };
+    static constexpr uint16_t decodeCellRechargeThreshold(uint8_t value) { return (value & 0x03) == 3 ? 200 : (value & 0x03) * 50; };
+    static constexpr uint8_t encodeLowBatteryVoltage(uint16_t voltage_mV) { return encodeScaled(voltage_mV, 2500, 100, 3200); }; // SYS_CTL10[7:5]
+    static constexpr uint16_t decodeLowBatteryVoltage(uint8_t value) { return 2500 + (value & 0x07) * 100; };
+    static constexpr uint8_t encodePDOCurrent(uint16_t current_mA, uint16_t maxCurrent_mA) { return encodeScaled(current_mA, 0, 20, maxCurrent_mA); };
+    static constexpr uint16_t decodePDOCurrent(uint8_t value) { return value * 20; };
+    static constexpr uint8_t encodePPSCurrent(uint16_t current_mA) { return encodeScaled(current_mA, 0, 50, 5000); };
+    static constexpr uint16_t decodePPSCurrent(uint8_t value) { return value * 50; };
+
+    ///////// SNAPSHOTS ////////
+
+    bool readAdcSnapshot(AdcSnapshot & snapshot, uint8_t * errorCode = nullptr);
+    bool readStatusSnapshot(StatusSnapshot & snapshot, uint8_t * errorCode = nullptr);
+    SystemStatus getSystemStatus(uint8_t * errorCode = nullptr); // one burst read of 0x31-0x38
+
+    // Decode the burst buffers of readAdcSnapshot (0x50-0x53, 0x6E-0x71, 0x74-0x79) and readStatusSnapshot (0x31-0x38)
+    static void decodeAdcSnapshot(AdcSnapshot & snapshot, const uint8_t vadc[4], const uint8_t iadc[4], const uint8_t other[6]);
+    static void decodeStatusSnapshot(StatusSnapshot & snapshot, const uint8_t data[8]);
+
+private:
+#ifdef IP2366_ARDUINO
+    IP2366WireBus wireBus;
+#endif
+    IP2366Bus * bus;
+    IP2366Lock * busLock = nullptr;
+    int8_t intPin = -1;
+    bool intHigh = false;
+    uint32_t wakeStart = 0;
+    uint8_t lockDepth = 0;
+    uint32_t lockStart = 0;
+    LockStats lockStats = {0, 0, 0};
+    const QuirkRule * quirkRules = nullptr;
+    uint8_t quirkRuleCount = 0;
+    Identity identity = {};
+
+    void selectQuirks();
+    uint8_t writeRegister(uint8_t regAddress, uint8_t value, uint8_t * errorCode = nullptr);
+    uint8_t writeRegisters(uint8_t regAddress, const uint8_t * data, uint8_t length, uint8_t * errorCode = nullptr);
+    bool writeChanged(uint8_t regAddress, const uint8_t * target, uint8_t * current, uint8_t length, uint8_t & writes, uint8_t * errorCode);
+    uint8_t readRegister(uint8_t regAddress, uint8_t * errorCode = nullptr);
+    uint8_t readRegisters(uint8_t regAddress, uint8_t * data, uint8_t length, uint8_t * errorCode = nullptr);
+    uint8_t updateRegister(uint8_t regAddress, uint8_t mask, uint8_t value, uint8_t * errorCode = nullptr);
+    uint8_t updateBit(uint8_t regAddress, uint8_t bit, bool enable, uint8_t * errorCode = nullptr);
+    inline uint8_t setBit(uint8_t value, uint8_t bit, bool enable = true);
+
+    static constexpr uint8_t encodeScaled(uint16_t value, uint16_t base, uint16_t step, uint16_t max)
+    {
+        return ((value < base ? base : value > max ? max : value) - base) / step;
+    };
+    static constexpr bool isScaled(uint16_t value, uint16_t base, uint16_t step, uint16_t max)
+    {
+        return value >= base && value <= max && (value - base) % step == 0;
+    };
+
+    template <uint8_t Reg, uint16_t Current_mA, uint16_t MaxCurrent_mA>
+    void setPDOCurrent(uint8_t * errorCode)
+    {
+        static_assert(isScaled(Current_mA, 0, 20, MaxCurrent_mA), "PDO current out of range or not in 20 mA steps");
+        if (errorCode != nullptr) *errorCode = 0; // reset error code
+        writeRegister(Reg, encodePDOCurrent(Current_mA, MaxCurrent_mA), errorCode);
+    };
+    void writeTypeCCurrentSetting(uint8_t reg, uint16_t current_mA, uint16_t step, uint16_t maxCurrent, uint8_t * errorCode = nullptr);
+};
+
+#endif
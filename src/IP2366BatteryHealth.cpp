@@ -0,0 +1,107 @@
+#include "IP2366BatteryHealth.h"
+#include "IP2366Log.h"
+#include <stddef.h>
+#include <string.h>
+
+void IP2366BatteryHealth::reset()
+{
+    hasPrevious = false;
+    previousTime = 0;
+    previousCurrent = 0;
+    previousVoltage = 0;
+    sumXX = 0;
+    sumXY = 0;
+    resistance = 0;
+    baseline = 0;
+    steps = 0;
+    rejected = 0;
+}
+
+void IP2366BatteryHealth::onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * health)
+{
+    static_cast<IP2366BatteryHealth *>(health)->update(adc, status);
+}
+
+bool IP2366BatteryHealth::update(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status)
+{
+    // Battery terminal voltage is OCV + R * I with I positive into the battery
+    int32_t current = adc.BATCurrent;
+    if (status.getSystemStatus().has(IP2366::SystemStatus::DISCHARGING))
+        current = -current;
+
+    bool consecutive = hasPrevious && (uint32_t)(adc.timestamp - previousTime) <= config.maxGap_ms;
+    int32_t dI = current - previousCurrent;                                    // mA
+    int32_t dV = ((int32_t)adc.VBATVoltage - (int32_t)previousVoltage) * 1000; // uV
+
+    hasPrevious = true;
+    previousTime = adc.timestamp;
+    previousCurrent = current;
+    previousVoltage = adc.VBATVoltage;
+
+    if (!consecutive || dI == 0 || (dI < 0 ? -dI : dI) < config.stepThreshold_mA)
+        return false;
+
+    // Plausibility of this single step; the sign also rejects OCV drift against the step
+    int64_t r = (int64_t)dV * 1000 / dI; // uOhm
+    if (r < (int64_t)config.minResistance_uOhm || r > (int64_t)config.maxResistance_uOhm)
+    {
+        rejected++;
+        return false;
+    }
+
+    // SECTION: recursive least squares, S = lambda * S + x * y with lambda = 1 - 2^-forgetShift
+    sumXX = sumXX - (sumXX >> config.forgetShift) + (int64_t)dI * dI;
+    sumXY = sumXY - (sumXY >> config.forgetShift) + (int64_t)dI * dV;
+    resistance = sumXX > 0 ? (uint32_t)(sumXY * 1000 / sumXX) : 0;
+
+    steps++;
+    if (baseline == 0 && steps >= config.baselineSteps)
+        baseline = resistance;
+    return true;
+}
+
+uint8_t IP2366BatteryHealth::getHealth() const
+{
+    if (baseline == 0 || resistance <= baseline)
+        return 100;
+    if (resistance >= 2 * baseline)
+        return 0;
+    return 100 - (uint64_t)(resistance - baseline) * 100 / baseline;
+}
+
+// Persistence
+
+uint16_t IP2366BatteryHealth::checksum(const Summary & summary)
+{
+    return IP2366Log::crc16(&summary, offsetof(Summary, crc));
+}
+
+IP2366BatteryHealth::Summary IP2366BatteryHealth::getSummary() const
+{
+    Summary summary;
+    memset(&summary, 0, sizeof(summary));
+    summary.magic = IP2366_HEALTH_MAGIC;
+    summary.resistance_uOhm = resistance;
+    summary.baseline_uOhm = baseline;
+    summary.steps = steps;
+    summary.crc = checksum(summary);
+    return summary;
+}
+
+bool IP2366BatteryHealth::restore(const Summary & summary)
+{
+    if (summary.magic != IP2366_HEALTH_MAGIC || summary.crc != checksum(summary))
+        return false;
+
+    reset();
+    resistance = summary.resistance_uOhm;
+    baseline = summary.baseline_uOhm;
+    steps = summary.steps;
+    // Reseed the sums as one 1 A step at the stored resistance, so new steps refine rather than replace it
+    if (resistance)
+    {
+        sumXX = 1000000;
+        sumXY = (int64_t)resistance * 1000;
+    }
+    return true;
+}
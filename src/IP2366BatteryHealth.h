@@ -0,0 +1,75 @@
+#ifndef IP2366_BATTERY_HEALTH_H
+#define IP2366_BATTERY_HEALTH_H
+
+#include "IP2366.h"
+
+#define IP2366_HEALTH_MAGIC 0x48363649 // "I66H"
+
+// Online battery internal resistance and health estimate, O(1) time and memory per sample.
+// Every current step between two consecutive samples (CC entry, load change, PD renegotiation) gives one
+// observation dV = R * dI, signed by the charge/discharge direction. R is fitted by recursive least squares
+// with exponential forgetting, kept in integer form as the weighted sums S(dI^2) and S(dI * dV), so a step
+// costs a few multiplications and one 64 bit division. The first baselineSteps steps set the baseline; health
+// falls linearly from 100% at the baseline to 0% at twice the baseline resistance.
+class IP2366BatteryHealth
+{
+public:
+    struct Config
+    {
+        uint16_t stepThreshold_mA = 300;         // smallest current step used
+        uint16_t maxGap_ms = 2000;               // samples further apart are not compared
+        uint32_t minResistance_uOhm = 1000;      // steps implying a resistance outside this range are rejected
+        uint32_t maxResistance_uOhm = 2000000;
+        uint8_t forgetShift = 4;                 // forgetting factor 1 - 2^-forgetShift per step
+        uint8_t baselineSteps = 8;
+    };
+
+    // Summary to persist across reboots (EEPROM, IP2366Log, ...), see restore()
+    struct Summary
+    {
+        uint32_t magic;
+        uint32_t resistance_uOhm;
+        uint32_t baseline_uOhm;
+        uint32_t steps;
+        uint16_t reserved;
+        uint16_t crc;
+    };
+
+    IP2366BatteryHealth() { reset(); };
+
+    void setConfig(const Config & config) { this->config = config; };
+    const Config & getConfig() const { return config; };
+
+    bool update(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status); // true when a step was used
+    void reset(); // forget everything, baseline included
+
+    // IP2366Sampler callback: sampler.subscribe(IP2366BatteryHealth::onSample, &health)
+    static void onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * health);
+
+    uint32_t getResistance() const { return resistance; };  // uOhm, 0 before the first step
+    uint32_t getBaseline() const { return baseline; };      // uOhm, 0 until baselineSteps steps were seen
+    void setBaseline(uint32_t resistance_uOhm) { baseline = resistance_uOhm; }; // e.g. from the cell datasheet
+    uint8_t getHealth() const;                               // %, 100 while there is no baseline
+    uint32_t getSteps() const { return steps; };
+    uint32_t getRejected() const { return rejected; };
+
+    Summary getSummary() const;
+    bool restore(const Summary & summary); // false if the summary is not valid
+
+private:
+    static uint16_t checksum(const Summary & summary);
+
+    Config config;
+    bool hasPrevious;
+    uint32_t previousTime;
+    int32_t previousCurrent; // mA, positive while charging
+    uint16_t previousVoltage; // mV
+    int64_t sumXX; // mA^2
+    int64_t sumXY; // mA * uV
+    uint32_t resistance;
+    uint32_t baseline;
+    uint32_t steps;
+    uint32_t rejected;
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef IP2366_BUS_H
+#define IP2366_BUS_H
+
+#include <stdint.h>
+
+// Register transport used by the IP2366 driver.
+// Every call is one I2C transaction addressed to a 7-bit device address.
+// Return values follow Wire.endTransmission() error codes:
+// 0 - success, 1 - data too long, 2 - NACK on address, 3 - NACK on data, 4 - other error, 5 - timeout
+class IP2366Bus
+{
+public:
+    virtual void begin() {}
+    virtual uint8_t writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length) = 0;
+    virtual uint8_t readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length) = 0;
+
+protected:
+    ~IP2366Bus() {}
+};
+
+#endif
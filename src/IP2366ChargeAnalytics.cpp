@@ -0,0 +1,117 @@
+#include "IP2366ChargeAnalytics.h"
+#include <string.h>
+
+uint32_t IP2366ChargeAnalytics::Cycle::getDuration() const
+{
+    return phases[TRICKLE].duration_ms + phases[CONSTANT_CURRENT].duration_ms + phases[CONSTANT_VOLTAGE].duration_ms;
+}
+
+uint32_t IP2366ChargeAnalytics::Cycle::getBatteryEnergy() const
+{
+    return phases[TRICKLE].batteryEnergy_mJ + phases[CONSTANT_CURRENT].batteryEnergy_mJ + phases[CONSTANT_VOLTAGE].batteryEnergy_mJ;
+}
+
+uint32_t IP2366ChargeAnalytics::Cycle::getInputEnergy() const
+{
+    return phases[TRICKLE].inputEnergy_mJ + phases[CONSTANT_CURRENT].inputEnergy_mJ + phases[CONSTANT_VOLTAGE].inputEnergy_mJ;
+}
+
+uint16_t IP2366ChargeAnalytics::Cycle::getEfficiency() const
+{
+    uint32_t input = getInputEnergy();
+    return input ? (uint64_t)getBatteryEnergy() * 1000 / input : 0;
+}
+
+IP2366ChargeAnalytics::IP2366ChargeAnalytics()
+    : active(false), havePrevious(false), previousTime(0), previousPhase(PHASES), head(0), count(0),
+      callback(nullptr), context(nullptr)
+{
+    memset(&previous, 0, sizeof(previous));
+    memset(&current, 0, sizeof(current));
+    memset(remainders, 0, sizeof(remainders));
+    memset(history, 0, sizeof(history));
+}
+
+void IP2366ChargeAnalytics::onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * analytics)
+{
+    static_cast<IP2366ChargeAnalytics *>(analytics)->addSample(adc, status);
+}
+
+void IP2366ChargeAnalytics::integrate(uint32_t & total, uint16_t & remainder, uint32_t value, uint32_t dt_ms)
+{
+    uint32_t product = value * dt_ms + remainder;
+    total += product / 1000;
+    remainder = product % 1000;
+}
+
+void IP2366ChargeAnalytics::addSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status)
+{
+    IP2366::ChargeState state = static_cast<IP2366::ChargeState>(status.stateCtl0 & 0x07);
+    uint8_t phase = PHASES;
+    if (state == IP2366::ChargeState::TRICKLE_CHARGE)
+        phase = TRICKLE;
+    else if (state == IP2366::ChargeState::CONSTANT_CURRENT)
+        phase = CONSTANT_CURRENT;
+    else if (state == IP2366::ChargeState::CONSTANT_VOLTAGE)
+        phase = CONSTANT_VOLTAGE;
+
+    // The interval since the previous sample belongs to the phase seen at the previous sample
+    uint32_t dt = adc.timestamp - previousTime;
+    if (active && havePrevious && previousPhase < PHASES && dt <= IP2366_CHARGE_MAX_GAP_MS)
+    {
+        Phase & p = current.phases[previousPhase];
+        uint16_t * remainder = remainders[previousPhase];
+        p.duration_ms += dt;
+        integrate(p.batteryEnergy_mJ, remainder[0], (uint32_t)previous.VBATVoltage * previous.BATCurrent / 1000, dt);
+        integrate(p.inputEnergy_mJ, remainder[1], previous.VsysPower, dt);
+        integrate(p.charge_mAs, remainder[2], previous.BATCurrent, dt);
+    }
+
+    if (phase < PHASES)
+    {
+        if (!active)
+        {
+            memset(&current, 0, sizeof(current));
+            memset(remainders, 0, sizeof(remainders));
+            current.startTime = adc.timestamp;
+            current.result = Result::IN_PROGRESS;
+            active = true;
+        }
+        if (adc.BATCurrent > current.phases[phase].peakCurrent_mA)
+            current.phases[phase].peakCurrent_mA = adc.BATCurrent;
+    }
+    else if (active)
+    {
+        if (state == IP2366::ChargeState::CHARGE_FULL)
+            finish(Result::FULL);
+        else if (state == IP2366::ChargeState::CHARGE_TIMEOUT)
+            finish(Result::TIMEOUT);
+        else if (state != IP2366::ChargeState::CHARGE_WAIT)
+            finish(Result::ABORTED);
+    }
+
+    previous = adc;
+    previousTime = adc.timestamp;
+    previousPhase = phase;
+    havePrevious = true;
+}
+
+void IP2366ChargeAnalytics::finish(Result result)
+{
+    active = false;
+    current.result = result;
+    history[head] = current;
+    head = (head + 1) % IP2366_CHARGE_HISTORY;
+    if (count < IP2366_CHARGE_HISTORY)
+        count++;
+    if (callback != nullptr)
+        callback(current, context);
+}
+
+const IP2366ChargeAnalytics::Cycle & IP2366ChargeAnalytics::getHistory(uint8_t index) const
+{
+    static const Cycle empty = {};
+    if (index >= count)
+        return empty;
+    return history[(head + IP2366_CHARGE_HISTORY - 1 - index) % IP2366_CHARGE_HISTORY];
+}
@@ -0,0 +1,93 @@
+#ifndef IP2366_CHARGE_ANALYTICS_H
+#define IP2366_CHARGE_ANALYTICS_H
+
+#include "IP2366.h"
+
+#ifndef IP2366_CHARGE_HISTORY
+#define IP2366_CHARGE_HISTORY 4
+#endif
+
+#define IP2366_CHARGE_MAX_GAP_MS 10000 // longer gaps between samples are not integrated
+
+// Per charge cycle statistics built incrementally from samples (O(1) memory per cycle).
+// A cycle starts when the charge state enters trickle/CC/CV and ends on CHARGE_FULL, CHARGE_TIMEOUT
+// or when charging stops otherwise (aborted); CHARGE_WAIT pauses the cycle.
+class IP2366ChargeAnalytics
+{
+public:
+    enum class Result
+    {
+        IN_PROGRESS = 0,
+        FULL = 1,
+        TIMEOUT = 2,
+        ABORTED = 3
+    };
+
+    enum PhaseIndex
+    {
+        TRICKLE = 0,
+        CONSTANT_CURRENT = 1,
+        CONSTANT_VOLTAGE = 2,
+        PHASES = 3
+    };
+
+    struct Phase
+    {
+        uint32_t duration_ms;
+        uint32_t batteryEnergy_mJ; // integral of VBAT * IBAT
+        uint32_t inputEnergy_mJ;   // integral of Vsys power
+        uint32_t charge_mAs;
+        uint16_t peakCurrent_mA;
+
+        uint16_t getAverageCurrent() const { return duration_ms ? (uint64_t)charge_mAs * 1000 / duration_ms : 0; }; // mA
+    };
+
+    struct Cycle
+    {
+        uint32_t startTime; // millis()
+        Result result;
+        Phase phases[PHASES];
+
+        uint32_t getDuration() const;       // ms
+        uint32_t getBatteryEnergy() const;  // mJ
+        uint32_t getInputEnergy() const;    // mJ
+        uint16_t getEfficiency() const;     // battery / input energy, per mille
+    };
+
+    typedef void (*Callback)(const Cycle & cycle, void * context);
+
+    IP2366ChargeAnalytics();
+
+    void addSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status);
+
+    // IP2366Sampler callback: sampler.subscribe(IP2366ChargeAnalytics::onSample, &analytics)
+    static void onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * analytics);
+
+    bool isCharging() const { return active; };
+    const Cycle & getCurrent() const { return current; };
+
+    uint8_t getHistorySize() const { return count; };
+    const Cycle & getHistory(uint8_t index) const; // 0 - most recent, a zeroed cycle beyond getHistorySize()
+    void clearHistory() { count = 0; };
+
+    void setCallback(Callback callback, void * context = nullptr) { this->callback = callback; this->context = context; };
+
+private:
+    static void integrate(uint32_t & total, uint16_t & remainder, uint32_t value, uint32_t dt_ms); // total += value * dt / 1000
+    void finish(Result result);
+
+    bool active;
+    bool havePrevious;
+    uint32_t previousTime;
+    uint8_t previousPhase;
+    IP2366::AdcSnapshot previous;
+    uint16_t remainders[PHASES][3];
+    Cycle current;
+    Cycle history[IP2366_CHARGE_HISTORY];
+    uint8_t head;
+    uint8_t count;
+    Callback callback;
+    void * context;
+};
+
+#endif
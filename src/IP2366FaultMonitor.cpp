@@ -0,0 +1,84 @@
+#include "IP2366FaultMonitor.h"
+#include "IP2366Platform.h"
+
+bool IP2366FaultMonitor::update()
+{
+    if (polled && !triggered && (uint32_t)(millis() - lastPoll) < interval)
+        return false;
+    return poll();
+}
+
+bool IP2366FaultMonitor::poll()
+{
+    triggered = false;
+    uint32_t start = micros();
+    if (polled && start - lastPoll_us > stats.maxPollGap_us)
+        stats.maxPollGap_us = start - lastPoll_us;
+    polled = true;
+    lastPoll = millis();
+    lastPoll_us = start;
+    stats.polls++;
+
+    uint8_t errorCode = 0;
+    uint8_t faults = chip.readFaults(&errorCode);
+    if (!errorCode && converter != nullptr)
+    {
+        uint32_t resistance = chip.getNTCResistance(&errorCode);
+        if (!errorCode && converter(resistance) >= overTemperature)
+            faults |= IP2366::FAULT_OVERHEAT;
+    }
+    uint32_t detected = micros();
+    if (detected - start > stats.maxRead_us)
+        stats.maxRead_us = detected - start;
+    if (errorCode)
+    {
+        stats.errors++;
+        return false;
+    }
+
+    active = faults;
+    uint8_t fresh = faults & ~latched;
+    if (!fresh)
+        return false;
+
+    latched |= fresh;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        if (fresh & (1 << i))
+            latchTime[i] = lastPoll;
+    }
+
+    if (fresh & cutOutput)
+        chip.setOutputFeatures(false, false, false, false);
+
+    if (callback != nullptr)
+    {
+        Event event = {fresh, faults, detected};
+        callback(event, chip, context);
+    }
+
+    stats.lastAction_us = micros() - detected;
+    if (stats.lastAction_us > stats.maxAction_us)
+        stats.maxAction_us = stats.lastAction_us;
+    return true;
+}
+
+uint8_t IP2366FaultMonitor::indexOf(uint8_t fault)
+{
+    uint8_t index = 0;
+    while (index < 3 && !(fault & (1 << index)))
+        index++;
+    return index;
+}
+
+uint32_t IP2366FaultMonitor::getLatchTime(IP2366::Faults fault) const
+{
+    return (latched & fault) ? latchTime[indexOf(fault)] : 0;
+}
+
+void IP2366FaultMonitor::clear(uint8_t faults)
+{
+    if (faults & (IP2366::FAULT_VSYS_OVERCURRENT | IP2366::FAULT_VSYS_SHORT_CIRCUIT))
+        chip.clearVsysFaults();
+    latched &= ~faults;
+}
@@ -0,0 +1,75 @@
+#ifndef IP2366_FAULT_MONITOR_H
+#define IP2366_FAULT_MONITOR_H
+
+#include "IP2366.h"
+#include "IP2366Ntc.h"
+
+// Dedicated fault watch: polls only the fault registers (0x33-0x38 burst) at a short interval,
+// latches new faults with their time and reacts right away: optionally cuts the output through
+// setOutputFeatures() and calls the user callback. FAULT_OVERHEAT is derived from the NTC temperature
+// (one more burst read of 0x77-0x79) and is off unless setOverTemperature() is called.
+// Call update() first thing in loop(), before any telemetry; trigger() (safe from an ISR) forces the next
+// update() to poll immediately. Detection latency is bounded by the poll gap plus the read time, both measured.
+class IP2366FaultMonitor
+{
+public:
+    struct Event
+    {
+        uint8_t faults;   // newly latched IP2366::Faults
+        uint8_t active;   // all faults present in this poll
+        uint32_t time_us; // micros() at detection
+    };
+
+    struct Stats
+    {
+        uint32_t polls;
+        uint32_t errors;        // failed polls
+        uint32_t maxPollGap_us; // longest time between two polls
+        uint32_t maxRead_us;    // longest fault register read
+        uint32_t lastAction_us; // detection to end of output cut and callback, last event
+        uint32_t maxAction_us;
+    };
+
+    typedef void (*Callback)(const Event & event, IP2366 & chip, void * context);
+
+    IP2366FaultMonitor(IP2366 & chip, uint16_t interval_ms = 5) : chip(chip), interval(interval_ms) {};
+
+    void setCallback(Callback callback, void * context = nullptr) { this->callback = callback; this->context = context; };
+    void setCutOutput(uint8_t faults) { cutOutput = faults; }; // faults that switch all outputs off before the callback
+    void setInterval(uint16_t interval_ms) { interval = interval_ms; };
+    // FAULT_OVERHEAT at or above limit (0.1 degC), nullptr disables it
+    void setOverTemperature(IP2366NtcConverter converter, int16_t limit = 600) { this->converter = converter; overTemperature = limit; };
+
+    void trigger() { triggered = true; };
+    bool update(); // call from loop(), returns true when new faults were latched
+    bool poll();   // poll right now
+
+    uint8_t getActive() const { return active; };   // faults seen in the last successful poll
+    uint8_t getLatched() const { return latched; }; // faults seen since the last clear()
+    uint32_t getLatchTime(IP2366::Faults fault) const; // millis() when the fault was latched, 0 if not latched
+    void clear(uint8_t faults = 0xFF);                 // unlatch, also clears the chip's Vsys flags (write 1 to clear)
+
+    const Stats & getStats() const { return stats; };
+    void resetStats() { stats = {0, 0, 0, 0, 0, 0}; };
+
+private:
+    static uint8_t indexOf(uint8_t fault);
+
+    IP2366 & chip;
+    uint16_t interval;
+    IP2366NtcConverter converter = nullptr;
+    int16_t overTemperature = 600;
+    volatile bool triggered = false;
+    bool polled = false;
+    uint32_t lastPoll = 0;    // millis()
+    uint32_t lastPoll_us = 0; // micros()
+    uint8_t active = 0;
+    uint8_t latched = 0;
+    uint8_t cutOutput = 0;
+    uint32_t latchTime[4] = {0, 0, 0, 0};
+    Callback callback = nullptr;
+    void * context = nullptr;
+    Stats stats = {0, 0, 0, 0, 0, 0};
+};
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef IP2366_FILTERS_H
+#define IP2366_FILTERS_H
+
+#include <stdint.h>
+
+#include "IP2366.h"
+
+// Allocation-free fixed-point streaming filters for ADC channels.
+// All filters take and return uint16_t samples (the ADC registers are 16 bit) and are header-only templates,
+// so a filter costs nothing unless it is instantiated.
+
+// Exponential moving average, alpha = 1 / 2^Shift
+template <uint8_t Shift>
+class IP2366EmaFilter
+{
+    static_assert(Shift >= 1 && Shift <= 15, "Shift must be 1..15");
+
+public:
+    uint16_t update(uint16_t sample)
+    {
+        if (!primed)
+        {
+            state = (uint32_t)sample << Shift;
+            primed = true;
+        }
+        else
+        {
+            state = state - (state >> Shift) + sample; // state holds average * 2^Shift
+        }
+        return value();
+    };
+
+    uint16_t value() const { return (state + (1UL << (Shift - 1))) >> Shift; };
+    void reset() { primed = false; };
+
+private:
+    uint32_t state = 0;
+    bool primed = false;
+};
+
+// Sliding median of the last N samples
+template <uint8_t N>
+class IP2366MedianFilter
+{
+    static_assert(N >= 1, "N must be at least 1");
+
+public:
+    uint16_t update(uint16_t sample)
+    {
+        if (count == N)
+        {
+            // drop the oldest sample from the sorted copy
+            uint16_t oldest = window[next];
+            uint8_t i = 0;
+            while (sorted[i] != oldest)
+                i++;
+            for (; i + 1 < count; i++)
+                sorted[i] = sorted[i + 1];
+            count--;
+        }
+
+        uint8_t i = count;
+        while (i > 0 && sorted[i - 1] > sample)
+        {
+            sorted[i] = sorted[i - 1];
+            i--;
+        }
+        sorted[i] = sample;
+        count++;
+
+        window[next] = sample;
+        next = (next + 1) % N;
+        return value();
+    };
+
+    uint16_t value() const { return count ? sorted[count / 2] : 0; };
+    uint8_t size() const { return count; };
+    void reset() { count = 0; next = 0; };
+
+private:
+    uint16_t window[N];
+    uint16_t sorted[N];
+    uint8_t count = 0;
+    uint8_t next = 0;
+};
+
+// Minimum, maximum and mean over the last N samples, O(1) amortized per sample
+template <uint8_t N>
+class IP2366WindowStats
+{
+    static_assert(N >= 1, "N must be at least 1");
+
+public:
+    uint16_t update(uint16_t sample)
+    {
+        if (count == N)
+            sum -= window[sequence % N];
+        else
+            count++;
+        window[sequence % N] = sample;
+        sum += sample;
+
+        push(minQueue, minHead, minSize, sample, true);
+        push(maxQueue, maxHead, maxSize, sample, false);
+        sequence++;
+        return mean();
+    };
+
+    uint16_t min() const { return minSize ? window[minQueue[minHead] % N] : 0; };
+    uint16_t max() const { return maxSize ? window[maxQueue[maxHead] % N] : 0; };
+    uint16_t mean() const { return count ? (sum + count / 2) / count : 0; };
+    uint16_t value() const { return mean(); };
+    uint8_t size() const { return count; };
+    void reset() { count = 0; sum = 0; sequence = 0; minHead = minSize = maxHead = maxSize = 0; };
+
+private:
+    // Monotonic queue of sample sequence numbers; the front is the current extreme
+    void push(uint32_t * queue, uint8_t & head, uint8_t & size, uint16_t sample, bool minimum)
+    {
+        if (size && queue[head] + N <= sequence) // front left the window
+        {
+            head = (head + 1) % N;
+            size--;
+        }
+        while (size)
+        {
+            uint16_t back = window[queue[(head + size - 1) % N] % N];
+            if (minimum ? back < sample : back > sample)
+                break;
+            size--;
+        }
+        queue[(head + size) % N] = sequence;
+        size++;
+    };
+
+    uint16_t window[N];
+    uint32_t minQueue[N];
+    uint32_t maxQueue[N];
+    uint32_t sum = 0;
+    uint32_t sequence = 0;
+    uint8_t count = 0;
+    uint8_t minHead = 0, minSize = 0;
+    uint8_t maxHead = 0, maxSize = 0;
+};
+
+// Outlier rejection for torn or glitched reads: a sample further than Threshold from the median of the
+// last N accepted samples is replaced by that median, unless MaxRejects samples in a row were rejected
+// (then the signal really stepped and the sample is accepted).
+template <uint8_t N, uint16_t Threshold, uint8_t MaxRejects = 3>
+class IP2366OutlierFilter
+{
+public:
+    uint16_t update(uint16_t sample)
+    {
+        uint16_t median = accepted.value();
+        uint16_t deviation = sample > median ? sample - median : median - sample;
+        if (accepted.size() > N / 2 && deviation > Threshold && rejected < MaxRejects)
+        {
+            rejected++;
+            rejectedTotal++;
+            last = median;
+            return last;
+        }
+        if (rejected >= MaxRejects)
+            accepted.reset(); // the signal stepped, restart the reference window at the new level
+        rejected = 0;
+        accepted.update(sample);
+        last = sample;
+        return last;
+    };
+
+    uint16_t value() const { return last; };
+    uint32_t getRejected() const { return rejectedTotal; };
+    void reset() { accepted.reset(); last = 0; rejected = 0; };
+
+private:
+    IP2366MedianFilter<N> accepted;
+    uint16_t last = 0;
+    uint8_t rejected = 0;
+    uint32_t rejectedTotal = 0;
+};
+
+// Attaches a filter to one AdcSnapshot channel of an IP2366Sampler:
+//   IP2366ChannelFilter<IP2366EmaFilter<3>, uint16_t, &IP2366::AdcSnapshot::VBATVoltage> vbat;
+//   sampler.subscribe(vbat.onSample, &vbat);
+template <class Filter, class T, T IP2366::AdcSnapshot::*Channel>
+class IP2366ChannelFilter
+{
+public:
+    Filter filter;
+
+    uint16_t value() const { return filter.value(); };
+
+    static void onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot &, void * channel)
+    {
+        T sample = adc.*Channel;
+        static_cast<IP2366ChannelFilter *>(channel)->filter.update(sample > 0xFFFF ? 0xFFFF : sample);
+    };
+};
+
+#endif
@@ -0,0 +1,301 @@
+#include "IP2366Fleet.h"
+
+#if defined(__linux__)
+
+#include <chrono>
+#include <string.h>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#define IP2366_FLEET_CHUNK 32 // devices claimed at a time
+
+struct IP2366Fleet::Device
+{
+    IP2366SimBus bus;
+    IP2366 chip;
+    IP2366Scenario scenario;
+    uint64_t due_us = 0;
+    uint32_t scenarioStart = 0; // fleet clock, ms
+    bool started = false;
+
+    Device() : chip(bus), scenario(bus) {};
+};
+
+struct IP2366Fleet::Worker
+{
+    std::atomic<uint32_t> next; // next unclaimed device of this slice
+    uint32_t begin = 0;
+    uint32_t end = 0;
+    char padding[64];           // keeps the cursors of different workers on different cache lines
+    Histogram latency;
+    uint64_t quantization_us = 0;
+    uint32_t maxQuantization_us = 0;
+    uint64_t samples = 0;
+    uint64_t errors = 0;
+    uint64_t driver_ns = 0;
+    uint64_t sink_ns = 0;
+    uint64_t cpu_ns = 0;
+    uint64_t steals = 0;
+    uint32_t lateTicks = 0;
+};
+
+static uint64_t monotonic_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t threadCpu_ns()
+{
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+IP2366Fleet::IP2366Fleet(const Config & config)
+    : config(config), devices(new Device[config.devices]), threads(0), arrived(0), released(0)
+{
+}
+
+IP2366Fleet::~IP2366Fleet()
+{
+}
+
+bool IP2366Fleet::run(Sink sink, void * context, Report & report)
+{
+    memset(&report, 0, sizeof(report));
+    if (config.devices == 0 || config.interval_ms == 0 || config.tick_ms == 0)
+        return false;
+
+    this->sink = sink;
+    this->context = context;
+    threads = config.threads ? config.threads : std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    if (threads > config.devices)
+        threads = config.devices;
+
+    workers.reset(new Worker[threads]);
+    for (uint16_t i = 0; i < threads; i++)
+    {
+        workers[i].begin = (uint64_t)config.devices * i / threads;
+        workers[i].end = (uint64_t)config.devices * (i + 1) / threads;
+        workers[i].next.store(workers[i].begin);
+        workers[i].latency.clear();
+    }
+
+    start_us = monotonic_ns() / 1000 + config.tick_ms * 1000;
+    uint64_t interval_us = (uint64_t)config.interval_ms * 1000;
+    for (uint32_t i = 0; i < config.devices; i++)
+    {
+        devices[i].due_us = start_us + interval_us * i / config.devices; // staggered over one period
+        devices[i].started = false;
+    }
+    ticks = config.duration_ms / config.tick_ms;
+    arrived.store(0);
+    released.store(0);
+
+    std::vector<std::thread> pool;
+    for (uint16_t i = 1; i < threads; i++)
+        pool.push_back(std::thread(&IP2366Fleet::work, this, i));
+    work(0);
+    for (size_t i = 0; i < pool.size(); i++)
+        pool[i].join();
+
+    // SECTION: report
+    Histogram latency;
+    latency.clear();
+    uint64_t driver = 0, sinkTime = 0, cpu = 0, quantization = 0;
+    for (uint16_t i = 0; i < threads; i++)
+    {
+        Worker & worker = workers[i];
+        latency.merge(worker.latency);
+        report.samples += worker.samples;
+        report.errors += worker.errors;
+        report.steals += worker.steals;
+        report.lateTicks += worker.lateTicks;
+        driver += worker.driver_ns;
+        sinkTime += worker.sink_ns;
+        cpu += worker.cpu_ns;
+        quantization += worker.quantization_us;
+        if (worker.maxQuantization_us > report.maxQuantization_us)
+            report.maxQuantization_us = worker.maxQuantization_us;
+    }
+    uint64_t attempts = report.samples + report.errors;
+    report.elapsed_ms = monotonic_ns() / 1000000 - start_us / 1000;
+    report.samplesPerSecond = report.elapsed_ms ? report.samples * 1000 / report.elapsed_ms : 0;
+    report.p50_us = latency.percentile(500);
+    report.p99_us = latency.percentile(990);
+    report.p999_us = latency.percentile(999);
+    report.max_us = latency.max;
+    report.quantization_us = report.samples ? quantization / report.samples : 0;
+    report.driver_ns = attempts ? driver / attempts : 0;
+    report.sink_ns = report.samples ? sinkTime / report.samples : 0;
+    report.cpu_ns = attempts ? cpu / attempts : 0;
+    return true;
+}
+
+void IP2366Fleet::work(uint16_t index)
+{
+    Worker & self = workers[index];
+    uint64_t cpuStart = threadCpu_ns();
+
+    for (uint64_t tick = 0; tick < ticks; tick++)
+    {
+        waitTick(tick);
+        uint64_t tick_us = start_us + tick * config.tick_ms * 1000; // dispatch time, late wake-ups count as latency
+
+        // own slice first, then help the others
+        for (uint16_t k = 0; k < threads; k++)
+        {
+            uint32_t first, last;
+            while (claim((index + k) % threads, first, last))
+            {
+                if (k)
+                    self.steals++;
+                for (uint32_t device = first; device < last; device++)
+                    process(device, tick_us, self);
+            }
+        }
+
+        // barrier, the last worker to arrive rearms the slices
+        if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == threads)
+        {
+            for (uint16_t i = 0; i < threads; i++)
+                workers[i].next.store(workers[i].begin, std::memory_order_relaxed);
+            arrived.store(0, std::memory_order_relaxed);
+            if (monotonic_ns() / 1000 > start_us + (tick + 1) * config.tick_ms * 1000)
+                self.lateTicks++;
+            released.store(tick + 1, std::memory_order_release);
+        }
+        else
+        {
+            while (released.load(std::memory_order_acquire) < tick + 1)
+                std::this_thread::yield();
+        }
+    }
+
+    self.cpu_ns = threadCpu_ns() - cpuStart;
+}
+
+void IP2366Fleet::waitTick(uint64_t tick)
+{
+    uint64_t at_us = start_us + tick * config.tick_ms * 1000;
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::microseconds(at_us)));
+}
+
+bool IP2366Fleet::claim(uint16_t slice, uint32_t & first, uint32_t & last)
+{
+    Worker & worker = workers[slice];
+    first = worker.next.fetch_add(IP2366_FLEET_CHUNK, std::memory_order_relaxed);
+    if (first >= worker.end)
+        return false;
+    last = first + IP2366_FLEET_CHUNK < worker.end ? first + IP2366_FLEET_CHUNK : worker.end;
+    return true;
+}
+
+void IP2366Fleet::process(uint32_t index, uint64_t tick_us, Worker & worker)
+{
+    Device & device = devices[index];
+    if (device.due_us > tick_us)
+        return;
+
+    // SECTION: scenario on the fleet clock
+    uint32_t now_ms = (tick_us - start_us) / 1000;
+    if (!device.started || (uint32_t)(now_ms - device.scenarioStart) >= config.scenarioPeriod_ms)
+    {
+        device.bus.reset();
+        device.scenario.start(config.steps, config.stepCount, now_ms);
+        device.scenarioStart = now_ms;
+        device.started = true;
+    }
+    device.scenario.update(now_ms);
+
+    // SECTION: sample through the driver
+    IP2366::AdcSnapshot adc;
+    IP2366::StatusSnapshot status;
+    uint64_t begin = monotonic_ns();
+    bool valid = device.chip.readAdcSnapshot(adc) && device.chip.readStatusSnapshot(status);
+    uint64_t read = monotonic_ns();
+    worker.driver_ns += read - begin;
+    if (!valid)
+    {
+        worker.errors++;
+    }
+    else
+    {
+        adc.timestamp = status.timestamp = (device.due_us - start_us) / 1000; // fleet clock, not the host's millis()
+        if (sink != nullptr)
+            sink(index, adc, status, context);
+        uint64_t done = monotonic_ns();
+        worker.sink_ns += done - read;
+        worker.samples++;
+        worker.latency.add(done / 1000 - tick_us);
+
+        uint32_t quantization = tick_us - device.due_us;
+        worker.quantization_us += quantization;
+        if (quantization > worker.maxQuantization_us)
+            worker.maxQuantization_us = quantization;
+    }
+
+    // late devices skip the missed periods instead of bunching up
+    uint64_t interval_us = (uint64_t)config.interval_ms * 1000;
+    device.due_us += interval_us;
+    if (device.due_us <= tick_us)
+        device.due_us += (tick_us - device.due_us) / interval_us * interval_us + interval_us;
+}
+
+// Histogram
+
+void IP2366Fleet::Histogram::clear()
+{
+    memset(counts, 0, sizeof(counts));
+    max = 0;
+}
+
+void IP2366Fleet::Histogram::add(uint32_t value)
+{
+    if (value > max)
+        max = value;
+    uint8_t index = value;
+    if (value >= 4)
+    {
+        uint8_t exponent = 31 - __builtin_clz(value);
+        index = (exponent - 1) * 4 + ((value >> (exponent - 2)) & 3);
+    }
+    counts[index]++;
+}
+
+void IP2366Fleet::Histogram::merge(const Histogram & other)
+{
+    for (uint8_t i = 0; i < 128; i++)
+        counts[i] += other.counts[i];
+    if (other.max > max)
+        max = other.max;
+}
+
+uint32_t IP2366Fleet::Histogram::percentile(uint32_t perMille) const
+{
+    uint64_t total = 0;
+    for (uint8_t i = 0; i < 128; i++)
+        total += counts[i];
+    if (total == 0)
+        return 0;
+
+    uint64_t rank = (total * perMille + 999) / 1000;
+    uint64_t seen = 0;
+    for (uint8_t i = 0; i < 128; i++)
+    {
+        seen += counts[i];
+        if (seen < rank)
+            continue;
+        if (i < 4)
+            return i;
+        uint8_t exponent = i / 4 + 1;
+        uint32_t upper = ((uint32_t)(4 + i % 4) << (exponent - 2)) + (1UL << (exponent - 2)) - 1; // bucket upper bound
+        return upper < max ? upper : max;
+    }
+    return max;
+}
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef IP2366_FLEET_H
+#define IP2366_FLEET_H
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+
+#include "IP2366.h"
+#include "IP2366Sim.h"
+
+// Load generator for telemetry pipelines: thousands of simulated chips (IP2366SimBus + IP2366Scenario),
+// each sampled through the real IP2366 driver at its own rate, spread over all CPU cores.
+// Time advances in ticks; in every tick each worker samples the due devices of its own slice of the fleet
+// and then steals chunks from the slices of slower workers, so one busy core does not stall the tick.
+// Every sample goes to the sink, which is the ingestion path under test and is called from all workers
+// at once. run() reports throughput, sample latency (tick dispatch to sink return), the tick quantization
+// (due time to dispatch) separately, and the CPU cost per sample.
+class IP2366Fleet
+{
+public:
+    struct Config
+    {
+        uint32_t devices = 1000;
+        uint16_t threads = 0;                       // 0 - one per CPU core
+        uint32_t interval_ms = 1000;                // sample period of each device, devices are staggered over it
+        uint32_t duration_ms = 10000;
+        uint16_t tick_ms = 10;                      // scheduling resolution
+        const IP2366Scenario::Step * steps = IP2366Scenario::ccToCv; // replayed on every device
+        uint8_t stepCount = IP2366Scenario::ccToCvLength;
+        uint32_t scenarioPeriod_ms = 30000;         // restart the scenario this long after its start
+    };
+
+    struct Report
+    {
+        uint64_t samples;
+        uint64_t errors;           // failed snapshot reads
+        uint32_t elapsed_ms;
+        uint32_t samplesPerSecond;
+        uint32_t p50_us;           // sample latency percentiles, from the tick dispatching the sample to the end of the sink call
+        uint32_t p99_us;
+        uint32_t p999_us;
+        uint32_t max_us;
+        uint32_t quantization_us;  // mean wait from the device's due time to the tick dispatching it, below tick_ms
+        uint32_t maxQuantization_us;
+        uint32_t driver_ns;        // mean driver + simulated bus time per sample
+        uint32_t sink_ns;          // mean sink time per sample
+        uint32_t cpu_ns;           // worker CPU time per sample, scheduling included
+        uint64_t steals;           // chunks taken from another worker's slice
+        uint32_t lateTicks;        // ticks that ended after the next one was due
+    };
+
+    // Called concurrently from all workers, must be thread-safe. The snapshot timestamps are on the fleet clock:
+    // ms since run() started at which the device's sample was due, so every device has its own staggered times.
+    typedef void (*Sink)(uint32_t device, const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * context);
+
+    IP2366Fleet(const Config & config);
+    ~IP2366Fleet();
+
+    bool run(Sink sink, void * context, Report & report);
+
+private:
+    struct Device;
+    struct Worker;
+
+    // log-linear latency histogram, 4 sub-buckets per power of two
+    struct Histogram
+    {
+        uint64_t counts[128];
+        uint32_t max;
+
+        void clear();
+        void add(uint32_t value);
+        void merge(const Histogram & other);
+        uint32_t percentile(uint32_t perMille) const;
+    };
+
+    void work(uint16_t index);
+    void process(uint32_t device, uint64_t tick_us, Worker & worker);
+    bool claim(uint16_t slice, uint32_t & first, uint32_t & last);
+    void waitTick(uint64_t tick);
+
+    Config config;
+    std::unique_ptr<Device[]> devices;
+    std::unique_ptr<Worker[]> workers;
+    uint16_t threads;
+    Sink sink = nullptr;
+    void * context = nullptr;
+    uint64_t start_us = 0;
+    uint64_t ticks = 0;
+    std::atomic<uint32_t> arrived;
+    std::atomic<uint64_t> released; // last tick every worker finished
+};
+
+#endif
+
+#endif
@@ -0,0 +1,85 @@
+#if defined(__linux__)
+
+#include "IP2366LinuxI2CBus.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+// Maps errno of a failed transfer onto Wire.endTransmission() error codes
+static uint8_t toErrorCode(int error)
+{
+    switch (error)
+    {
+    case ENXIO:
+    case EREMOTEIO:
+        return 2; // NACK
+    case ETIMEDOUT:
+        return 5; // timeout
+    default:
+        return 4; // other error
+    }
+}
+
+IP2366LinuxI2CBus::~IP2366LinuxI2CBus()
+{
+    end();
+}
+
+void IP2366LinuxI2CBus::begin()
+{
+    if (fd < 0)
+        fd = open(device, O_RDWR);
+}
+
+void IP2366LinuxI2CBus::end()
+{
+    if (fd >= 0)
+        close(fd);
+    fd = -1;
+}
+
+uint8_t IP2366LinuxI2CBus::writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length)
+{
+    if (fd < 0)
+        return 4;
+
+    uint8_t buffer[256];
+    if (length > sizeof(buffer) - 1)
+        return 1; // data too long
+    buffer[0] = regAddress;
+    memcpy(buffer + 1, data, length);
+
+    struct i2c_msg message = {address, 0, (uint16_t)(length + 1), buffer};
+    struct i2c_rdwr_ioctl_data transfer = {&message, 1};
+    if (ioctl(fd, I2C_RDWR, &transfer) < 0)
+        return toErrorCode(errno);
+    return 0;
+}
+
+uint8_t IP2366LinuxI2CBus::readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length)
+{
+    if (fd < 0)
+    {
+        memset(data, 0xFF, length);
+        return 4;
+    }
+
+    struct i2c_msg messages[2] = {
+        {address, 0, 1, &regAddress},
+        {address, I2C_M_RD, length, data},
+    };
+    struct i2c_rdwr_ioctl_data transfer = {messages, 2};
+    if (ioctl(fd, I2C_RDWR, &transfer) < 0)
+    {
+        memset(data, 0xFF, length);
+        return toErrorCode(errno);
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef IP2366_LINUX_I2C_BUS_H
+#define IP2366_LINUX_I2C_BUS_H
+
+#if defined(__linux__)
+
+#include "IP2366Bus.h"
+
+// Transport over Linux i2c-dev (/dev/i2c-N).
+// Reads are issued as a single I2C_RDWR transfer (register write + repeated start + read),
+// so a burst read costs one syscall.
+class IP2366LinuxI2CBus : public IP2366Bus
+{
+public:
+    IP2366LinuxI2CBus(const char * device = "/dev/i2c-1") : device(device), fd(-1) {};
+    ~IP2366LinuxI2CBus();
+
+    void begin() override;
+    void end();
+    bool isOpen() const { return fd >= 0; };
+
+    uint8_t writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length) override;
+    uint8_t readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length) override;
+
+private:
+    const char * device;
+    int fd;
+};
+
+#endif
+
+#endif
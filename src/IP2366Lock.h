@@ -0,0 +1,58 @@
+#ifndef IP2366_LOCK_H
+#define IP2366_LOCK_H
+
+// Bus locking policy for sharing one IP2366 between tasks/threads.
+// The driver may take the lock again while already holding it (a batch wrapping read-modify-write setters),
+// so implementations must be recursive.
+class IP2366Lock
+{
+public:
+    virtual void lock() = 0;
+    virtual void unlock() = 0;
+
+protected:
+    ~IP2366Lock() {}
+};
+
+#if defined(ESP_PLATFORM) || defined(INC_FREERTOS_H)
+
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#else
+#include <semphr.h>
+#endif
+
+// FreeRTOS recursive mutex
+class IP2366FreeRTOSLock : public IP2366Lock
+{
+public:
+    IP2366FreeRTOSLock() : mutex(xSemaphoreCreateRecursiveMutex()) {};
+
+    void lock() override { xSemaphoreTakeRecursive(mutex, portMAX_DELAY); };
+    void unlock() override { xSemaphoreGiveRecursive(mutex); };
+
+private:
+    SemaphoreHandle_t mutex;
+};
+
+#endif
+
+#if defined(__linux__)
+
+#include <mutex>
+
+// std::recursive_mutex for Linux builds
+class IP2366StdLock : public IP2366Lock
+{
+public:
+    void lock() override { mutex.lock(); };
+    void unlock() override { mutex.unlock(); };
+
+private:
+    std::recursive_mutex mutex;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,351 @@
+#include "IP2366Log.h"
+#include "IP2366Platform.h"
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(IP2366LogRecord) == 24, "IP2366LogRecord must not contain padding");
+
+// Mount
+
+bool IP2366Log::mount()
+{
+    pageSize = storage.getPageSize();
+    pages = pageSize ? storage.getSize() / pageSize : 0;
+    slots = pageSize > sizeof(PageHeader) ? (pageSize - sizeof(PageHeader)) / sizeof(IP2366LogRecord) : 0;
+    usedPages = 0;
+    headSlot = 0;
+    headSequence = 0;
+    boot = 1;
+    if (pages < 2 || slots == 0)
+    {
+        pages = 0;
+        return false;
+    }
+
+    // SECTION: newest page, from the headers only
+    bool found = false;
+    uint32_t sequence;
+    for (uint16_t page = 0; page < pages; page++)
+    {
+        if (readHeader(page, sequence) && (!found || (int32_t)(sequence - headSequence) > 0))
+        {
+            found = true;
+            headPage = page;
+            headSequence = sequence;
+        }
+    }
+    if (!found)
+    {
+        headPage = pages - 1; // the first append starts page 0
+        headSlot = slots;
+        return true;
+    }
+
+    // SECTION: older pages, back to the first gap in the sequence
+    usedPages = 1;
+    oldestPage = headPage;
+    while (usedPages < pages)
+    {
+        uint16_t page = (oldestPage + pages - 1) % pages;
+        if (!readHeader(page, sequence) || sequence != headSequence - usedPages)
+            break;
+        oldestPage = page;
+        usedPages++;
+    }
+
+    // SECTION: first free slot of the newest page, records are written in order
+    uint16_t low = 0;
+    uint16_t high = slots;
+    while (low < high)
+    {
+        uint16_t middle = (low + high) / 2;
+        if (isEmpty(headPage, middle))
+            high = middle;
+        else
+            low = middle + 1;
+    }
+    headSlot = low;
+
+    // SECTION: boot number continues from the newest readable record
+    uint32_t count = getCount();
+    IP2366LogRecord last;
+    for (uint8_t i = 1; i <= 4 && i <= count; i++)
+    {
+        if (read(count - i, last))
+        {
+            boot = last.boot + 1;
+            break;
+        }
+    }
+    return true;
+}
+
+bool IP2366Log::format()
+{
+    if (pages == 0 && !mount())
+        return false;
+    for (uint16_t page = 0; page < pages; page++)
+    {
+        stats.erases++;
+        if (!storage.erase((uint32_t)page * pageSize))
+        {
+            stats.errors++;
+            return false;
+        }
+    }
+    return mount();
+}
+
+// Append
+
+bool IP2366Log::append(IP2366LogRecord & record)
+{
+    if (pages == 0)
+        return false;
+    if (headSlot >= slots && !startPage())
+        return false;
+
+    record.boot = boot;
+    record.crc = crc16(&record, offsetof(IP2366LogRecord, crc));
+    stats.appends++;
+    bool written = storage.write(address(headPage, headSlot), &record, sizeof(record));
+    headSlot++; // a failed write may still have programmed part of the slot
+    if (!written)
+        stats.errors++;
+    return written;
+}
+
+bool IP2366Log::appendSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status)
+{
+    IP2366LogRecord record;
+    memset(&record, 0, sizeof(record));
+    record.time = adc.timestamp;
+    record.status = status.getSystemStatus().raw();
+    record.VBATVoltage = adc.VBATVoltage;
+    record.VsysVoltage = adc.VsysVoltage;
+    record.BATCurrent = adc.BATCurrent;
+    record.VsysCurrent = adc.VsysCurrent;
+    record.VsysPower = adc.VsysPower;
+    record.type = RECORD_SAMPLE;
+    return append(record);
+}
+
+bool IP2366Log::appendEvent(uint8_t event, const IP2366::StatusSnapshot & status)
+{
+    IP2366LogRecord record;
+    memset(&record, 0, sizeof(record));
+    record.time = millis();
+    record.status = status.getSystemStatus().raw();
+    record.type = RECORD_EVENT;
+    record.event = event;
+    return append(record);
+}
+
+void IP2366Log::onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * log)
+{
+    static_cast<IP2366Log *>(log)->appendSample(adc, status);
+}
+
+bool IP2366Log::startPage()
+{
+    uint16_t next = (headPage + 1) % pages;
+    stats.erases++;
+    if (!storage.erase((uint32_t)next * pageSize))
+    {
+        stats.errors++;
+        return false;
+    }
+
+    PageHeader header = {IP2366_LOG_MAGIC, headSequence + 1, sizeof(IP2366LogRecord), 0};
+    header.crc = crc16(&header, offsetof(PageHeader, crc));
+    if (!storage.write((uint32_t)next * pageSize, &header, sizeof(header)))
+    {
+        stats.errors++;
+        return false;
+    }
+
+    if (usedPages == 0)
+        oldestPage = next;
+    else if (usedPages == pages)
+        oldestPage = (oldestPage + 1) % pages; // the oldest page was just erased
+    if (usedPages < pages)
+        usedPages++;
+    headPage = next;
+    headSequence++;
+    headSlot = 0;
+    return true;
+}
+
+// Read
+
+uint32_t IP2366Log::getCount() const
+{
+    return usedPages == 0 ? 0 : (uint32_t)(usedPages - 1) * slots + headSlot;
+}
+
+uint32_t IP2366Log::getCapacity() const
+{
+    return pages < 2 ? 0 : (uint32_t)(pages - 1) * slots;
+}
+
+bool IP2366Log::read(uint32_t index, IP2366LogRecord & record)
+{
+    if (index >= getCount())
+        return false;
+    return readSlot((oldestPage + index / slots) % pages, index % slots, record);
+}
+
+bool IP2366Log::readHeader(uint16_t page, uint32_t & sequence)
+{
+    PageHeader header;
+    stats.reads++;
+    if (!storage.read((uint32_t)page * pageSize, &header, sizeof(header)))
+    {
+        stats.errors++;
+        return false;
+    }
+    if (header.magic != IP2366_LOG_MAGIC || header.recordSize != sizeof(IP2366LogRecord) ||
+        header.crc != crc16(&header, offsetof(PageHeader, crc)))
+        return false;
+    sequence = header.sequence;
+    return true;
+}
+
+bool IP2366Log::isEmpty(uint16_t page, uint16_t slot)
+{
+    uint8_t data[sizeof(IP2366LogRecord)];
+    stats.reads++;
+    if (!storage.read(address(page, slot), data, sizeof(data)))
+    {
+        stats.errors++;
+        return false;
+    }
+    for (uint8_t i = 0; i < sizeof(data); i++)
+    {
+        if (data[i] != 0xFF)
+            return false;
+    }
+    return true;
+}
+
+bool IP2366Log::readSlot(uint16_t page, uint16_t slot, IP2366LogRecord & record)
+{
+    stats.reads++;
+    if (!storage.read(address(page, slot), &record, sizeof(record)))
+    {
+        stats.errors++;
+        return false;
+    }
+    return record.type != 0xFF && record.crc == crc16(&record, offsetof(IP2366LogRecord, crc));
+}
+
+uint32_t IP2366Log::address(uint16_t page, uint16_t slot) const
+{
+    return (uint32_t)page * pageSize + sizeof(PageHeader) + (uint32_t)slot * sizeof(IP2366LogRecord);
+}
+
+// CRC-16/CCITT-FALSE
+
+uint16_t IP2366Log::crc16(const void * data, uint16_t length)
+{
+    const uint8_t * bytes = static_cast<const uint8_t *>(data);
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)bytes[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+#if defined(__linux__)
+
+// File storage
+
+bool IP2366FileLogStorage::open(const char * path, uint32_t size, uint16_t pageSize)
+{
+    close();
+    if (pageSize == 0 || size % pageSize != 0)
+        return false;
+
+    fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close();
+        return false;
+    }
+    this->size = size;
+    this->pageSize = pageSize;
+
+    // new space starts erased
+    for (uint32_t page = (uint32_t)info.st_size / pageSize; page < size / pageSize; page++)
+    {
+        if (!erase(page * pageSize))
+        {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void IP2366FileLogStorage::close()
+{
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+}
+
+bool IP2366FileLogStorage::read(uint32_t address, void * data, uint16_t length)
+{
+    return fd >= 0 && address + length <= size && pread(fd, data, length, address) == length;
+}
+
+bool IP2366FileLogStorage::write(uint32_t address, const void * data, uint16_t length)
+{
+    // programming only clears bits, like flash
+    uint8_t buffer[256];
+    const uint8_t * bytes = static_cast<const uint8_t *>(data);
+    while (length > 0)
+    {
+        uint16_t chunk = length < sizeof(buffer) ? length : sizeof(buffer);
+        if (!read(address, buffer, chunk))
+            return false;
+        for (uint16_t i = 0; i < chunk; i++)
+            buffer[i] &= bytes[i];
+        if (pwrite(fd, buffer, chunk, address) != chunk)
+            return false;
+        address += chunk;
+        bytes += chunk;
+        length -= chunk;
+    }
+    return true;
+}
+
+bool IP2366FileLogStorage::erase(uint32_t address)
+{
+    if (fd < 0 || address % pageSize != 0 || address + pageSize > size)
+        return false;
+    uint8_t buffer[256];
+    memset(buffer, 0xFF, sizeof(buffer));
+    for (uint32_t offset = 0; offset < pageSize; offset += sizeof(buffer))
+    {
+        uint16_t chunk = pageSize - offset < sizeof(buffer) ? pageSize - offset : sizeof(buffer);
+        if (pwrite(fd, buffer, chunk, address + offset) != chunk)
+            return false;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef IP2366_LOG_H
+#define IP2366_LOG_H
+
+#include <stdint.h>
+
+#include "IP2366.h"
+
+#define IP2366_LOG_MAGIC 0x4C363649 // "I66L"
+
+// Persistent storage region used by IP2366Log, split into equal erase pages.
+// Flash semantics: write() only programs erased bytes, erase() sets a whole page to 0xFF.
+// On EEPROM erase() simply writes 0xFF over the page.
+class IP2366LogStorage
+{
+public:
+    virtual uint32_t getSize() = 0;     // bytes, a multiple of the page size
+    virtual uint16_t getPageSize() = 0; // erase unit
+    virtual bool read(uint32_t address, void * data, uint16_t length) = 0;
+    virtual bool write(uint32_t address, const void * data, uint16_t length) = 0;
+    virtual bool erase(uint32_t address) = 0; // page starting at address
+
+protected:
+    ~IP2366LogStorage() {}
+};
+
+// Fixed-size log record, a sample or an event
+struct IP2366LogRecord
+{
+    uint32_t time;        // millis() when recorded
+    uint32_t status;      // IP2366::SystemStatus::raw()
+    uint16_t VBATVoltage; // mV
+    uint16_t VsysVoltage; // mV
+    uint16_t BATCurrent;  // mA
+    uint16_t VsysCurrent; // mA
+    uint16_t VsysPower;
+    uint16_t boot;        // mount count, tells millis() of different power cycles apart
+    uint8_t type;         // IP2366Log::RecordType
+    uint8_t event;        // user event code for RECORD_EVENT, e.g. IP2366::Faults
+    uint16_t crc;         // CRC-16 of the fields above
+};
+
+// Append-only log of IP2366 samples and events in a persistent storage region.
+// Pages are written in a ring, each starting with a CRC protected header carrying an increasing sequence
+// number; a page is erased only when the write head enters it, so every page wears evenly.
+// Appending is one write (plus one erase and header write at a page boundary). mount() finds the write head
+// from the page headers and a binary search inside the newest page, without reading the records.
+class IP2366Log
+{
+public:
+    enum RecordType : uint8_t
+    {
+        RECORD_SAMPLE = 0,
+        RECORD_EVENT = 1
+    };
+
+    struct Stats
+    {
+        uint32_t appends;
+        uint32_t erases;
+        uint32_t reads;  // storage reads, including mount()
+        uint32_t errors; // failed storage operations
+    };
+
+    IP2366Log(IP2366LogStorage & storage) : storage(storage) {};
+
+    bool mount();  // call at boot, false if the storage has less than two pages
+    bool format(); // erase the whole region
+
+    bool append(IP2366LogRecord & record); // fills boot and crc
+    bool appendSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status);
+    bool appendEvent(uint8_t event, const IP2366::StatusSnapshot & status);
+
+    uint32_t getCount() const; // records available, the oldest page is dropped when the ring wraps
+    uint32_t getCapacity() const; // records kept at least
+    bool read(uint32_t index, IP2366LogRecord & record); // 0 is the oldest, false if out of range or corrupt
+    uint16_t getBoot() const { return boot; };
+
+    // IP2366Sampler callback: sampler.subscribe(IP2366Log::onSample, &log, true) logs status changes
+    static void onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * log);
+
+    const Stats & getStats() const { return stats; };
+    void resetStats() { stats = {0, 0, 0, 0}; };
+
+    static uint16_t crc16(const void * data, uint16_t length);
+
+private:
+    struct PageHeader
+    {
+        uint32_t magic;
+        uint32_t sequence;
+        uint16_t recordSize;
+        uint16_t crc;
+    };
+
+    bool readHeader(uint16_t page, uint32_t & sequence);
+    bool isEmpty(uint16_t page, uint16_t slot);
+    bool readSlot(uint16_t page, uint16_t slot, IP2366LogRecord & record);
+    bool startPage();
+    uint32_t address(uint16_t page, uint16_t slot) const;
+
+    IP2366LogStorage & storage;
+    uint16_t pages = 0;
+    uint16_t pageSize = 0;
+    uint16_t slots = 0;     // records per page
+    uint16_t headPage = 0;  // page being written
+    uint16_t headSlot = 0;  // next free record in headPage
+    uint32_t headSequence = 0;
+    uint16_t oldestPage = 0;
+    uint16_t usedPages = 0; // pages holding records, headPage included
+    uint16_t boot = 0;
+    Stats stats = {0, 0, 0, 0};
+};
+
+#if defined(__linux__)
+
+// IP2366LogStorage in a regular file, to run and benchmark the log on Linux
+class IP2366FileLogStorage : public IP2366LogStorage
+{
+public:
+    IP2366FileLogStorage() : fd(-1), size(0), pageSize(0) {};
+    ~IP2366FileLogStorage() { close(); };
+
+    bool open(const char * path, uint32_t size, uint16_t pageSize = 4096); // created erased if missing or short
+    void close();
+
+    uint32_t getSize() override { return size; };
+    uint16_t getPageSize() override { return pageSize; };
+    bool read(uint32_t address, void * data, uint16_t length) override;
+    bool write(uint32_t address, const void * data, uint16_t length) override;
+    bool erase(uint32_t address) override;
+
+private:
+    int fd;
+    uint32_t size;
+    uint16_t pageSize;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,112 @@
+#include "IP2366LowPowerMonitor.h"
+#include "IP2366Platform.h"
+
+void IP2366LowPowerMonitor::begin()
+{
+    uint32_t now = millis();
+    chip.allowSleep();
+    state = State::ASLEEP;
+    stateStart = now;
+    windowStart = now - config.period_ms; // first window is due immediately
+}
+
+bool IP2366LowPowerMonitor::update()
+{
+    uint32_t now = millis();
+
+    switch (state)
+    {
+    case State::ASLEEP:
+        if ((uint32_t)(now - windowStart) < config.period_ms)
+            return false;
+        report.asleep_ms += now - stateStart;
+        windowStart += config.period_ms;
+        if ((uint32_t)(now - windowStart) >= config.period_ms)
+            windowStart = now; // missed whole periods, restart the cadence instead of bunching windows
+        chip.wake();
+        state = State::WAKING;
+        stateStart = now;
+        return false;
+
+    case State::WAKING:
+        if (!chip.isWakeComplete())
+            return false;
+        state = State::SAMPLING;
+        taken = 0;
+        lastSample = now - config.sampleSpacing_ms;
+        // fall through
+
+    case State::SAMPLING:
+        if ((uint32_t)(now - lastSample) < config.sampleSpacing_ms)
+            return false;
+        lastSample = now;
+        if (sampler.sample())
+            report.samples++;
+        else
+            report.failures++;
+        if (++taken < config.samples)
+            return false;
+        closeWindow(millis());
+        return true;
+    }
+    return false;
+}
+
+void IP2366LowPowerMonitor::closeWindow(uint32_t now)
+{
+    // Standby is only honoured while not charging, so skip the two transactions when it would be ignored
+    bool charging = sampler.isValid() && sampler.getStatus().getSystemStatus().has(IP2366::SystemStatus::CHARGING);
+    bool standby = false;
+    if (config.standby && !charging)
+    {
+        uint8_t errorCode = 0;
+        if (!standbyEnabled)
+        {
+            chip.enableStandbyMode(true, &errorCode);
+            standbyEnabled = errorCode == 0;
+        }
+        if (standbyEnabled)
+        {
+            chip.Standby(true, &errorCode);
+            standby = errorCode == 0;
+            standbyEnabled = standby; // enable it again next time, the chip may have been reset
+        }
+    }
+    chip.allowSleep();
+
+    report.windows++;
+    if (standby)
+        report.standbyWindows++;
+    report.awake_ms += now - stateStart;
+    state = State::ASLEEP;
+    stateStart = now;
+
+    if (sleepHook != nullptr)
+        sleepHook(getTimeToNextWindow(), sleepContext);
+}
+
+uint32_t IP2366LowPowerMonitor::getTimeToNextWindow() const
+{
+    if (state != State::ASLEEP)
+        return 0;
+    uint32_t elapsed = millis() - windowStart;
+    return elapsed >= config.period_ms ? 0 : config.period_ms - elapsed;
+}
+
+IP2366LowPowerMonitor::Report IP2366LowPowerMonitor::getReport() const
+{
+    Report result = report;
+    uint32_t current = millis() - stateStart;
+    if (state == State::ASLEEP)
+        result.asleep_ms += current;
+    else
+        result.awake_ms += current;
+    result.energy_mJ = ((uint64_t)result.awake_ms * config.awakePower_uW + (uint64_t)result.asleep_ms * config.sleepPower_uW) / 1000000;
+    return result;
+}
+
+void IP2366LowPowerMonitor::resetReport()
+{
+    report = {0, 0, 0, 0, 0, 0, 0};
+    stateStart = millis();
+}
@@ -0,0 +1,76 @@
+#ifndef IP2366_LOW_POWER_MONITOR_H
+#define IP2366_LOW_POWER_MONITOR_H
+
+#include "IP2366.h"
+#include "IP2366Sampler.h"
+
+// Duty-cycled monitoring: the chip is kept asleep/in standby and woken through INT only for short
+// sample windows, the MCU may sleep in between through the sleep hook.
+// Requires IP2366::setIntPin(). Samples are taken with sampler.sample(), so the sampler's subscribers
+// (filters, analytics, publishers) see every window.
+class IP2366LowPowerMonitor
+{
+public:
+    struct Config
+    {
+        uint32_t period_ms = 60000;      // window start to window start
+        uint8_t samples = 1;             // samples per window
+        uint16_t sampleSpacing_ms = 0;   // between samples inside a window
+        bool standby = true;             // request SYS_CTL9 standby after each window (ignored while charging)
+        uint32_t awakePower_uW = 30000;  // chip + MCU while a window is open, for the energy estimate
+        uint32_t sleepPower_uW = 500;    // chip standby + MCU sleep
+    };
+
+    struct Report
+    {
+        uint32_t windows;
+        uint32_t standbyWindows; // windows closed with the standby request written
+        uint32_t samples;
+        uint32_t failures;  // failed sample attempts
+        uint32_t awake_ms;  // measured time with INT high
+        uint32_t asleep_ms; // measured time with INT low
+        uint32_t energy_mJ; // estimate from the measured times and the configured power figures
+    };
+
+    // Called after a window closes, should sleep for at most duration_ms (millis() must keep counting)
+    typedef void (*SleepHook)(uint32_t duration_ms, void * context);
+
+    IP2366LowPowerMonitor(IP2366 & chip, IP2366Sampler & sampler) : chip(chip), sampler(sampler) {};
+
+    void setConfig(const Config & config) { this->config = config; };
+    const Config & getConfig() const { return config; };
+    void setSleepHook(SleepHook hook, void * context = nullptr) { sleepHook = hook; sleepContext = context; };
+
+    void begin();   // lets the chip sleep and schedules the first window right away
+    bool update();  // call from loop(), returns true when a window was completed
+
+    bool isAwake() const { return state != State::ASLEEP; };
+    uint32_t getTimeToNextWindow() const; // ms
+    Report getReport() const;
+    void resetReport();
+
+private:
+    enum class State
+    {
+        ASLEEP,
+        WAKING,
+        SAMPLING
+    };
+
+    void closeWindow(uint32_t now);
+
+    IP2366 & chip;
+    IP2366Sampler & sampler;
+    Config config;
+    State state = State::ASLEEP;
+    uint32_t windowStart = 0;
+    uint32_t stateStart = 0;
+    uint32_t lastSample = 0;
+    uint8_t taken = 0;
+    bool standbyEnabled = false;
+    SleepHook sleepHook = nullptr;
+    void * sleepContext = nullptr;
+    Report report = {0, 0, 0, 0, 0, 0, 0};
+};
+
+#endif
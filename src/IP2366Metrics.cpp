@@ -0,0 +1,346 @@
+#include "IP2366Metrics.h"
+#include <string.h>
+
+// Metric indexes, in the order of the table below
+enum
+{
+    METRIC_VBAT,
+    METRIC_IBAT,
+    METRIC_VSYS,
+    METRIC_ISYS,
+    METRIC_PSYS,
+    METRIC_VNTC,
+    METRIC_RNTC,
+    METRIC_CHARGE_VOLTAGE,
+    METRIC_UPTIME,
+    METRIC_CHARGE_STATE,
+    METRIC_STATUS,
+    METRIC_RECEIVED_PDO,
+    METRIC_FAULT,
+    METRIC_SAMPLES,
+    METRIC_LAST_ERROR,
+    METRIC_LOCK_COUNT,
+    METRIC_LOCK_TIME,
+    METRIC_LOCK_MAX
+};
+
+const IP2366MetricsExporter::Metric IP2366MetricsExporter::metrics[] = {
+    {"battery_voltage_volts", GAUGE, "volts", "Battery voltage"},
+    {"battery_current_amperes", GAUGE, "amperes", "Battery current"},
+    {"system_voltage_volts", GAUGE, "volts", "Vsys voltage"},
+    {"system_current_amperes", GAUGE, "amperes", "Vsys current"},
+    {"system_power_watts", GAUGE, "watts", "Vsys power"},
+    {"ntc_voltage_volts", GAUGE, "volts", "NTC voltage"},
+    {"ntc_resistance_ohms", GAUGE, "ohms", "NTC resistance"},
+    {"charge_voltage_volts", GAUGE, "volts", "Negotiated charge input voltage, 0 if not charging"},
+    {"uptime_seconds", GAUGE, "seconds", "Time of the sample since boot"},
+    {"charge_state", STATESET, nullptr, "Charge state"},
+    {"status", STATESET, nullptr, "Charger and Type-C status flags"},
+    {"received_pdo", STATESET, nullptr, "PDOs offered by the connected source"},
+    {"fault", STATESET, nullptr, "Fault flags"},
+    {"samples", COUNTER, nullptr, "Successful samples"},
+    {"last_error", GAUGE, nullptr, "I2C error code of the last sample attempt"},
+    {"bus_lock_acquisitions", COUNTER, nullptr, "Bus lock acquisitions"},
+    {"bus_lock_hold_seconds", COUNTER, "seconds", "Total bus lock hold time"},
+    {"bus_lock_hold_max_seconds", GAUGE, "seconds", "Longest bus lock hold"},
+};
+const uint8_t IP2366MetricsExporter::metricCount = sizeof(metrics) / sizeof(metrics[0]);
+
+static const char * const chargeStates[] = {"standby", "trickle", "constant_current", "constant_voltage", "wait", "full", "timeout"};
+
+struct StatusFlag
+{
+    const char * name;
+    uint32_t mask;
+};
+
+static const StatusFlag statusFlags[] = {
+    {"charging", IP2366::SystemStatus::CHARGING},
+    {"discharging", IP2366::SystemStatus::DISCHARGING},
+    {"charge_full", IP2366::SystemStatus::CHARGE_FULL},
+    {"fast_charge", IP2366::SystemStatus::FAST_CHARGE},
+    {"vbus_present", IP2366::SystemStatus::VBUS_PRESENT},
+    {"qc_sink", IP2366::SystemStatus::VBUS_SINK_QC},
+    {"qc_source", IP2366::SystemStatus::VBUS_SRC_QC},
+    {"typec_sink", IP2366::SystemStatus::TYPEC_SINK},
+    {"typec_source", IP2366::SystemStatus::TYPEC_SRC},
+    {"pd_sink", IP2366::SystemStatus::TYPEC_SINK_PD},
+    {"pd_source", IP2366::SystemStatus::TYPEC_SRC_PD},
+};
+
+static const char * const pdoNames[] = {"5v", "9v", "12v", "15v", "20v"};
+
+static const char * const faultNames[] = {"vsys_overcurrent", "vsys_short_circuit", "vbus_overvoltage"};
+
+// Source
+
+void IP2366MetricsExporter::begin(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, const IP2366::LockStats * lockStats)
+{
+    this->adc = adc;
+    this->status = status;
+    hasLockStats = lockStats != nullptr;
+    if (hasLockStats)
+        this->lockStats = *lockStats;
+    hasSampler = false;
+    rewind();
+}
+
+void IP2366MetricsExporter::begin(const IP2366Sampler & sampler, const IP2366::LockStats * lockStats)
+{
+    begin(sampler.getAdc(), sampler.getStatus(), lockStats);
+    hasSampler = true;
+    samples = sampler.getSequence();
+    lastError = sampler.getLastError();
+}
+
+// Output
+
+size_t IP2366MetricsExporter::read(char * chunk, size_t size)
+{
+    size_t done = 0;
+    while (done < size)
+    {
+        if (offset >= length && !render())
+            break;
+        size_t count = length - offset;
+        if (count > size - done)
+            count = size - done;
+        memcpy(chunk + done, line + offset, count);
+        offset += count;
+        done += count;
+    }
+    return done;
+}
+
+size_t IP2366MetricsExporter::write(char * buffer, size_t size)
+{
+    if (size == 0)
+        return 0;
+    rewind();
+    size_t done = read(buffer, size - 1);
+    if (!isFinished())
+    {
+        buffer[0] = 0;
+        return 0;
+    }
+    buffer[done] = 0;
+    return done;
+}
+
+void IP2366MetricsExporter::rewind()
+{
+    metric = 0;
+    lineIndex = 0;
+    finished = false;
+    length = 0;
+    offset = 0;
+}
+
+bool IP2366MetricsExporter::render()
+{
+    length = 0;
+    offset = 0;
+    while (metric < metricCount)
+    {
+        if (!isAvailable(metric))
+        {
+            metric++;
+            continue;
+        }
+
+        const Metric & m = metrics[metric];
+        uint8_t header = m.unit != nullptr ? 3 : 2;
+        uint8_t index = lineIndex++;
+        if (index == 0)
+        {
+            append("# TYPE ");
+            appendName(metric);
+            append(m.kind == GAUGE ? " gauge\n" : m.kind == COUNTER ? " counter\n" : " stateset\n");
+            return true;
+        }
+        if (index == 1 && m.unit != nullptr)
+        {
+            append("# UNIT ");
+            appendName(metric);
+            append(' ');
+            append(m.unit);
+            append('\n');
+            return true;
+        }
+        if (index == header - 1)
+        {
+            append("# HELP ");
+            appendName(metric);
+            append(' ');
+            append(m.help);
+            append('\n');
+            return true;
+        }
+        if (index - header < sampleCount(metric))
+        {
+            renderSample(metric, index - header);
+            return true;
+        }
+        metric++;
+        lineIndex = 0;
+    }
+
+    if (finished)
+        return false;
+    append("# EOF\n");
+    finished = true;
+    return true;
+}
+
+bool IP2366MetricsExporter::isAvailable(uint8_t metric) const
+{
+    if (metric == METRIC_SAMPLES || metric == METRIC_LAST_ERROR)
+        return hasSampler;
+    if (metric >= METRIC_LOCK_COUNT)
+        return hasLockStats;
+    return true;
+}
+
+uint8_t IP2366MetricsExporter::sampleCount(uint8_t metric) const
+{
+    switch (metric)
+    {
+    case METRIC_CHARGE_STATE:
+        return sizeof(chargeStates) / sizeof(chargeStates[0]);
+    case METRIC_STATUS:
+        return sizeof(statusFlags) / sizeof(statusFlags[0]);
+    case METRIC_RECEIVED_PDO:
+        return sizeof(pdoNames) / sizeof(pdoNames[0]);
+    case METRIC_FAULT:
+        return sizeof(faultNames) / sizeof(faultNames[0]);
+    default:
+        return 1;
+    }
+}
+
+void IP2366MetricsExporter::renderSample(uint8_t metric, uint8_t sample)
+{
+    IP2366::SystemStatus system = status.getSystemStatus();
+
+    appendName(metric);
+    if (metrics[metric].kind == COUNTER)
+        append("_total");
+
+    const char * state = nullptr;
+    bool active = false;
+    switch (metric)
+    {
+    case METRIC_CHARGE_STATE:
+        state = chargeStates[sample];
+        active = static_cast<uint8_t>(system.chargeState()) == sample;
+        break;
+    case METRIC_STATUS:
+        state = statusFlags[sample].name;
+        active = system.has(statusFlags[sample].mask);
+        break;
+    case METRIC_RECEIVED_PDO:
+        state = pdoNames[sample];
+        active = system.receivedPdo() & (1 << sample);
+        break;
+    case METRIC_FAULT:
+        state = faultNames[sample];
+        active = sample == 0 ? system.has(IP2366::SystemStatus::VSYS_OVERCURRENT)
+               : sample == 1 ? system.has(IP2366::SystemStatus::VSYS_SHORT_CIRCUIT)
+                             : system.has(IP2366::SystemStatus::VBUS_OVERVOLTAGE);
+        break;
+    }
+
+    // labels
+    bool hasLabels = labels != nullptr && labels[0] != 0;
+    if (hasLabels || state != nullptr)
+    {
+        append('{');
+        if (hasLabels)
+            append(labels);
+        if (state != nullptr)
+        {
+            if (hasLabels)
+                append(',');
+            appendName(metric);
+            append("=\"");
+            append(state);
+            append('"');
+        }
+        append('}');
+    }
+    append(' ');
+
+    switch (metric)
+    {
+    case METRIC_VBAT: appendFixed(adc.VBATVoltage, 3); break;
+    case METRIC_IBAT: appendFixed(adc.BATCurrent, 3); break;
+    case METRIC_VSYS: appendFixed(adc.VsysVoltage, 3); break;
+    case METRIC_ISYS: appendFixed(adc.VsysCurrent, 3); break;
+    case METRIC_PSYS: appendFixed(adc.VsysPower, 3); break;
+    case METRIC_VNTC: appendFixed(adc.NTCVoltage, 3); break;
+    case METRIC_RNTC: appendUnsigned(adc.NTCResistance); break;
+    case METRIC_CHARGE_VOLTAGE: appendUnsigned(system.chargeVoltage()); break;
+    case METRIC_UPTIME: appendFixed(adc.timestamp, 3); break;
+    case METRIC_SAMPLES: appendUnsigned(samples); break;
+    case METRIC_LAST_ERROR: appendUnsigned(lastError); break;
+    case METRIC_LOCK_COUNT: appendUnsigned(lockStats.count); break;
+    case METRIC_LOCK_TIME: appendFixed(lockStats.total_us, 6); break;
+    case METRIC_LOCK_MAX: appendFixed(lockStats.max_us, 6); break;
+    default: append(active ? '1' : '0'); break;
+    }
+    append('\n');
+}
+
+// Formatting, silently truncates at IP2366_METRICS_LINE_SIZE
+
+void IP2366MetricsExporter::append(char c)
+{
+    if (length < IP2366_METRICS_LINE_SIZE)
+        line[length++] = c;
+}
+
+void IP2366MetricsExporter::append(const char * text)
+{
+    while (*text)
+        append(*text++);
+}
+
+void IP2366MetricsExporter::appendUnsigned(uint32_t value)
+{
+    char digits[10];
+    uint8_t count = 0;
+    do
+    {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    while (count)
+        append(digits[--count]);
+}
+
+void IP2366MetricsExporter::appendFixed(uint32_t value, uint8_t decimals)
+{
+    uint32_t scale = 1;
+    for (uint8_t i = 0; i < decimals; i++)
+        scale *= 10;
+    appendUnsigned(value / scale);
+    if (!decimals)
+        return;
+    append('.');
+    uint32_t fraction = value % scale;
+    for (scale /= 10; scale > 0; scale /= 10)
+    {
+        append('0' + fraction / scale);
+        fraction %= scale;
+    }
+}
+
+void IP2366MetricsExporter::appendName(uint8_t metric)
+{
+    if (prefix != nullptr && prefix[0] != 0)
+    {
+        append(prefix);
+        append('_');
+    }
+    append(metrics[metric].name);
+}
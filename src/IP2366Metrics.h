@@ -0,0 +1,81 @@
+#ifndef IP2366_METRICS_H
+#define IP2366_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "IP2366.h"
+#include "IP2366Sampler.h"
+
+#define IP2366_METRICS_LINE_SIZE 160 // longest line, labels included
+
+// OpenMetrics text exposition of one sample: ADC values (base units, fixed-point), charge state, Type-C / PD
+// state, fault flags, and optionally the sampler counters and bus lock statistics.
+// Text is produced line by line with integer formatting only (no printf, no floats, no allocation), either
+// into one buffer with write() or in chunks of any size with read(), e.g. straight into a socket or
+// Serial without holding the whole exposition in RAM.
+class IP2366MetricsExporter
+{
+public:
+    IP2366MetricsExporter(const char * prefix = "ip2366", const char * labels = nullptr) : prefix(prefix), labels(labels) {};
+
+    void setLabels(const char * labels) { this->labels = labels; }; // added to every sample, e.g. "pack=\"7\""
+
+    // Select what to export, then read() from the start
+    void begin(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, const IP2366::LockStats * lockStats = nullptr);
+    void begin(const IP2366Sampler & sampler, const IP2366::LockStats * lockStats = nullptr);
+
+    size_t read(char * chunk, size_t size);   // next part of the text, 0 once everything was read
+    size_t write(char * buffer, size_t size); // whole text, null terminated; 0 if it does not fit
+    bool isFinished() const { return finished && offset >= length; };
+
+private:
+    enum Kind : uint8_t
+    {
+        GAUGE,
+        COUNTER,
+        STATESET
+    };
+
+    struct Metric
+    {
+        const char * name;
+        Kind kind;
+        const char * unit;
+        const char * help;
+    };
+
+    static const Metric metrics[];
+    static const uint8_t metricCount;
+
+    void rewind();
+    bool render(); // next line into line[], false at the end
+    bool isAvailable(uint8_t metric) const;
+    uint8_t sampleCount(uint8_t metric) const;
+    void renderSample(uint8_t metric, uint8_t sample);
+
+    void append(const char * text);
+    void append(char c);
+    void appendUnsigned(uint32_t value);
+    void appendFixed(uint32_t value, uint8_t decimals); // value / 10^decimals
+    void appendName(uint8_t metric);
+
+    const char * prefix;
+    const char * labels;
+    IP2366::AdcSnapshot adc;
+    IP2366::StatusSnapshot status;
+    IP2366::LockStats lockStats;
+    bool hasLockStats = false;
+    bool hasSampler = false;
+    uint32_t samples = 0;
+    uint8_t lastError = 0;
+
+    uint8_t metric = 0; // cursor: metric and line within it
+    uint8_t lineIndex = 0;
+    bool finished = true;
+    char line[IP2366_METRICS_LINE_SIZE];
+    uint8_t length = 0; // of line
+    uint8_t offset = 0; // already read from line
+};
+
+#endif
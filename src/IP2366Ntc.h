@@ -0,0 +1,100 @@
+#ifndef IP2366_NTC_H
+#define IP2366_NTC_H
+
+#include <stdint.h>
+
+// NTC resistance -> temperature conversion.
+// The resistance table for the given Beta/R25 is generated at compile time (the floating point math
+// below is constexpr only); at runtime a lookup is a binary search plus one integer interpolation.
+
+#define IP2366_NTC_MIN_C -40 // first table entry, degC
+#define IP2366_NTC_STEP_C 5  // table step, degC
+#define IP2366_NTC_POINTS 34 // -40 ... 125 degC
+
+// NTC resistance -> 0.1 degC, as taken by the thermal policy, the fault monitor and the source PDO manager,
+// e.g. IP2366Ntc<3950, 10000>::toDeciCelsius
+typedef int16_t (*IP2366NtcConverter)(uint32_t resistance_ohm);
+
+namespace IP2366NtcDetail
+{
+    template <int... I>
+    struct Sequence
+    {
+    };
+
+    template <int N, int... I>
+    struct MakeSequence : MakeSequence<N - 1, N - 1, I...>
+    {
+    };
+
+    template <int... I>
+    struct MakeSequence<0, I...>
+    {
+        typedef Sequence<I...> type;
+    };
+
+    constexpr double expSeries(double x, int n, double term, double sum)
+    {
+        return n > 20 ? sum : expSeries(x, n + 1, term * x / n, sum + term * x / n);
+    }
+
+    // exp(x) = exp(x / 2)^2 keeps the series argument small
+    constexpr double square(double x) { return x * x; }
+    constexpr double exp(double x)
+    {
+        return (x > 0.5 || x < -0.5) ? square(exp(x / 2)) : expSeries(x, 1, 1.0, 1.0);
+    }
+
+    constexpr uint32_t resistance(uint32_t beta, uint32_t r25, int celsius)
+    {
+        return (uint32_t)(r25 * exp(beta * (1.0 / (celsius + 273.15) - 1.0 / 298.15)) + 0.5);
+    }
+
+    template <uint32_t Beta, uint32_t R25, class S>
+    struct Table;
+
+    template <uint32_t Beta, uint32_t R25, int... I>
+    struct Table<Beta, R25, Sequence<I...>>
+    {
+        static constexpr uint32_t values[sizeof...(I)] = {resistance(Beta, R25, IP2366_NTC_MIN_C + I * IP2366_NTC_STEP_C)...};
+    };
+
+    template <uint32_t Beta, uint32_t R25, int... I>
+    constexpr uint32_t Table<Beta, R25, Sequence<I...>>::values[sizeof...(I)];
+}
+
+template <uint32_t Beta = 3950, uint32_t R25 = 10000>
+class IP2366Ntc
+{
+public:
+    typedef IP2366NtcDetail::Table<Beta, R25, typename IP2366NtcDetail::MakeSequence<IP2366_NTC_POINTS>::type> Table;
+
+    // Temperature in 0.1 degC, clamped to the table range
+    static int16_t toDeciCelsius(uint32_t resistance_ohm)
+    {
+        const uint32_t * table = Table::values;
+        if (resistance_ohm >= table[0])
+            return IP2366_NTC_MIN_C * 10;
+        if (resistance_ohm <= table[IP2366_NTC_POINTS - 1])
+            return (IP2366_NTC_MIN_C + (IP2366_NTC_POINTS - 1) * IP2366_NTC_STEP_C) * 10;
+
+        // table is descending: find table[low] > resistance >= table[low + 1]
+        uint8_t low = 0, high = IP2366_NTC_POINTS - 1;
+        while (high - low > 1)
+        {
+            uint8_t middle = (low + high) / 2;
+            if (table[middle] > resistance_ohm)
+                low = middle;
+            else
+                high = middle;
+        }
+
+        uint32_t span = table[low] - table[high];
+        uint32_t offset = (table[low] - resistance_ohm) * (IP2366_NTC_STEP_C * 10) / span;
+        return (IP2366_NTC_MIN_C + low * IP2366_NTC_STEP_C) * 10 + offset;
+    }
+
+    static constexpr uint32_t resistanceAt(int celsius) { return IP2366NtcDetail::resistance(Beta, R25, celsius); }
+};
+
+#endif
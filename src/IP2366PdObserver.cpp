@@ -0,0 +1,108 @@
+#include "IP2366PdObserver.h"
+#include "IP2366Platform.h"
+#include <string.h>
+
+static uint16_t elapsed(uint32_t from, uint32_t to)
+{
+    uint32_t value = to - from;
+    return value >= IP2366_PD_NO_CONTRACT ? IP2366_PD_NO_CONTRACT - 1 : value;
+}
+
+IP2366PdObserver::IP2366PdObserver(IP2366 & chip, uint16_t fastInterval_ms, uint16_t slowInterval_ms, uint16_t settleTime_ms)
+    : chip(chip), fastInterval(fastInterval_ms), slowInterval(slowInterval_ms), settleTime(settleTime_ms),
+      lastPoll(0), lastChange(0), polled(false), attached(false), negotiating(false), head(0), count(0),
+      callback(nullptr), context(nullptr)
+{
+    memset(&current, 0, sizeof(current));
+}
+
+bool IP2366PdObserver::update()
+{
+    uint32_t now = millis();
+    bool fast = negotiating || !attached; // an attach is only seen when polled, it must not wait a slow interval
+    if (polled && (uint32_t)(now - lastPoll) < (fast ? fastInterval : slowInterval))
+        return false;
+    lastPoll = now;
+    polled = true;
+
+    IP2366::StatusSnapshot status;
+    if (!chip.readStatusSnapshot(status))
+        return false;
+    return poll(status);
+}
+
+bool IP2366PdObserver::poll(const IP2366::StatusSnapshot & status)
+{
+    IP2366::SystemStatus system = status.getSystemStatus();
+    bool attachedNow = system.has(IP2366::SystemStatus::TYPEC_SINK | IP2366::SystemStatus::VBUS_PRESENT);
+    uint8_t voltage = system.chargeVoltage();
+    uint8_t receivedPdo = system.receivedPdo();
+    bool fastCharge = system.has(IP2366::SystemStatus::FAST_CHARGE);
+    bool qc = system.has(IP2366::SystemStatus::VBUS_SINK_QC);
+
+    if (!attached && attachedNow)
+    {
+        attached = true;
+        negotiating = true;
+        lastChange = status.timestamp;
+        current.attachTime = status.timestamp;
+        current.contractLatency = IP2366_PD_NO_CONTRACT;
+        current.voltageLatency = 0;
+        current.voltage = voltage;
+        current.receivedPdo = receivedPdo;
+        current.fastCharge = fastCharge;
+        current.qc = qc;
+    }
+    else if (attached && !attachedNow)
+    {
+        if (negotiating)
+            finish();
+        attached = false;
+        return true;
+    }
+
+    if (!negotiating)
+        return true;
+
+    if (system.has(IP2366::SystemStatus::TYPEC_SINK_PD) && current.contractLatency == IP2366_PD_NO_CONTRACT)
+    {
+        current.contractLatency = elapsed(current.attachTime, status.timestamp);
+        lastChange = status.timestamp;
+    }
+    if (voltage != current.voltage)
+    {
+        current.voltage = voltage;
+        current.voltageLatency = elapsed(current.attachTime, status.timestamp);
+        lastChange = status.timestamp;
+    }
+    if (receivedPdo != current.receivedPdo || fastCharge != current.fastCharge || qc != current.qc)
+    {
+        current.receivedPdo = receivedPdo;
+        current.fastCharge = fastCharge;
+        current.qc = qc;
+        lastChange = status.timestamp;
+    }
+
+    if ((uint32_t)(status.timestamp - lastChange) >= settleTime)
+        finish();
+    return true;
+}
+
+void IP2366PdObserver::finish()
+{
+    negotiating = false;
+    history[head] = current;
+    head = (head + 1) % IP2366_PD_HISTORY;
+    if (count < IP2366_PD_HISTORY)
+        count++;
+    if (callback != nullptr)
+        callback(current, context);
+}
+
+const IP2366PdObserver::Negotiation & IP2366PdObserver::getHistory(uint8_t index) const
+{
+    static const Negotiation empty = {0, 0, 0, 0, 0, false, false};
+    if (index >= count)
+        return empty;
+    return history[(head + IP2366_PD_HISTORY - 1 - index) % IP2366_PD_HISTORY];
+}
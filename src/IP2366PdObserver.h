@@ -0,0 +1,67 @@
+#ifndef IP2366_PD_OBSERVER_H
+#define IP2366_PD_OBSERVER_H
+
+#include "IP2366.h"
+
+#ifndef IP2366_PD_HISTORY
+#define IP2366_PD_HISTORY 8
+#endif
+
+#define IP2366_PD_NO_CONTRACT 0xFFFF
+
+// Watches input attach and PD/QC negotiation (TypeC_STATE, RECEIVED_PDO, STATE_CTL1/2).
+// update() polls fast while nothing is attached and while a negotiation is in progress, and slowly once the
+// negotiation has settled, so attach and the latencies are resolved to the fast interval. It keeps a history of
+// finished negotiations with their timing.
+class IP2366PdObserver
+{
+public:
+    struct Negotiation
+    {
+        uint32_t attachTime;        // millis() when Vbus/sink connection was first seen
+        uint16_t contractLatency;   // ms from attach to PD sink contract, IP2366_PD_NO_CONTRACT without PD
+        uint16_t voltageLatency;    // ms from attach to the last charging voltage change
+        uint8_t voltage;            // final charging voltage, V
+        uint8_t receivedPdo;        // RECEIVED_PDO bit mask (bit 0 - 5V ... bit 4 - 20V)
+        bool fastCharge;            // STATE_CTL1 high voltage fast charging
+        bool qc;                    // input QC fast charge
+    };
+
+    typedef void (*Callback)(const Negotiation & negotiation, void * context);
+
+    IP2366PdObserver(IP2366 & chip, uint16_t fastInterval_ms = 10, uint16_t slowInterval_ms = 500, uint16_t settleTime_ms = 1500);
+
+    bool update(); // call from loop(), returns true when the registers were polled
+    bool poll(const IP2366::StatusSnapshot & status); // feed a snapshot taken elsewhere
+
+    bool isNegotiating() const { return negotiating; };
+    bool isAttached() const { return attached; };
+    const Negotiation & getCurrent() const { return current; };
+
+    uint8_t getHistorySize() const { return count; };
+    const Negotiation & getHistory(uint8_t index) const; // 0 - most recent, a zeroed entry if index >= getHistorySize()
+    void clearHistory() { count = 0; };
+
+    void setCallback(Callback callback, void * context = nullptr) { this->callback = callback; this->context = context; };
+
+private:
+    void finish();
+
+    IP2366 & chip;
+    uint16_t fastInterval;
+    uint16_t slowInterval;
+    uint16_t settleTime;
+    uint32_t lastPoll;
+    uint32_t lastChange;
+    bool polled;
+    bool attached;
+    bool negotiating;
+    Negotiation current;
+    Negotiation history[IP2366_PD_HISTORY];
+    uint8_t head;
+    uint8_t count;
+    Callback callback;
+    void * context;
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "IP2366PeriodicSampler.h"
+#include "IP2366Platform.h"
+#include <string.h>
+
+#if defined(__linux__)
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+IP2366PeriodicSampler::IP2366PeriodicSampler(IP2366 & chip, uint32_t interval_ms)
+    : IP2366Sampler(chip, interval_ms), maxLateness(0), started(false), due(0), slot(0), lastSlot(0), lastStart(0),
+      hasLastStart(false)
+{
+    resetStats();
+#if defined(__linux__)
+    timerFd = -1;
+#endif
+}
+
+IP2366PeriodicSampler::~IP2366PeriodicSampler()
+{
+#if defined(__linux__)
+    if (timerFd >= 0)
+        close(timerFd);
+#endif
+}
+
+uint32_t IP2366PeriodicSampler::getMaxLateness() const
+{
+    return maxLateness ? maxLateness : getInterval() * 250;
+}
+
+void IP2366PeriodicSampler::resetStats()
+{
+    memset(&stats, 0, sizeof(stats));
+    hasLastStart = false;
+}
+
+void IP2366PeriodicSampler::start()
+{
+    due = micros();
+    slot = 0;
+    lastSlot = 0;
+    hasLastStart = false;
+    started = true;
+}
+
+bool IP2366PeriodicSampler::update()
+{
+    uint32_t now = micros();
+    if (!started)
+    {
+        start();
+        now = due;
+    }
+    int32_t late = (int32_t)(now - due);
+    if (late < 0)
+        return false;
+
+    // SECTION: skip the slots that can no longer be served in time
+    uint32_t period = getInterval() * 1000;
+    if (period == 0)
+        period = 1;
+    uint32_t behind = (uint32_t)late / period;
+    if ((uint32_t)late % period > getMaxLateness())
+        behind++; // the current slot is too late as well, wait for the next one
+    if (behind)
+    {
+        stats.missed += behind;
+        due += behind * period;
+        slot += behind;
+        if ((int32_t)(now - due) < 0)
+            return false;
+    }
+
+    // SECTION: sample
+    uint32_t begin = micros();
+    bool sampled = sample();
+    uint32_t end = micros();
+
+    uint32_t jitter = begin - due;
+    stats.totalJitter_us += jitter;
+    if (jitter > stats.maxJitter_us)
+        stats.maxJitter_us = jitter;
+    stats.lastTransaction_us = end - begin;
+    if (stats.lastTransaction_us > stats.maxTransaction_us)
+        stats.maxTransaction_us = stats.lastTransaction_us;
+
+    if (sampled)
+    {
+        if (hasLastStart)
+        {
+            uint32_t interval = begin - lastStart;
+            if (stats.minPeriod_us == 0 || interval < stats.minPeriod_us)
+                stats.minPeriod_us = interval;
+            if (interval > stats.maxPeriod_us)
+                stats.maxPeriod_us = interval;
+        }
+        lastStart = begin;
+        hasLastStart = true;
+        stats.samples++;
+    }
+    else
+    {
+        stats.errors++; // no retry within the slot, that would bunch the next sample
+    }
+
+    lastSlot = slot;
+    due += period;
+    slot++;
+    return sampled;
+}
+
+bool IP2366PeriodicSampler::wait()
+{
+    if (!started)
+        return update();
+
+    int32_t remaining = (int32_t)(due - micros());
+#if defined(__linux__)
+    if (timerFd < 0)
+        timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (remaining > 0 && timerFd >= 0)
+    {
+        itimerspec timer;
+        memset(&timer, 0, sizeof(timer));
+        timer.it_value.tv_sec = remaining / 1000000;
+        timer.it_value.tv_nsec = (long)(remaining % 1000000) * 1000;
+        uint64_t expirations;
+        if (timerfd_settime(timerFd, 0, &timer, nullptr) == 0 && read(timerFd, &expirations, sizeof(expirations)) == sizeof(expirations))
+            remaining = (int32_t)(due - micros());
+    }
+#endif
+    if (remaining >= 1000)
+        delay(remaining / 1000);
+    while ((int32_t)(due - micros()) > 0)
+        ; // sub-millisecond remainder
+    return update();
+}
@@ -0,0 +1,61 @@
+#ifndef IP2366_PERIODIC_SAMPLER_H
+#define IP2366_PERIODIC_SAMPLER_H
+
+#include "IP2366.h"
+#include "IP2366Sampler.h"
+
+// IP2366Sampler on a fixed time grid: slot n is due at start + n * interval on the micros() clock.
+// The next slot is computed from the grid, not from the end of the previous read, so transaction time and
+// bus errors do not make the period drift. A slot that can no longer be served within maxLateness is
+// skipped (counted as missed) instead of being sampled late, so samples never bunch up: consecutive samples
+// are always a whole number of intervals apart, give or take the jitter bound. getSlot() tells how many.
+// Drive it with update() from loop() (or after a hardware timer interrupt), or block in wait(), which sleeps
+// on a timerfd on Linux and on delay() elsewhere.
+class IP2366PeriodicSampler : public IP2366Sampler
+{
+public:
+    struct Stats
+    {
+        uint32_t samples;
+        uint32_t errors;              // slots whose read failed
+        uint32_t missed;              // slots skipped because they were due more than maxLateness ago
+        uint32_t minPeriod_us;        // between the starts of consecutive samples
+        uint32_t maxPeriod_us;
+        uint32_t maxJitter_us;        // sample start after its due time
+        uint64_t totalJitter_us;
+        uint32_t lastTransaction_us;  // duration of the bus reads
+        uint32_t maxTransaction_us;
+
+        uint32_t getMeanJitter() const { return samples + errors ? totalJitter_us / (samples + errors) : 0; }; // us
+    };
+
+    IP2366PeriodicSampler(IP2366 & chip, uint32_t interval_ms = 1000);
+    ~IP2366PeriodicSampler();
+
+    void setMaxLateness(uint32_t lateness_us) { maxLateness = lateness_us; }; // 0: a quarter of the interval
+    uint32_t getMaxLateness() const;
+
+    void start(); // restart the grid now, the first slot is due immediately
+    bool update(); // replaces IP2366Sampler::update(), true when a sample was taken
+    bool wait();   // sleep until the next slot is due, then update()
+
+    uint32_t getSlot() const { return lastSlot; };      // grid index of the last sample attempt
+    uint32_t getDueTime() const { return due; };        // micros() of the next slot
+    const Stats & getStats() const { return stats; };
+    void resetStats();
+
+private:
+    uint32_t maxLateness;
+    bool started;
+    uint32_t due;
+    uint32_t slot;
+    uint32_t lastSlot;
+    uint32_t lastStart;
+    bool hasLastStart;
+    Stats stats;
+#if defined(__linux__)
+    int timerFd;
+#endif
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef IP2366_PLATFORM_H
+#define IP2366_PLATFORM_H
+
+// Timing and GPIO functions used by the library.
+// On Arduino (or with IP2366_ARDUINO_API defined, when an Arduino API shim is supplied) they come from Arduino.h.
+// Otherwise a minimal POSIX implementation is used, so the sources build natively on a host or a Linux board
+// without any shim; Wire is not available there, pass a transport (IP2366LinuxI2CBus, IP2366SimBus, ...).
+// A host-side shim that defines IP2366_HOST_TIMING in its Arduino.h gets the POSIX timing below as well.
+#if defined(ARDUINO) || defined(IP2366_ARDUINO_API)
+
+#include <Arduino.h>
+#define IP2366_ARDUINO
+
+#endif
+
+#if !defined(IP2366_ARDUINO) || defined(IP2366_HOST_TIMING)
+
+#include <stdint.h>
+#include <time.h>
+
+#define IP2366_HOST
+
+// Time source of the host build. Without an installed clock millis()/micros() read CLOCK_MONOTONIC and
+// delay() sleeps; an installed clock (e.g. IP2366SimClock) replaces all three, so the driver runs on simulated time.
+class IP2366Clock
+{
+public:
+    virtual uint64_t now_us() = 0;
+    virtual void sleep_us(uint32_t us) = 0;
+
+    static IP2366Clock *& active()
+    {
+        static IP2366Clock * clock = nullptr;
+        return clock;
+    }
+
+protected:
+    ~IP2366Clock() {}
+};
+
+inline unsigned long micros()
+{
+    IP2366Clock * clock = IP2366Clock::active();
+    if (clock != nullptr)
+        return (unsigned long)clock->now_us();
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)now.tv_sec * 1000000UL + now.tv_nsec / 1000;
+}
+
+inline unsigned long millis()
+{
+    IP2366Clock * clock = IP2366Clock::active();
+    if (clock != nullptr)
+        return (unsigned long)(clock->now_us() / 1000);
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)now.tv_sec * 1000UL + now.tv_nsec / 1000000;
+}
+
+inline void delay(unsigned long ms)
+{
+    IP2366Clock * clock = IP2366Clock::active();
+    if (clock != nullptr)
+    {
+        clock->sleep_us(ms * 1000);
+        return;
+    }
+    timespec duration;
+    duration.tv_sec = ms / 1000;
+    duration.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&duration, nullptr);
+}
+
+#endif
+
+#ifndef IP2366_ARDUINO
+
+#ifndef HIGH
+#define HIGH 1
+#endif
+#ifndef LOW
+#define LOW 0
+#endif
+#ifndef OUTPUT
+#define OUTPUT 1
+#endif
+
+// No GPIO off-target: the INT pin must be driven by the application
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+
+#endif
+
+#endif
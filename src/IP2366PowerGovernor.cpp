@@ -0,0 +1,106 @@
+#include "IP2366PowerGovernor.h"
+
+bool IP2366PowerGovernor::update()
+{
+    IP2366::AdcSnapshot adc;
+    IP2366::StatusSnapshot status;
+    if (!chip.readAdcSnapshot(adc) || !chip.readStatusSnapshot(status))
+        return false;
+    return update(adc, status);
+}
+
+void IP2366PowerGovernor::onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * governor)
+{
+    static_cast<IP2366PowerGovernor *>(governor)->update(adc, status);
+}
+
+bool IP2366PowerGovernor::update(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status)
+{
+    uint8_t errorCode = 0;
+    bool written = false;
+
+    if (!known)
+    {
+        currentLimit = chip.getMaxInputPowerOrBatteryCurrent(&errorCode);
+        if (errorCode)
+            return false;
+        known = true;
+        lastAdjust = adc.timestamp - config.interval_ms;
+    }
+
+    if (config.governOutputPower)
+    {
+        IP2366::Vbus1OutputPower power = outputPowerFor(config.budget_mW);
+        if (!outputKnown || power != outputPower)
+        {
+            chip.setMaxOutputPower(power, &errorCode);
+            outputKnown = errorCode == 0;
+            outputPower = power;
+            writes++;
+            written = true;
+        }
+    }
+
+    if ((uint32_t)(adc.timestamp - lastAdjust) < config.interval_ms)
+        return written;
+
+    uint32_t power = adc.VsysPower;
+    uint32_t target = currentLimit;
+
+    if (power > config.budget_mW + config.hysteresis_mW)
+        target = (uint32_t)currentLimit * config.budget_mW / power;
+    else if (power + config.hysteresis_mW < config.budget_mW &&
+             status.getSystemStatus().has(IP2366::SystemStatus::CHARGING) &&
+             (uint32_t)adc.BATCurrent * 10 >= (uint32_t)currentLimit * 9) // only raise a limit that actually binds
+        target = power ? (uint32_t)currentLimit * config.budget_mW / power : ceiling();
+
+    if (target > ceiling())
+        target = ceiling();
+    if (target < config.minCurrent_mA)
+        target = config.minCurrent_mA;
+
+    if (target > (uint32_t)currentLimit + config.maxStep_mA)
+        target = currentLimit + config.maxStep_mA;
+    else if (target + config.maxStep_mA < currentLimit)
+        target = currentLimit - config.maxStep_mA;
+
+    target -= target % 100; // SYS_CTL3 has 100 mA steps
+
+    if (target != currentLimit)
+    {
+        chip.setMaxInputPowerOrBatteryCurrent(target, &errorCode);
+        if (errorCode)
+        {
+            known = false;
+            return written;
+        }
+        currentLimit = target;
+        lastAdjust = adc.timestamp;
+        writes++;
+        written = true;
+    }
+    return written;
+}
+
+uint16_t IP2366PowerGovernor::ceiling() const
+{
+    uint32_t value = (uint32_t)config.maxCurrent_mA * config.derating / 100;
+    if (value > 9700)
+        value = 9700;
+    return value < config.minCurrent_mA ? config.minCurrent_mA : value;
+}
+
+IP2366::Vbus1OutputPower IP2366PowerGovernor::outputPowerFor(uint32_t budget_mW)
+{
+    if (budget_mW >= 140000)
+        return IP2366::Vbus1OutputPower::W140;
+    if (budget_mW >= 100000)
+        return IP2366::Vbus1OutputPower::W100;
+    if (budget_mW >= 65000)
+        return IP2366::Vbus1OutputPower::W65;
+    if (budget_mW >= 60000)
+        return IP2366::Vbus1OutputPower::W60;
+    if (budget_mW >= 45000)
+        return IP2366::Vbus1OutputPower::W45;
+    return IP2366::Vbus1OutputPower::W30;
+}
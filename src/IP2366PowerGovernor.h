@@ -0,0 +1,58 @@
+#ifndef IP2366_POWER_GOVERNOR_H
+#define IP2366_POWER_GOVERNOR_H
+
+#include "IP2366.h"
+
+// Closed-loop charge current governor.
+// Keeps Vsys power at or below a power budget by adjusting SYS_CTL3 (charge current limit),
+// with a dead band (hysteresis), a limited step per update and a minimum time between writes.
+// Optionally also selects the highest Vbus1 output power level that fits in the budget.
+// Thermal derating is left to IP2366ThermalPolicy (setGovernor()), which lowers the ceiling through setDerating().
+class IP2366PowerGovernor
+{
+public:
+    struct Config
+    {
+        uint32_t budget_mW = 30000;       // target Vsys power
+        uint32_t hysteresis_mW = 1500;    // no adjustment while |power - budget| is below this
+        uint16_t minCurrent_mA = 500;
+        uint16_t maxCurrent_mA = 9700;
+        uint16_t maxStep_mA = 500;        // largest change per adjustment
+        uint16_t interval_ms = 1000;      // minimum time between adjustments
+        uint8_t derating = 100;           // % of maxCurrent_mA allowed (thermal derating)
+        bool governOutputPower = false;   // also manage SYS_CTL12
+    };
+
+    IP2366PowerGovernor(IP2366 & chip) : chip(chip) {};
+
+    void setConfig(const Config & config) { this->config = config; };
+    const Config & getConfig() const { return config; };
+    void setBudget(uint32_t budget_mW) { config.budget_mW = budget_mW; };
+    void setDerating(uint8_t percent) { config.derating = percent > 100 ? 100 : percent; };
+
+    bool update(); // call from loop(), returns true when a register was written
+    bool update(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status); // same, with snapshots taken elsewhere
+    void invalidate() { known = false; };           // re-read the limit, e.g. after a chip reset
+
+    // IP2366Sampler callback: sampler.subscribe(IP2366PowerGovernor::onSample, &governor)
+    static void onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * governor);
+
+    uint16_t getCurrentLimit() const { return currentLimit; }; // mA, last value written or read
+    uint32_t getWrites() const { return writes; };
+
+    static IP2366::Vbus1OutputPower outputPowerFor(uint32_t budget_mW);
+
+private:
+    uint16_t ceiling() const;
+
+    IP2366 & chip;
+    Config config;
+    bool known = false;
+    bool outputKnown = false;
+    uint16_t currentLimit = 0;
+    IP2366::Vbus1OutputPower outputPower = IP2366::Vbus1OutputPower::W30;
+    uint32_t lastAdjust = 0;
+    uint32_t writes = 0;
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef IP2366_REGISTERS_H
+#define IP2366_REGISTERS_H
+
+// IP2366 register map, shared by IP2366 and StaticIP2366
+
+// System Control Registers
+#define IP2366_REG_SYS_CTL0 0x00  // Charge enable and other control settings
+#define IP2366_REG_SYS_CTL2 0x02  // Vset full-charge voltage setting
+#define IP2366_REG_SYS_CTL3 0x03  // Iset charge power or current setting
+#define IP2366_REG_SYS_CTL4 0x04  // Battery capacity setting
+#define IP2366_REG_SYS_CTL6 0x06  // Trickle charge current, threshold and charge timeout setting
+#define IP2366_REG_SYS_CTL8 0x08  // Stop charge current and recharge threshold setting
+#define IP2366_REG_SYS_CTL9 0x09  // Standby enable and low battery voltage settings
+#define IP2366_REG_SYS_CTL10 0x0A // Low battery voltage setting
+#define IP2366_REG_SYS_CTL11 0x0B // Output enable register
+#define IP2366_REG_SYS_CTL12 0x0C // Output maximum power selection register
+
+// TYPE-C Control Registers
+#define IP2366_REG_SELECT_PDO 0x0D  // select charging PDO gear
+#define IP2366_CONFIG_BLOCK_SIZE (IP2366_REG_SELECT_PDO - IP2366_REG_SYS_CTL0 + 1) // SYS_CTL0 - SELECT_PDO
+#define IP2366_REG_TypeC_CTL8 0x22  // TYPE-C mode control register
+#define IP2366_REG_TypeC_CTL9 0x23  // Output Pdo current setting register
+#define IP2366_REG_TypeC_CTL10 0x24 // 5VPdo current setting register
+#define IP2366_REG_TypeC_CTL11 0x25 // 9VPdo current setting register
+#define IP2366_REG_TypeC_CTL12 0x26 // 12VPdo current setting register
+#define IP2366_REG_TypeC_CTL13 0x27 // 15VPdo current setting register
+#define IP2366_REG_TypeC_CTL14 0x28 // 20VPdo current setting register
+#define IP2366_REG_TypeC_CTL17 0x2B // Output Pdo setting register
+#define IP2366_REG_TypeC_CTL23 0x29 // Pps1 Pdo current setting register
+#define IP2366_REG_TypeC_CTL24 0x2A // Pps2 Pdo current setting register
+#define IP2366_SRC_PDO_BLOCK_SIZE (IP2366_REG_TypeC_CTL17 - IP2366_REG_TypeC_CTL9 + 1) // TypeC_CTL9 - TypeC_CTL17
+#define IP2366_REG_TypeC_CTL18 0x2C // PDO plus 10mA current enable, needs to be configured together with the current setting register
+
+// Read-only Status Indication Registers
+#define IP2366_REG_STATE_CTL0 0x31   // Charge status control register
+#define IP2366_REG_STATE_CTL1 0x32   // Charge status control register 2
+#define IP2366_REG_STATE_CTL2 0x33   // Input Pd status control register
+#define IP2366_REG_TypeC_STATE 0x34  // System status indication register
+#define IP2366_REG_RECEIVED_PDO 0x35 // receive PDO gear
+#define IP2366_REG_STATE_CTL3 0x38   // System over-current indication register
+
+// ADC Data Registers
+#define IP2366_REG_BATVADC_DAT0 0x50         // VBAT voltage low 8 bits
+#define IP2366_REG_BATVADC_DAT1 0x51         // VBAT voltage high 8 bits
+#define IP2366_REG_VsysVADC_DAT0 0x52        // Vsys voltage low 8 bits
+#define IP2366_REG_VsysVADC_DAT1 0x53        // Vsys voltage high 8 bits
+#define IP2366_REG_TIMENODE1 0x69            // 1st bit of the timestamp register (the timestamp symbol is an ASCII character)
+#define IP2366_REG_TIMENODE2 0x6A            // 2nd bit of the timestamp register (the timestamp symbol is an ASCII character)
+#define IP2366_REG_TIMENODE3 0x6B            // 3rd bit of the timestamp register (the timestamp symbol is an ASCII character)
+#define IP2366_REG_TIMENODE4 0x6C            // 4th bit of the timestamp register (the timestamp symbol is an ASCII character)
+#define IP2366_REG_TIMENODE5 0x6D            // 4th bit of the timestamp register (the timestamp symbol is an ASCII character)
+#define IP2366_REG_IBATIADC_DAT0 0x6E        // BAT-end current low 8 bits
+#define IP2366_REG_IBATIADC_DAT1 0x6F        // BAT-end current high 8 bits
+#define IP2366_REG_ISYS_IADC_DAT0 0x70       // IVsys-end current low 8 bits
+#define IP2366_REG_IVsys_IADC_DAT1 0x71      // IVsys-end current high 8 bits
+#define IP2366_REG_Vsys_POW_DAT0 0x74        // Vsysterminal power low 8 bits
+#define IP2366_REG_Vsys_POW_DAT1 0x75        // Vsysterminal power high 8 bits
+
+// Additional ADC Data Registers for NTC, GPIOs
+#define IP2366_REG_INTC_IADC_DAT0 0x77     // NTC output current setting
+#define IP2366_REG_VGPIO0_NTC_DAT0 0x78    // VGPIO0_NTC ADC voltage low 8 bits
+#define IP2366_REG_VGPIO0_NTC_DAT1 0x79    // VGPIO0_NTC ADC voltage high 8 bits
+
+// Full-scale 16 bit code to mV; the VGPIO0_NTC registers already read in mV and need no conversion
+#define IP2366_ADC_TO_MV(adc_val) ((uint16_t)((((uint32_t)(adc_val) * 3300) / 0xFFFF)))
+
+#endif
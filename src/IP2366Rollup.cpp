@@ -0,0 +1,187 @@
+#include "IP2366Rollup.h"
+#include <string.h>
+
+static const uint16_t capacities[IP2366Rollup::TIERS] = {IP2366_ROLLUP_RAW, IP2366_ROLLUP_SECONDS, IP2366_ROLLUP_MINUTES, IP2366_ROLLUP_HOURS};
+static const uint16_t offsets[IP2366Rollup::TIERS] = {0, IP2366_ROLLUP_RAW, IP2366_ROLLUP_RAW + IP2366_ROLLUP_SECONDS,
+                                                      IP2366_ROLLUP_RAW + IP2366_ROLLUP_SECONDS + IP2366_ROLLUP_MINUTES};
+static const uint32_t durations[IP2366Rollup::TIERS] = {0, 1000UL, 60000UL, 3600000UL};
+
+void IP2366Rollup::clear()
+{
+    memset(heads, 0, sizeof(heads));
+    memset(counts, 0, sizeof(counts));
+    memset(wrapped, 0, sizeof(wrapped));
+    memset(open, 0, sizeof(open));
+}
+
+uint32_t IP2366Rollup::getDuration(uint8_t tier)
+{
+    return tier < TIERS ? durations[tier] : 0;
+}
+
+void IP2366Rollup::onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * rollup)
+{
+    static_cast<IP2366Rollup *>(rollup)->add(adc, status);
+}
+
+// Insert
+
+void IP2366Rollup::add(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status)
+{
+    int16_t values[CHANNELS];
+    values[VBAT] = adc.VBATVoltage > 32767 ? 32767 : adc.VBATVoltage;
+    int32_t current = adc.BATCurrent > 32767 ? 32767 : adc.BATCurrent;
+    values[IBAT] = status.getSystemStatus().has(IP2366::SystemStatus::DISCHARGING) ? -current : current;
+    uint32_t power = adc.VsysPower / 10;
+    values[POWER] = power > 32767 ? 32767 : power;
+    add(adc.timestamp, values);
+}
+
+void IP2366Rollup::add(uint32_t timestamp, const int16_t values[CHANNELS])
+{
+    Bucket sample;
+    sample.start = timestamp;
+    sample.count = 1;
+    for (uint8_t c = 0; c < CHANNELS; c++)
+        sample.channels[c].min = sample.channels[c].max = sample.channels[c].mean = sample.channels[c].last = values[c];
+    push(RAW, sample);
+    feed(SECONDS, sample);
+}
+
+void IP2366Rollup::push(uint8_t tier, const Bucket & bucket)
+{
+    buckets[offsets[tier] + heads[tier]] = bucket;
+    if (++heads[tier] == capacities[tier])
+        heads[tier] = 0;
+    if (counts[tier] < capacities[tier])
+        counts[tier]++;
+    else
+        wrapped[tier] = true;
+}
+
+// Adds a bucket of the tier below to the open bucket of tier, closing that first when the new one starts a new period
+void IP2366Rollup::feed(uint8_t tier, const Bucket & bucket)
+{
+    Accumulator & accumulator = open[tier - 1];
+    uint32_t start = bucket.start - bucket.start % durations[tier];
+    if (accumulator.count && accumulator.start != start)
+    {
+        Bucket closed;
+        close(accumulator, closed);
+        push(tier, closed);
+        if (tier + 1 < TIERS)
+            feed(tier + 1, closed);
+        accumulator.count = 0;
+    }
+    if (!accumulator.count)
+        accumulator.start = start;
+    merge(accumulator, bucket);
+}
+
+void IP2366Rollup::merge(Accumulator & accumulator, const Bucket & bucket)
+{
+    if (!bucket.count)
+        return;
+    for (uint8_t c = 0; c < CHANNELS; c++)
+    {
+        const Stat & stat = bucket.channels[c];
+        if (!accumulator.count)
+        {
+            accumulator.min[c] = stat.min;
+            accumulator.max[c] = stat.max;
+            accumulator.sum[c] = 0;
+        }
+        if (stat.min < accumulator.min[c])
+            accumulator.min[c] = stat.min;
+        if (stat.max > accumulator.max[c])
+            accumulator.max[c] = stat.max;
+        accumulator.sum[c] += (int64_t)stat.mean * bucket.count;
+        accumulator.last[c] = stat.last;
+    }
+    accumulator.count += bucket.count;
+}
+
+void IP2366Rollup::close(const Accumulator & accumulator, Bucket & bucket)
+{
+    memset(&bucket, 0, sizeof(bucket));
+    bucket.start = accumulator.start;
+    bucket.count = accumulator.count;
+    if (!accumulator.count)
+        return;
+    for (uint8_t c = 0; c < CHANNELS; c++)
+    {
+        Stat & stat = bucket.channels[c];
+        stat.min = accumulator.min[c];
+        stat.max = accumulator.max[c];
+        stat.mean = accumulator.sum[c] / (int64_t)accumulator.count;
+        stat.last = accumulator.last[c];
+    }
+}
+
+// Queries
+
+const IP2366Rollup::Bucket & IP2366Rollup::at(uint8_t tier, uint16_t index) const
+{
+    uint16_t position = heads[tier] + capacities[tier] - counts[tier] + index;
+    if (position >= capacities[tier])
+        position -= capacities[tier];
+    return buckets[offsets[tier] + position];
+}
+
+bool IP2366Rollup::get(uint8_t tier, uint16_t index, Bucket & bucket) const
+{
+    if (tier >= TIERS || index >= counts[tier])
+        return false;
+    bucket = at(tier, index);
+    return true;
+}
+
+bool IP2366Rollup::overlaps(uint32_t start, uint32_t duration, uint32_t from, uint32_t to)
+{
+    return start < to && start + (duration ? duration : 1) > from;
+}
+
+uint8_t IP2366Rollup::selectTier(uint32_t from) const
+{
+    for (uint8_t tier = RAW; tier < TIERS; tier++)
+    {
+        if (!wrapped[tier] || at(tier, 0).start <= from)
+            return tier;
+    }
+    return HOURS; // range starts before the history, return what is left
+}
+
+uint8_t IP2366Rollup::query(uint32_t from, uint32_t to, Bucket & result) const
+{
+    uint8_t tier = selectTier(from);
+    Accumulator accumulator;
+    memset(&accumulator, 0, sizeof(accumulator));
+    uint32_t first = 0;
+
+    for (uint16_t i = 0; i < counts[tier]; i++)
+    {
+        const Bucket & bucket = at(tier, i);
+        if (!overlaps(bucket.start, durations[tier], from, to))
+            continue;
+        if (!accumulator.count)
+            first = bucket.start;
+        merge(accumulator, bucket);
+    }
+
+    // Newer data not closed into this tier yet, oldest (coarsest) first; RAW holds everything itself
+    for (uint8_t t = tier; t >= SECONDS; t--)
+    {
+        const Accumulator & pending = open[t - 1];
+        if (!pending.count || !overlaps(pending.start, durations[t], from, to))
+            continue;
+        Bucket bucket;
+        close(pending, bucket);
+        if (!accumulator.count)
+            first = bucket.start;
+        merge(accumulator, bucket);
+    }
+
+    close(accumulator, result);
+    result.start = first;
+    return tier;
+}
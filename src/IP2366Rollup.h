@@ -0,0 +1,107 @@
+#ifndef IP2366_ROLLUP_H
+#define IP2366_ROLLUP_H
+
+#include <stdint.h>
+
+#include "IP2366.h"
+
+// Buckets kept per tier, 32 bytes each (6.5 KB with the defaults)
+#ifndef IP2366_ROLLUP_RAW
+#define IP2366_ROLLUP_RAW 16     // last samples
+#endif
+#ifndef IP2366_ROLLUP_SECONDS
+#define IP2366_ROLLUP_SECONDS 60 // last minute
+#endif
+#ifndef IP2366_ROLLUP_MINUTES
+#define IP2366_ROLLUP_MINUTES 60 // last hour
+#endif
+#ifndef IP2366_ROLLUP_HOURS
+#define IP2366_ROLLUP_HOURS 72   // last three days
+#endif
+
+// Multi-resolution history of VBAT, signed IBAT and Vsys power in fixed, preallocated rings:
+// raw samples -> 1 s -> 1 min -> 1 h buckets, each with min/max/mean/last per channel.
+// A sample goes into the raw ring and the open 1 s bucket; a bucket that closes is stored in its ring and
+// folded into the open bucket of the next tier, so an insert costs at most one merge per tier.
+// Queries use the finest tier that still holds the start of the range, plus the still open buckets.
+// Times are millis(), ranges are [from, to).
+class IP2366Rollup
+{
+public:
+    enum Channel
+    {
+        VBAT = 0,  // mV
+        IBAT = 1,  // mA, negative while discharging
+        POWER = 2, // Vsys power, 10 mW
+        CHANNELS = 3
+    };
+
+    enum Tier
+    {
+        RAW = 0,
+        SECONDS = 1,
+        MINUTES = 2,
+        HOURS = 3,
+        TIERS = 4
+    };
+
+    struct Stat
+    {
+        int16_t min;
+        int16_t max;
+        int16_t mean;
+        int16_t last;
+    };
+
+    struct Bucket
+    {
+        uint32_t start; // millis() of the sample or the tier-aligned bucket start
+        uint32_t count; // samples
+        Stat channels[CHANNELS];
+    };
+
+    IP2366Rollup() { clear(); };
+
+    void add(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status);
+    void add(uint32_t timestamp, const int16_t values[CHANNELS]); // timestamps must not go back
+    void clear();
+
+    // IP2366Sampler callback: sampler.subscribe(IP2366Rollup::onSample, &rollup)
+    static void onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * rollup);
+
+    static uint32_t getDuration(uint8_t tier); // ms, 0 for RAW
+
+    // Closed buckets of one tier, oldest first (e.g. to upload the hour tier)
+    uint16_t getCount(uint8_t tier) const { return tier < TIERS ? counts[tier] : 0; };
+    bool get(uint8_t tier, uint16_t index, Bucket & bucket) const;
+
+    uint8_t selectTier(uint32_t from) const;
+    uint8_t query(uint32_t from, uint32_t to, Bucket & result) const; // aggregate of the range, returns the tier used; result.count is 0 if empty
+
+private:
+    struct Accumulator
+    {
+        uint32_t start;
+        uint32_t count;
+        int16_t min[CHANNELS];
+        int16_t max[CHANNELS];
+        int16_t last[CHANNELS];
+        int64_t sum[CHANNELS];
+    };
+
+    static void merge(Accumulator & accumulator, const Bucket & bucket);
+    static void close(const Accumulator & accumulator, Bucket & bucket);
+    static bool overlaps(uint32_t start, uint32_t duration, uint32_t from, uint32_t to);
+
+    void push(uint8_t tier, const Bucket & bucket);
+    void feed(uint8_t tier, const Bucket & bucket);
+    const Bucket & at(uint8_t tier, uint16_t index) const;
+
+    Bucket buckets[IP2366_ROLLUP_RAW + IP2366_ROLLUP_SECONDS + IP2366_ROLLUP_MINUTES + IP2366_ROLLUP_HOURS];
+    uint16_t heads[TIERS];  // next write position
+    uint16_t counts[TIERS];
+    bool wrapped[TIERS];    // older buckets were overwritten
+    Accumulator open[TIERS - 1]; // open bucket of SECONDS..HOURS
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "IP2366Sampler.h"
+#include "IP2366Platform.h"
+#include <string.h>
+
+IP2366Sampler::IP2366Sampler(IP2366 & chip, uint32_t interval_ms)
+    : chip(chip), interval(interval_ms), lastSample(0), valid(false), lastError(0), sequence(0)
+{
+    memset(&adc, 0, sizeof(adc));
+    memset(&status, 0, sizeof(status));
+    memset(subscribers, 0, sizeof(subscribers));
+}
+
+bool IP2366Sampler::update()
+{
+    uint32_t now = millis();
+    if (sequence != 0 && (uint32_t)(now - lastSample) < interval)
+        return false;
+    lastSample = now;
+    return sample();
+}
+
+bool IP2366Sampler::sample()
+{
+    IP2366::AdcSnapshot newAdc;
+    IP2366::StatusSnapshot newStatus;
+    uint8_t errorCode = 0;
+
+    if (!chip.readStatusSnapshot(newStatus, &errorCode) || !chip.readAdcSnapshot(newAdc, &errorCode))
+    {
+        lastError = errorCode;
+        return false;
+    }
+    lastError = 0;
+
+    bool statusChanged = !valid || !statusEquals(status, newStatus);
+    adc = newAdc;
+    status = newStatus;
+    valid = true;
+    sequence++;
+
+    for (uint8_t i = 0; i < IP2366_SAMPLER_MAX_SUBSCRIBERS; i++)
+    {
+        const Subscriber & subscriber = subscribers[i];
+        if (subscriber.callback == nullptr || (subscriber.statusChangesOnly && !statusChanged))
+            continue;
+        subscriber.callback(adc, status, subscriber.context);
+    }
+    return true;
+}
+
+bool IP2366Sampler::subscribe(Callback callback, void * context, bool statusChangesOnly)
+{
+    for (uint8_t i = 0; i < IP2366_SAMPLER_MAX_SUBSCRIBERS; i++)
+    {
+        if (subscribers[i].callback == nullptr)
+        {
+            subscribers[i].callback = callback;
+            subscribers[i].context = context;
+            subscribers[i].statusChangesOnly = statusChangesOnly;
+            return true;
+        }
+    }
+    return false;
+}
+
+void IP2366Sampler::unsubscribe(Callback callback, void * context)
+{
+    for (uint8_t i = 0; i < IP2366_SAMPLER_MAX_SUBSCRIBERS; i++)
+    {
+        if (subscribers[i].callback == callback && subscribers[i].context == context)
+            subscribers[i].callback = nullptr;
+    }
+}
+
+bool IP2366Sampler::statusEquals(const IP2366::StatusSnapshot & a, const IP2366::StatusSnapshot & b)
+{
+    return a.getSystemStatus() == b.getSystemStatus(); // reserved bits are ignored
+}
@@ -0,0 +1,57 @@
+#ifndef IP2366_SAMPLER_H
+#define IP2366_SAMPLER_H
+
+#include "IP2366.h"
+
+#ifndef IP2366_SAMPLER_MAX_SUBSCRIBERS
+#define IP2366_SAMPLER_MAX_SUBSCRIBERS 4
+#endif
+
+// Single bus poller for any number of readers.
+// update() takes one batched ADC + status sample per interval and caches it;
+// readers get the cached snapshots without touching the bus, subscribers are notified on every sample
+// (or only when a status register changes).
+class IP2366Sampler
+{
+public:
+    typedef void (*Callback)(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * context);
+
+    IP2366Sampler(IP2366 & chip, uint32_t interval_ms = 1000);
+
+    bool update(); // call from loop(), returns true when a new sample was taken
+    bool sample(); // take a sample right now
+
+    void setInterval(uint32_t interval_ms) { interval = interval_ms; };
+    uint32_t getInterval() const { return interval; };
+
+    const IP2366::AdcSnapshot & getAdc() const { return adc; };
+    const IP2366::StatusSnapshot & getStatus() const { return status; };
+    bool isValid() const { return valid; };            // at least one successful sample
+    uint8_t getLastError() const { return lastError; }; // error code of the last sample attempt
+    uint32_t getSequence() const { return sequence; };  // number of successful samples
+
+    bool subscribe(Callback callback, void * context = nullptr, bool statusChangesOnly = false);
+    void unsubscribe(Callback callback, void * context = nullptr);
+
+private:
+    struct Subscriber
+    {
+        Callback callback;
+        void * context;
+        bool statusChangesOnly;
+    };
+
+    static bool statusEquals(const IP2366::StatusSnapshot & a, const IP2366::StatusSnapshot & b);
+
+    IP2366 & chip;
+    uint32_t interval;
+    uint32_t lastSample;
+    IP2366::AdcSnapshot adc;
+    IP2366::StatusSnapshot status;
+    bool valid;
+    uint8_t lastError;
+    uint32_t sequence;
+    Subscriber subscribers[IP2366_SAMPLER_MAX_SUBSCRIBERS];
+};
+
+#endif
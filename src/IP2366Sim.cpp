@@ -0,0 +1,225 @@
+#include "IP2366Sim.h"
+#include "IP2366Platform.h"
+#include "IP2366Registers.h"
+#include <string.h>
+
+#define IP2366_SIM_STATE_CTL3_W1C 0x30 // Vsys over-current and short circuit, write 1 to clear
+
+// Register map
+
+IP2366SimBus::IP2366SimBus(uint8_t address, uint32_t clock_hz) : address(address), clock(clock_hz)
+{
+    reset();
+}
+
+void IP2366SimBus::reset()
+{
+    memset(registers, 0, sizeof(registers));
+    asleep = false;
+    cutNextRead = false;
+    resetting = false;
+}
+
+void IP2366SimBus::resetRegisters()
+{
+    for (uint16_t reg = 0; reg < sizeof(registers); reg++)
+    {
+        if (!isReadOnly(reg) && reg != IP2366_REG_STATE_CTL3)
+            registers[reg] = 0;
+    }
+    resetting = resetTime > 0;
+    resetStart = millis();
+}
+
+bool IP2366SimBus::isBusy()
+{
+    if (resetting && (uint32_t)(millis() - resetStart) >= resetTime)
+        resetting = false;
+    return resetting;
+}
+
+void IP2366SimBus::setRegister(uint8_t regAddress, uint8_t value, uint8_t mask)
+{
+    registers[regAddress] = (registers[regAddress] & ~mask) | (value & mask);
+}
+
+void IP2366SimBus::setRegister16(uint8_t regAddress, uint16_t value)
+{
+    registers[regAddress] = value;
+    registers[(uint8_t)(regAddress + 1)] = value >> 8;
+}
+
+bool IP2366SimBus::isReadOnly(uint8_t regAddress)
+{
+    return (regAddress >= 0x31 && regAddress <= 0x37) || // status registers
+           (regAddress >= 0x50 && regAddress <= 0x53) || // VBAT, Vsys ADC
+           (regAddress >= 0x69 && regAddress <= 0x76) || // TIMENODE, current and power ADC
+           regAddress == 0x78 || regAddress == 0x79;     // VGPIO0_NTC ADC
+}
+
+void IP2366SimBus::account(uint16_t bits)
+{
+    uint32_t time = (uint32_t)bits * 1000000 / clock;
+    stats.busTime_us += time;
+#ifdef IP2366_HOST
+    if (simClock != nullptr)
+        simClock->sleep_us(time);
+#endif
+}
+
+// Bus
+
+uint8_t IP2366SimBus::writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length)
+{
+    stats.writes++;
+    account(1 + 9 * (2 + length) + 1); // start, address, register, data, stop
+
+    if (address != this->address || asleep || isBusy())
+    {
+        stats.nacks++;
+        return 2;
+    }
+
+    stats.bytes += length;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        uint8_t reg = regAddress + i;
+        if (reg == IP2366_REG_SYS_CTL0 && (data[i] & 0x40))
+        {
+            resetRegisters(); // En_RESETMCU, the rest of the burst is lost
+            return 0;
+        }
+        if (reg == IP2366_REG_STATE_CTL3)
+            registers[reg] &= ~(data[i] & IP2366_SIM_STATE_CTL3_W1C);
+        else if (!isReadOnly(reg))
+            registers[reg] = data[i];
+    }
+    return 0;
+}
+
+uint8_t IP2366SimBus::readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length)
+{
+    stats.reads++;
+    account(1 + 9 * 2 + 1 + 9 * (1 + length) + 1); // start, address, register, repeated start, address, data, stop
+
+    if (address != this->address || asleep || isBusy())
+    {
+        stats.nacks++;
+        memset(data, 0xFF, length);
+        return 2;
+    }
+
+    if (cutNextRead)
+    {
+        // the chip stops clocking out data part way through the burst, same result as a short Wire read
+        cutNextRead = false;
+        asleep = true;
+        stats.nacks++;
+        memset(data, 0, length);
+        return 4;
+    }
+
+    stats.bytes += length;
+    for (uint8_t i = 0; i < length; i++)
+        data[i] = registers[(uint8_t)(regAddress + i)];
+    return 0;
+}
+
+// Scenarios
+
+const IP2366Scenario::Step IP2366Scenario::pdAttach20V[] = {
+    {0, Action::SET, 0x34, 0x80, 0xFF},    // TypeC_STATE: Sink_Ok
+    {0, Action::SET, 0x33, 0x82, 0xFF},    // STATE_CTL2: Vbus_Ok, 5 V
+    {0, Action::SET16, 0x52, 5000, 0},     // Vsys 5 V
+    {150, Action::SET, 0x34, 0x90, 0xFF},  // Sink_Pd_Ok
+    {150, Action::SET, 0x35, 0x1F, 0xFF},  // RECEIVED_PDO: 5 V - 20 V
+    {350, Action::SET, 0x33, 0x87, 0xFF},  // 20 V
+    {350, Action::SET, 0x32, 0x40, 0xFF},  // STATE_CTL1: fast charge
+    {350, Action::SET16, 0x52, 20000, 0},  // Vsys 20 V
+    {400, Action::SET, 0x31, 0x22, 0xFF},  // STATE_CTL0: charging, constant current
+    {400, Action::SET16, 0x6E, 3000, 0},   // IBAT 3 A
+};
+const uint8_t IP2366Scenario::pdAttach20VLength = sizeof(pdAttach20V) / sizeof(pdAttach20V[0]);
+
+const IP2366Scenario::Step IP2366Scenario::ccToCv[] = {
+    {0, Action::SET, 0x31, 0x22, 0xFF},     // charging, constant current
+    {0, Action::SET16, 0x50, 7800, 0},      // VBAT
+    {0, Action::SET16, 0x6E, 3000, 0},      // IBAT
+    {5000, Action::SET16, 0x50, 8350, 0},
+    {10000, Action::SET, 0x31, 0x23, 0xFF}, // constant voltage
+    {10000, Action::SET16, 0x6E, 2500, 0},
+    {15000, Action::SET16, 0x6E, 1200, 0},
+    {20000, Action::SET16, 0x6E, 300, 0},
+    {25000, Action::SET, 0x31, 0x15, 0xFF}, // CHG_End, charge full
+    {25000, Action::SET16, 0x6E, 0, 0},
+};
+const uint8_t IP2366Scenario::ccToCvLength = sizeof(ccToCv) / sizeof(ccToCv[0]);
+
+const IP2366Scenario::Step IP2366Scenario::vsysOverCurrent[] = {
+    {0, Action::SET, 0x31, 0x08, 0xFF},    // STATE_CTL0: output enabled
+    {0, Action::SET16, 0x70, 2000, 0},     // Vsys current 2 A
+    {1000, Action::SET16, 0x70, 6500, 0},  // load spike
+    {1000, Action::SET, 0x38, 0x20, 0x20}, // STATE_CTL3: Vsys over-current
+    {1010, Action::SET, 0x31, 0x00, 0x08}, // output turned off
+    {1010, Action::SET16, 0x70, 0, 0},
+};
+const uint8_t IP2366Scenario::vsysOverCurrentLength = sizeof(vsysOverCurrent) / sizeof(vsysOverCurrent[0]);
+
+const IP2366Scenario::Step IP2366Scenario::sleepMidRead[] = {
+    {0, Action::SET, 0x31, 0x22, 0xFF},
+    {0, Action::SET16, 0x50, 8000, 0},
+    {500, Action::SLEEP_MID_READ, 0, 0, 0},
+    {1500, Action::WAKE, 0, 0, 0},
+};
+const uint8_t IP2366Scenario::sleepMidReadLength = sizeof(sleepMidRead) / sizeof(sleepMidRead[0]);
+
+void IP2366Scenario::start(const Step * steps, uint8_t count)
+{
+    start(steps, count, millis());
+}
+
+void IP2366Scenario::start(const Step * steps, uint8_t count, uint32_t now)
+{
+    this->steps = steps;
+    this->count = count;
+    next = 0;
+    startTime = now;
+}
+
+uint8_t IP2366Scenario::update()
+{
+    return update(millis());
+}
+
+uint8_t IP2366Scenario::update(uint32_t now)
+{
+    uint8_t applied = 0;
+    while (next < count && (uint32_t)(now - startTime) >= steps[next].at_ms)
+    {
+        apply(steps[next++]);
+        applied++;
+    }
+    return applied;
+}
+
+void IP2366Scenario::apply(const Step & step)
+{
+    switch (step.action)
+    {
+    case Action::SET:
+        bus.setRegister(step.regAddress, step.value, step.mask);
+        break;
+    case Action::SET16:
+        bus.setRegister16(step.regAddress, step.value);
+        break;
+    case Action::SLEEP:
+        bus.sleep();
+        break;
+    case Action::SLEEP_MID_READ:
+        bus.sleepMidRead();
+        break;
+    case Action::WAKE:
+        bus.wake();
+        break;
+    }
+}
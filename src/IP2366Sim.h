@@ -0,0 +1,152 @@
+#ifndef IP2366_SIM_H
+#define IP2366_SIM_H
+
+#include <stdint.h>
+
+#include "IP2366Bus.h"
+#include "IP2366Platform.h"
+
+#ifdef IP2366_HOST
+// Simulated time for host runs. While installed, millis()/micros() return it and delay() advances it instead
+// of sleeping, so scenarios run deterministically and as fast as the CPU allows. An IP2366SimBus given the
+// clock with setSimClock() also advances it by the wire time of every transaction.
+class IP2366SimClock : public IP2366Clock
+{
+public:
+    IP2366SimClock(uint64_t start_us = 0) : now(start_us) {};
+    ~IP2366SimClock() { uninstall(); };
+
+    void install() { active() = this; };
+    void uninstall()
+    {
+        if (active() == this)
+            active() = nullptr;
+    };
+
+    uint64_t now_us() override { return now; };
+    void sleep_us(uint32_t us) override { now += us; };
+    void advance(uint32_t ms) { now += (uint64_t)ms * 1000; };
+
+private:
+    uint64_t now;
+};
+#endif
+
+// Simulated IP2366 register map, so the real driver can run without hardware (on the host or on a board).
+// Status and ADC registers are read-only for the driver, STATE_CTL3 flags are cleared by writing 1,
+// a sleeping chip NACKs every transaction. Bus efficiency is tracked as transaction/byte counts and
+// the wire time at the configured clock.
+class IP2366SimBus : public IP2366Bus
+{
+public:
+    struct Stats
+    {
+        uint32_t reads;
+        uint32_t writes;
+        uint32_t bytes;      // payload bytes
+        uint32_t nacks;      // failed transactions
+        uint32_t busTime_us; // wire time at the configured clock
+    };
+
+    IP2366SimBus(uint8_t address = 0x75, uint32_t clock_hz = 100000);
+
+    uint8_t writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length) override;
+    uint8_t readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length) override;
+
+    // Chip side access, not counted in the stats
+    uint8_t getRegister(uint8_t regAddress) const { return registers[regAddress]; };
+    void setRegister(uint8_t regAddress, uint8_t value, uint8_t mask = 0xFF);
+    void setRegister16(uint8_t regAddress, uint16_t value); // ADC value, low byte first
+    void reset();                                           // all registers 0, awake
+
+    void sleep() { asleep = true; };
+    void sleepMidRead() { cutNextRead = true; }; // the next read is cut short, then the chip sleeps
+    void wake() { asleep = false; cutNextRead = false; };
+    bool isAsleep() const { return asleep; };
+
+    // Writing En_RESETMCU (SYS_CTL0[6]) clears the writable registers; the chip then NACKs for resetTime_ms
+    void setResetTime(uint16_t resetTime_ms) { resetTime = resetTime_ms; };
+
+    const Stats & getStats() const { return stats; };
+    void resetStats() { stats = {0, 0, 0, 0, 0}; };
+
+#ifdef IP2366_HOST
+    void setSimClock(IP2366SimClock * clock) { simClock = clock; }; // transactions take their wire time on it
+#endif
+
+private:
+    static bool isReadOnly(uint8_t regAddress);
+    void account(uint16_t bits);
+    bool isBusy();
+    void resetRegisters();
+
+    uint8_t registers[256];
+    uint8_t address;
+    uint32_t clock;
+    bool asleep = false;
+    bool cutNextRead = false;
+    uint16_t resetTime = 0;
+    bool resetting = false;
+    uint32_t resetStart = 0;
+    Stats stats = {0, 0, 0, 0, 0};
+#ifdef IP2366_HOST
+    IP2366SimClock * simClock = nullptr;
+#endif
+};
+
+// Replays a timed list of register changes and chip events against an IP2366SimBus.
+// Steps must be sorted by time; times are relative to start(). Without an explicit time, millis() is used,
+// which is simulated time while an IP2366SimClock is installed.
+class IP2366Scenario
+{
+public:
+    enum class Action : uint8_t
+    {
+        SET,            // regAddress = (regAddress & ~mask) | (value & mask)
+        SET16,          // 16 bit ADC value at regAddress, regAddress + 1
+        SLEEP,          // chip stops answering
+        SLEEP_MID_READ, // the next read is cut short, then the chip sleeps
+        WAKE
+    };
+
+    struct Step
+    {
+        uint32_t at_ms;
+        Action action;
+        uint8_t regAddress;
+        uint16_t value;
+        uint8_t mask;
+    };
+
+    // Built-in scenarios
+    static const Step pdAttach20V[];     // sink attaches, PD contract, 5 V -> 20 V with fast charge
+    static const uint8_t pdAttach20VLength;
+    static const Step ccToCv[];          // constant current -> constant voltage -> full
+    static const uint8_t ccToCvLength;
+    static const Step vsysOverCurrent[]; // Vsys load spike trips the over-current flag, output turns off
+    static const uint8_t vsysOverCurrentLength;
+    static const Step sleepMidRead[];    // chip drops asleep in the middle of a read and wakes 1 s later
+    static const uint8_t sleepMidReadLength;
+
+    IP2366Scenario(IP2366SimBus & bus) : bus(bus) {};
+
+    void start(const Step * steps, uint8_t count);
+    void start(const Step * steps, uint8_t count, uint32_t now);
+    uint8_t update();             // applies the due steps, returns how many
+    uint8_t update(uint32_t now); // same with an explicit time in ms
+
+    bool isFinished() const { return next >= count; };
+    uint8_t getStep() const { return next; };
+    uint32_t getElapsed(uint32_t now) const { return now - startTime; };
+
+private:
+    void apply(const Step & step);
+
+    IP2366SimBus & bus;
+    const Step * steps = nullptr;
+    uint8_t count = 0;
+    uint8_t next = 0;
+    uint32_t startTime = 0;
+};
+
+#endif
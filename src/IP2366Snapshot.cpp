@@ -0,0 +1,112 @@
+#include "IP2366Snapshot.h"
+#include <string.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+IP2366SnapshotPublisher::IP2366SnapshotPublisher()
+    : magic(IP2366_SNAPSHOT_MAGIC), version(IP2366_SNAPSHOT_VERSION), size(sizeof(*this)), sequence(0)
+{
+    memset(slots, 0, sizeof(slots));
+}
+
+void IP2366SnapshotPublisher::publish(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status)
+{
+    uint32_t base = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+    // The slot being written is never the one holding the latest complete publication
+    IP2366SnapshotRecord & slot = slots[((base >> 1) + 1) & 1];
+
+    __atomic_store_n(&sequence, base + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot.sequence = (base >> 1) + 1;
+    slot.adc = adc;
+    slot.status = status;
+
+    __atomic_store_n(&sequence, base + 2, __ATOMIC_RELEASE);
+}
+
+bool IP2366SnapshotPublisher::read(IP2366SnapshotRecord & record, uint8_t maxRetries) const
+{
+    for (uint8_t attempt = 0; attempt <= maxRetries; attempt++)
+    {
+        uint32_t begin = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE) & ~(uint32_t)1; // latest complete publication
+        if (begin == 0)
+            return false;
+
+        memcpy(&record, &slots[(begin >> 1) & 1], sizeof(record));
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t end = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+        // The slot is rewritten only by the publication after the next one, which starts at begin + 3
+        if ((uint32_t)(end - begin) <= 2)
+            return true;
+    }
+    return false;
+}
+
+uint32_t IP2366SnapshotPublisher::getSequence() const
+{
+    return __atomic_load_n(&sequence, __ATOMIC_ACQUIRE) >> 1;
+}
+
+void IP2366SnapshotPublisher::onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * publisher)
+{
+    static_cast<IP2366SnapshotPublisher *>(publisher)->publish(adc, status);
+}
+
+#if defined(__linux__)
+
+bool IP2366SnapshotMapping::create(const char * path)
+{
+    return map(path, true);
+}
+
+bool IP2366SnapshotMapping::open(const char * path)
+{
+    return map(path, false);
+}
+
+bool IP2366SnapshotMapping::map(const char * path, bool create)
+{
+    close();
+
+    int fd = ::open(path, create ? (O_RDWR | O_CREAT) : O_RDWR, 0644);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if ((create && ftruncate(fd, sizeof(IP2366SnapshotPublisher)) != 0) ||
+        fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(IP2366SnapshotPublisher))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void * memory = mmap(nullptr, sizeof(IP2366SnapshotPublisher), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+        return false;
+
+    publisher = create ? new (memory) IP2366SnapshotPublisher() : static_cast<IP2366SnapshotPublisher *>(memory);
+    if (!publisher->isCompatible())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void IP2366SnapshotMapping::close()
+{
+    if (publisher != nullptr)
+        munmap(publisher, sizeof(IP2366SnapshotPublisher));
+    publisher = nullptr;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef IP2366_SNAPSHOT_H
+#define IP2366_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "IP2366.h"
+
+#define IP2366_SNAPSHOT_MAGIC 0x32363649 // "I623"
+#define IP2366_SNAPSHOT_VERSION 1
+
+struct IP2366SnapshotRecord
+{
+    uint32_t sequence; // number of the publication, starts at 1
+    IP2366::AdcSnapshot adc;
+    IP2366::StatusSnapshot status;
+};
+
+// Lock-free single-writer / multi-reader snapshot publication (seqlock over a double buffer).
+// publish() never waits, read() never blocks the writer and only retries if the writer lapped it twice
+// during the copy. The object holds no pointers, so it may live in shared memory (see IP2366SnapshotMapping).
+class IP2366SnapshotPublisher
+{
+public:
+    IP2366SnapshotPublisher();
+
+    void publish(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status);
+    bool read(IP2366SnapshotRecord & record, uint8_t maxRetries = 8) const; // false if nothing published yet or too contended
+    uint32_t getSequence() const;
+
+    // IP2366Sampler callback: sampler.subscribe(IP2366SnapshotPublisher::onSample, &publisher)
+    static void onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * publisher);
+
+    bool isCompatible() const { return magic == IP2366_SNAPSHOT_MAGIC && version == IP2366_SNAPSHOT_VERSION && size == sizeof(*this); };
+
+private:
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t sequence; // 2 * publications, odd while a publication is in progress
+    IP2366SnapshotRecord slots[2];
+};
+
+#if defined(__linux__)
+
+// Places an IP2366SnapshotPublisher in a memory-mapped file, so other processes can read the same snapshots
+class IP2366SnapshotMapping
+{
+public:
+    IP2366SnapshotMapping() : publisher(nullptr) {};
+    ~IP2366SnapshotMapping() { close(); };
+
+    bool create(const char * path); // writer side, (re)initializes the file
+    bool open(const char * path);   // reader side, fails if the layout does not match
+    void close();
+
+    IP2366SnapshotPublisher * get() const { return publisher; };
+
+private:
+    bool map(const char * path, bool create);
+
+    IP2366SnapshotPublisher * publisher;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,195 @@
+#include "IP2366SourcePdoManager.h"
+#include <string.h>
+
+// Block offsets from TypeC_CTL9
+#define IP2366_SRC_PDO_CTL9 0
+#define IP2366_SRC_PDO_ISET(pdo) (1 + (pdo))  // TypeC_CTL10 - TypeC_CTL14
+#define IP2366_SRC_PDO_PPS_ISET(pps) (6 + (pps)) // TypeC_CTL23 - TypeC_CTL24
+#define IP2366_SRC_PDO_CTL17 (IP2366_SRC_PDO_BLOCK_SIZE - 1)
+#define IP2366_SRC_PDO_CTL17_MASK 0x7E
+
+static const uint8_t fixedVoltage[] = {5, 9, 12, 15, 20};
+
+bool IP2366SourcePdoManager::update()
+{
+    IP2366::AdcSnapshot adc;
+    IP2366::StatusSnapshot status;
+    if (!chip.readAdcSnapshot(adc) || !chip.readStatusSnapshot(status))
+        return false;
+    return update(adc, status);
+}
+
+bool IP2366SourcePdoManager::update(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status)
+{
+    uint32_t now = adc.timestamp;
+    if (!known)
+    {
+        if (!chip.readSourcePdoBlock(registers))
+            return false;
+        advertised = decode(registers);
+        known = true;
+        pending = NONE;
+        lastBackoff = now;
+    }
+
+    // SECTION: back-off on every new Vsys over-current, recovering 5% per debounceUp_ms
+    bool flag = status.getSystemStatus().has(IP2366::SystemStatus::VSYS_OVERCURRENT);
+    if (flag && !overCurrent)
+    {
+        backoff = backoff + config.backoffStep > config.maxBackoff ? config.maxBackoff : backoff + config.backoffStep;
+        lastBackoff = now;
+        pending = DOWN;
+        pendingSince = now - config.debounceDown_ms; // no debounce for the reduction
+    }
+    else if (backoff > 0 && (uint32_t)(now - lastBackoff) >= config.debounceUp_ms)
+    {
+        backoff = backoff > 5 ? backoff - 5 : 0;
+        lastBackoff = now;
+    }
+    overCurrent = flag;
+
+    // SECTION: debounce
+    budget = effectiveBudget(adc);
+    Advertisement target = compute(budget);
+    Direction direction = compare(target);
+    if (direction == NONE)
+    {
+        pending = NONE;
+        return false;
+    }
+    if (direction != pending)
+    {
+        pending = direction;
+        pendingSince = now;
+    }
+    if ((uint32_t)(now - pendingSince) < (direction == DOWN ? config.debounceDown_ms : config.debounceUp_ms))
+        return false;
+
+    // SECTION: apply
+    uint8_t block[IP2366_SRC_PDO_BLOCK_SIZE];
+    encode(target, block);
+    uint8_t count = 0;
+    bool written = chip.writeSourcePdoBlock(block, registers, &count);
+    writes += count;
+    pending = NONE;
+    advertised = decode(registers);
+    if (!written)
+    {
+        known = false;
+        return false;
+    }
+    updates++;
+    return true;
+}
+
+void IP2366SourcePdoManager::onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * manager)
+{
+    static_cast<IP2366SourcePdoManager *>(manager)->update(adc, status);
+}
+
+uint32_t IP2366SourcePdoManager::effectiveBudget(const IP2366::AdcSnapshot & adc) const
+{
+    uint32_t result = config.budget_mW;
+
+    if (config.batteryFull_mV > config.batteryEmpty_mV)
+    {
+        if (adc.VBATVoltage <= config.batteryEmpty_mV)
+            result = 0;
+        else if (adc.VBATVoltage < config.batteryFull_mV)
+            result = result * (adc.VBATVoltage - config.batteryEmpty_mV) / (config.batteryFull_mV - config.batteryEmpty_mV);
+    }
+
+    if (converter != nullptr && config.deratingEnd > config.deratingStart)
+    {
+        int16_t temperature = converter(adc.NTCResistance);
+        if (temperature >= config.deratingEnd)
+            result = 0;
+        else if (temperature > config.deratingStart)
+            result = result * (config.deratingEnd - temperature) / (config.deratingEnd - config.deratingStart);
+    }
+
+    return result * (100 - backoff) / 100;
+}
+
+IP2366SourcePdoManager::Advertisement IP2366SourcePdoManager::compute(uint32_t budget_mW) const
+{
+    Advertisement result;
+    for (uint8_t pdo = PDO_5V; pdo <= PDO_20V; pdo++)
+    {
+        uint32_t max = pdo == PDO_20V ? config.max20VCurrent_mA : config.maxCurrent_mA;
+        uint32_t current = budget_mW / fixedVoltage[pdo];
+        if (current > max)
+            current = max;
+        if (current < config.minCurrent_mA)
+            current = pdo == PDO_5V ? (config.minCurrent_mA < max ? config.minCurrent_mA : max) : 0;
+        result.current_mA[pdo] = current - current % 20;
+    }
+
+    const uint16_t ppsVoltage[] = {config.pps1Voltage_mV, config.pps2Voltage_mV};
+    for (uint8_t pps = 0; pps < 2; pps++)
+    {
+        uint32_t current = ppsVoltage[pps] ? budget_mW * 1000 / ppsVoltage[pps] : 0;
+        if (current > config.maxPpsCurrent_mA)
+            current = config.maxPpsCurrent_mA;
+        if (current < config.minCurrent_mA)
+            current = 0;
+        result.current_mA[PDO_PPS1 + pps] = current - current % 50;
+    }
+    return result;
+}
+
+IP2366SourcePdoManager::Direction IP2366SourcePdoManager::compare(const Advertisement & target) const
+{
+    Direction direction = NONE;
+    for (uint8_t pdo = 0; pdo < PDO_COUNT; pdo++)
+    {
+        uint16_t from = advertised.current_mA[pdo];
+        uint16_t to = target.current_mA[pdo];
+        if ((from && !to) || to + config.hysteresis_mA <= from)
+            return DOWN;
+        if ((!from && to) || to >= from + config.hysteresis_mA)
+            direction = UP;
+    }
+    return direction;
+}
+
+IP2366SourcePdoManager::Advertisement IP2366SourcePdoManager::decode(const uint8_t block[IP2366_SRC_PDO_BLOCK_SIZE])
+{
+    Advertisement result;
+    uint8_t ctl9 = block[IP2366_SRC_PDO_CTL9];
+    uint8_t ctl17 = block[IP2366_SRC_PDO_CTL17];
+
+    if (ctl9 & 0x01)
+        result.current_mA[PDO_5V] = IP2366::decodePDOCurrent(block[IP2366_SRC_PDO_ISET(PDO_5V)]);
+    else
+        result.current_mA[PDO_5V] = (ctl9 & 0x80) ? 3000 : 2400;
+    for (uint8_t pdo = PDO_9V; pdo <= PDO_20V; pdo++)
+        result.current_mA[pdo] = (ctl17 & (1 << pdo)) ? IP2366::decodePDOCurrent(block[IP2366_SRC_PDO_ISET(pdo)]) : 0;
+    for (uint8_t pps = 0; pps < 2; pps++)
+        result.current_mA[PDO_PPS1 + pps] = (ctl17 & (1 << (5 + pps))) ? IP2366::decodePPSCurrent(block[IP2366_SRC_PDO_PPS_ISET(pps)]) : 0;
+    return result;
+}
+
+void IP2366SourcePdoManager::encode(const Advertisement & target, uint8_t block[IP2366_SRC_PDO_BLOCK_SIZE]) const
+{
+    // registers of PDOs that are not advertised keep their value, so they are not rewritten
+    memcpy(block, registers, IP2366_SRC_PDO_BLOCK_SIZE);
+    block[IP2366_SRC_PDO_CTL9] = 0x7F | (target.current_mA[PDO_5V] > 2400 ? 0x80 : 0); // Iset for every PDO
+    uint8_t ctl17 = 0;
+    for (uint8_t pdo = PDO_5V; pdo <= PDO_20V; pdo++)
+    {
+        if (!target.current_mA[pdo])
+            continue;
+        block[IP2366_SRC_PDO_ISET(pdo)] = IP2366::encodePDOCurrent(target.current_mA[pdo], pdo == PDO_20V ? 5000 : 3000);
+        if (pdo != PDO_5V)
+            ctl17 |= 1 << pdo;
+    }
+    for (uint8_t pps = 0; pps < 2; pps++)
+    {
+        if (!target.current_mA[PDO_PPS1 + pps])
+            continue;
+        block[IP2366_SRC_PDO_PPS_ISET(pps)] = IP2366::encodePPSCurrent(target.current_mA[PDO_PPS1 + pps]);
+        ctl17 |= 1 << (5 + pps);
+    }
+    block[IP2366_SRC_PDO_CTL17] = (registers[IP2366_SRC_PDO_CTL17] & ~IP2366_SRC_PDO_CTL17_MASK) | ctl17;
+}
@@ -0,0 +1,104 @@
+#ifndef IP2366_SOURCE_PDO_MANAGER_H
+#define IP2366_SOURCE_PDO_MANAGER_H
+
+#include "IP2366.h"
+#include "IP2366Ntc.h"
+
+// Source PDO advertisement for DFP/DRP mode.
+// Derives a power budget from the configured budget, the battery voltage, the NTC temperature and a back-off
+// taken on every Vsys over-current, and advertises each fixed and PPS PDO with the current that fits in it.
+// Current limiting (TypeC_CTL9 Iset) is enabled for every PDO, so the chip's over-current trip follows the
+// advertised current. Reductions apply after debounceDown_ms, raises after the longer debounceUp_ms, and
+// changes below hysteresis_mA are ignored, so the sink is not made to renegotiate for noise.
+// Only the TypeC_CTL9 - TypeC_CTL17 registers that change are written.
+class IP2366SourcePdoManager
+{
+public:
+    enum Pdo : uint8_t
+    {
+        PDO_5V,
+        PDO_9V,
+        PDO_12V,
+        PDO_15V,
+        PDO_20V,
+        PDO_PPS1,
+        PDO_PPS2,
+        PDO_COUNT
+    };
+
+    struct Advertisement
+    {
+        uint16_t current_mA[PDO_COUNT]; // 0 - not advertised (5V is always advertised)
+    };
+
+    struct Config
+    {
+        uint32_t budget_mW = 60000;       // at full battery and normal temperature
+        uint16_t maxCurrent_mA = 3000;    // fixed PDOs
+        uint16_t max20VCurrent_mA = 3000; // 5000 only with an e-marked cable
+        uint16_t maxPpsCurrent_mA = 3000;
+        uint16_t pps1Voltage_mV = 11000;  // highest PPS1 voltage, sizes its current
+        uint16_t pps2Voltage_mV = 21000;
+        uint16_t minCurrent_mA = 1000;    // PDOs below this are not advertised
+        uint16_t batteryEmpty_mV = 0;     // VBAT where the budget reaches 0 (5V minimum only), 0 - no battery derating
+        uint16_t batteryFull_mV = 0;      // VBAT from which the full budget applies
+        int16_t deratingStart = 450;      // 0.1 degC, full budget below
+        int16_t deratingEnd = 600;        // 0.1 degC, 5V minimum only above
+        uint8_t backoffStep = 10;         // % of the budget dropped on each Vsys over-current
+        uint8_t maxBackoff = 50;          // %
+        uint16_t hysteresis_mA = 200;
+        uint16_t debounceDown_ms = 500;
+        uint16_t debounceUp_ms = 5000;    // also the time for each 5% of back-off to recover
+    };
+
+    IP2366SourcePdoManager(IP2366 & chip, IP2366NtcConverter converter = nullptr) : chip(chip), converter(converter) {};
+
+    void setConfig(const Config & config) { this->config = config; };
+    const Config & getConfig() const { return config; };
+    void setBudget(uint32_t budget_mW) { config.budget_mW = budget_mW; };
+
+    bool update(); // call from loop(), returns true when the advertisement was rewritten
+    bool update(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status);
+    void invalidate() { known = false; }; // re-read the registers, e.g. after a chip reset
+
+    // IP2366Sampler callback: sampler.subscribe(IP2366SourcePdoManager::onSample, &manager)
+    static void onSample(const IP2366::AdcSnapshot & adc, const IP2366::StatusSnapshot & status, void * manager);
+
+    const Advertisement & getAdvertised() const { return advertised; }; // as last read or written
+    uint32_t getEffectiveBudget() const { return budget; };             // mW, after derating and back-off
+    uint8_t getBackoff() const { return backoff; };                     // %
+    uint32_t getUpdates() const { return updates; };                    // advertisement rewrites
+    uint32_t getWrites() const { return writes; };                      // register write transactions
+
+    Advertisement compute(uint32_t budget_mW) const;
+    static Advertisement decode(const uint8_t block[IP2366_SRC_PDO_BLOCK_SIZE]);
+
+private:
+    enum Direction : uint8_t
+    {
+        NONE,
+        DOWN,
+        UP
+    };
+
+    uint32_t effectiveBudget(const IP2366::AdcSnapshot & adc) const;
+    Direction compare(const Advertisement & target) const;
+    void encode(const Advertisement & target, uint8_t block[IP2366_SRC_PDO_BLOCK_SIZE]) const;
+
+    IP2366 & chip;
+    IP2366NtcConverter converter;
+    Config config;
+    bool known = false;
+    uint8_t registers[IP2366_SRC_PDO_BLOCK_SIZE];
+    Advertisement advertised;
+    uint32_t budget = 0;
+    Direction pending = NONE;
+    uint32_t pendingSince = 0;
+    bool overCurrent = false;
+    uint8_t backoff = 0;
+    uint32_t lastBackoff = 0;
+    uint32_t updates = 0;
+    uint32_t writes = 0;
+};
+
+#endif
@@ -0,0 +1,286 @@
+#ifndef IP2366_STATIC_H
+#define IP2366_STATIC_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "IP2366.h"
+#include "IP2366Registers.h"
+
+// Compile-time configured driver for boards with a single chip at a fixed address.
+// It covers charging, output and PD configuration, status, ADC and snapshots; identity, provisioning, quirks,
+// bus locking and the INT pin stay in IP2366, use the register templates for anything else.
+// Address, transport and error policy are template parameters: there is no virtual call, no address member
+// and, with IP2366UncheckedPolicy, no error bookkeeping, so the compiler can inline each accessor down to the
+// bus transaction. Data types (snapshots, SystemStatus, enums) are shared with IP2366.
+//
+//   StaticIP2366<> device;                                                   // Wire, 0x75, errors reported
+//   StaticIP2366<0x75, IP2366StaticWireBus<0>, IP2366UncheckedPolicy> fast;  // no byte delays, no error codes
+
+// Error policies
+struct IP2366CheckedPolicy
+{
+    static constexpr bool reportErrors = true; // errorCode out-parameters are filled like in IP2366
+};
+
+struct IP2366UncheckedPolicy
+{
+    static constexpr bool reportErrors = false; // errorCode out-parameters are ignored
+};
+
+#ifdef IP2366_ARDUINO
+// Non-virtual Wire transport. ByteDelay_ms is the delay between transaction phases (IP2366WireBus uses 1 ms)
+template <uint8_t ByteDelay_ms = 1>
+class IP2366StaticWireBus
+{
+public:
+    void begin() { Wire.begin(); };
+
+    uint8_t writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length)
+    {
+        return IP2366WireTransfer::write(Wire, address, regAddress, data, length, pause);
+    };
+
+    uint8_t readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length)
+    {
+        return IP2366WireTransfer::read(Wire, address, regAddress, data, length, pause);
+    };
+
+private:
+    static void pause()
+    {
+        if (ByteDelay_ms)
+            delay(ByteDelay_ms);
+    };
+};
+#endif
+
+// Uses a runtime transport (IP2366SimBus, IP2366LinuxI2CBus, ...) as the Bus of a StaticIP2366
+template <class T>
+class IP2366BusRef
+{
+public:
+    IP2366BusRef(T & bus) : bus(bus) {};
+
+    void begin() { bus.begin(); };
+    uint8_t writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length) { return bus.writeRegisters(address, regAddress, data, length); };
+    uint8_t readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length) { return bus.readRegisters(address, regAddress, data, length); };
+
+private:
+    T & bus;
+};
+
+#ifdef IP2366_ARDUINO
+template <uint8_t Address = 0x75, class Bus = IP2366StaticWireBus<>, class Policy = IP2366CheckedPolicy>
+#else
+template <uint8_t Address, class Bus, class Policy = IP2366CheckedPolicy>
+#endif
+class StaticIP2366
+{
+public:
+    static constexpr uint8_t address = Address;
+
+    StaticIP2366(const Bus & bus = Bus()) : bus(bus) {};
+    void begin() { bus.begin(); };
+
+    ///////// SET ////////
+
+    // SYS_CTL0
+
+    void enableCharger(bool enable = true, uint8_t * errorCode = nullptr) { reset(errorCode); updateRegister<IP2366_REG_SYS_CTL0, 0x01>(enable ? 0x01 : 0, errorCode); };
+    void enableVbusSinkSCP(bool enable = true, uint8_t * errorCode = nullptr) { reset(errorCode); updateRegister<IP2366_REG_SYS_CTL0, 0x04>(enable ? 0x04 : 0, errorCode); };
+    void enableVbusSinkPD(bool enable = true, uint8_t * errorCode = nullptr) { reset(errorCode); updateRegister<IP2366_REG_SYS_CTL0, 0x08>(enable ? 0x08 : 0, errorCode); };
+    void enableVbusSinkDPdM(bool enable = true, uint8_t * errorCode = nullptr) { reset(errorCode); updateRegister<IP2366_REG_SYS_CTL0, 0x10>(enable ? 0x10 : 0, errorCode); };
+
+    // SYS_CTL2 - SYS_CTL10
+
+    void setFullChargeVoltage(uint16_t voltage = 4400, uint8_t * errorCode = nullptr) { reset(errorCode); writeRegister<IP2366_REG_SYS_CTL2>(IP2366::encodeFullChargeVoltage(voltage), errorCode); };
+    void setMaxInputPowerOrBatteryCurrent(uint16_t current_mA = 9700, uint8_t * errorCode = nullptr)
+    {
+        reset(errorCode);
+        writeRegister<IP2366_REG_SYS_CTL3>(IP2366::encodeMaxInputPowerOrBatteryCurrent(current_mA), errorCode);
+    };
+    void setTrickleChargeCurrent(uint16_t current = 200, uint8_t * errorCode = nullptr) { reset(errorCode); writeRegister<IP2366_REG_SYS_CTL6>(IP2366::encodeTrickleChargeCurrent(current), errorCode); };
+    void setChargeStopCurrent(uint16_t current = 100, uint8_t * errorCode = nullptr)
+    {
+        reset(errorCode);
+        updateRegister<IP2366_REG_SYS_CTL8, 0xF0>(IP2366::encodeChargeStopCurrent(current) << 4, errorCode);
+    };
+    void setCellRechargeThreshold(uint16_t voltageDrop_mV = 200, uint8_t * errorCode = nullptr)
+    {
+        reset(errorCode);
+        updateRegister<IP2366_REG_SYS_CTL8, 0x0C>(IP2366::encodeCellRechargeThreshold(voltageDrop_mV) << 2, errorCode);
+    };
+    void enableStandbyMode(bool enable = true, uint8_t * errorCode = nullptr) { reset(errorCode); updateRegister<IP2366_REG_SYS_CTL9, 0x80>(enable ? 0x80 : 0, errorCode); };
+    void Standby(bool enable = true, uint8_t * errorCode = nullptr) { reset(errorCode); updateRegister<IP2366_REG_SYS_CTL9, 0x40>(enable ? 0x40 : 0, errorCode); };
+    void enableBATLow(bool enable = true, uint8_t * errorCode = nullptr) { reset(errorCode); updateRegister<IP2366_REG_SYS_CTL9, 0x20>(enable ? 0x20 : 0, errorCode); };
+    void setLowBatteryVoltage(uint16_t voltage_mV = 2700, uint8_t * errorCode = nullptr)
+    {
+        reset(errorCode);
+        updateRegister<IP2366_REG_SYS_CTL10, 0xE0>(IP2366::encodeLowBatteryVoltage(voltage_mV) << 5, errorCode);
+    };
+
+    // SYS_CTL11 - SYS_CTL12
+
+    void setOutputFeatures(bool enableDcDcOutput = true, bool enableVbusSrcDPdM = true, bool enableVbusSrcPd = true, bool enableVbusSrcSCP = true, uint8_t * errorCode = nullptr)
+    {
+        reset(errorCode);
+        uint8_t value = (enableDcDcOutput << 7) | (enableVbusSrcDPdM << 6) | (enableVbusSrcPd << 5) | (enableVbusSrcSCP << 4);
+        updateRegister<IP2366_REG_SYS_CTL11, 0xF0>(value, errorCode);
+    };
+    void setMaxOutputPower(IP2366::Vbus1OutputPower power = IP2366::Vbus1OutputPower::W140, uint8_t * errorCode = nullptr)
+    {
+        reset(errorCode);
+        updateRegister<IP2366_REG_SYS_CTL12, 0xE0>(static_cast<uint8_t>(power) << 5, errorCode);
+    };
+
+    // PD
+
+    void setChargingPDOmode(IP2366::ChargingPDOmode mode, uint8_t * errorCode = nullptr) { reset(errorCode); updateRegister<IP2366_REG_SELECT_PDO, 0x07>(static_cast<uint8_t>(mode), errorCode); };
+    void setTypeCMode(IP2366::TypeCMode mode, uint8_t * errorCode = nullptr) { reset(errorCode); updateRegister<IP2366_REG_TypeC_CTL8, 0xC0>(static_cast<uint8_t>(mode) << 6, errorCode); };
+    void setPDOCurrent5V(uint16_t current_mA, uint8_t * errorCode = nullptr) { reset(errorCode); writeRegister<IP2366_REG_TypeC_CTL10>(IP2366::encodePDOCurrent(current_mA, 3000), errorCode); };
+    void setPDOCurrent9V(uint16_t current_mA, uint8_t * errorCode = nullptr) { reset(errorCode); writeRegister<IP2366_REG_TypeC_CTL11>(IP2366::encodePDOCurrent(current_mA, 3000), errorCode); };
+    void setPDOCurrent12V(uint16_t current_mA, uint8_t * errorCode = nullptr) { reset(errorCode); writeRegister<IP2366_REG_TypeC_CTL12>(IP2366::encodePDOCurrent(current_mA, 3000), errorCode); };
+    void setPDOCurrent15V(uint16_t current_mA, uint8_t * errorCode = nullptr) { reset(errorCode); writeRegister<IP2366_REG_TypeC_CTL13>(IP2366::encodePDOCurrent(current_mA, 3000), errorCode); };
+    void setPDOCurrent20V(uint16_t current_mA, uint8_t * errorCode = nullptr) { reset(errorCode); writeRegister<IP2366_REG_TypeC_CTL14>(IP2366::encodePDOCurrent(current_mA, 5000), errorCode); };
+    void setPDOCurrentPPS1(uint16_t current_mA, uint8_t * errorCode = nullptr) { reset(errorCode); writeRegister<IP2366_REG_TypeC_CTL23>(IP2366::encodePPSCurrent(current_mA), errorCode); };
+    void setPDOCurrentPPS2(uint16_t current_mA, uint8_t * errorCode = nullptr) { reset(errorCode); writeRegister<IP2366_REG_TypeC_CTL24>(IP2366::encodePPSCurrent(current_mA), errorCode); };
+    void enableSrcPdo(bool en9VPdo, bool en12VPdo, bool en15VPdo, bool en20VPdo, bool enPps1Pdo, bool enPps2Pdo, uint8_t * errorCode = nullptr)
+    {
+        reset(errorCode);
+        uint8_t value = (enPps2Pdo << 6) | (enPps1Pdo << 5) | (en20VPdo << 4) | (en15VPdo << 3) | (en12VPdo << 2) | (en9VPdo << 1);
+        updateRegister<IP2366_REG_TypeC_CTL17, 0x7E>(value, errorCode);
+    };
+
+    ///////// GET ////////
+
+    // Configuration
+
+    bool isChargerEnabled(uint8_t * errorCode = nullptr) { reset(errorCode); return readRegister<IP2366_REG_SYS_CTL0>(errorCode) & 0x01; };
+    uint16_t getFullChargeVoltage(uint8_t * errorCode = nullptr) { reset(errorCode); return IP2366::decodeFullChargeVoltage(readRegister<IP2366_REG_SYS_CTL2>(errorCode)); };
+    uint16_t getMaxInputPowerOrBatteryCurrent(uint8_t * errorCode = nullptr) { reset(errorCode); return IP2366::decodeMaxInputPowerOrBatteryCurrent(readRegister<IP2366_REG_SYS_CTL3>(errorCode)); };
+    uint16_t getTrickleChargeCurrent(uint8_t * errorCode = nullptr) { reset(errorCode); return IP2366::decodeTrickleChargeCurrent(readRegister<IP2366_REG_SYS_CTL6>(errorCode)); };
+    uint16_t getChargeStopCurrent(uint8_t * errorCode = nullptr) { reset(errorCode); return IP2366::decodeChargeStopCurrent(readRegister<IP2366_REG_SYS_CTL8>(errorCode) >> 4); };
+    uint16_t getLowBatteryVoltage(uint8_t * errorCode = nullptr) { reset(errorCode); return IP2366::decodeLowBatteryVoltage(readRegister<IP2366_REG_SYS_CTL10>(errorCode) >> 5); };
+    uint16_t getPDOCurrent20V(uint8_t * errorCode = nullptr) { reset(errorCode); return IP2366::decodePDOCurrent(readRegister<IP2366_REG_TypeC_CTL14>(errorCode)); };
+
+    // Status
+
+    bool isCharging(uint8_t * errorCode = nullptr) { reset(errorCode); return readRegister<IP2366_REG_STATE_CTL0>(errorCode) & (1 << 5); };
+    bool isChargeFull(uint8_t * errorCode = nullptr) { reset(errorCode); return readRegister<IP2366_REG_STATE_CTL0>(errorCode) & (1 << 4); };
+    bool isDischarging(uint8_t * errorCode = nullptr) { reset(errorCode); return readRegister<IP2366_REG_STATE_CTL0>(errorCode) & (1 << 3); };
+    IP2366::ChargeState getChargeState(uint8_t * errorCode = nullptr) { reset(errorCode); return static_cast<IP2366::ChargeState>(readRegister<IP2366_REG_STATE_CTL0>(errorCode) & 0x07); };
+    bool isFastCharge(uint8_t * errorCode = nullptr) { reset(errorCode); return readRegister<IP2366_REG_STATE_CTL1>(errorCode) & (1 << 6); };
+    uint8_t getChargeVoltage(uint8_t * errorCode = nullptr) { reset(errorCode); return IP2366::decodeChargeVoltage(readRegister<IP2366_REG_STATE_CTL2>(errorCode)); };
+    bool isVbusPresent(uint8_t * errorCode = nullptr) { reset(errorCode); return readRegister<IP2366_REG_STATE_CTL2>(errorCode) & (1 << 7); };
+    bool isTypeCSinkConnected(uint8_t * errorCode = nullptr) { reset(errorCode); return readRegister<IP2366_REG_TypeC_STATE>(errorCode) & (1 << 7); };
+    bool isTypeCSinkPdConnected(uint8_t * errorCode = nullptr) { reset(errorCode); return readRegister<IP2366_REG_TypeC_STATE>(errorCode) & (1 << 4); };
+    bool isVsysOverCurrent(uint8_t * errorCode = nullptr) { reset(errorCode); return readRegister<IP2366_REG_STATE_CTL3>(errorCode) & (1 << 5); };
+
+    // ADC, each value in one 2 byte burst
+
+    uint16_t getVBATVoltage(uint8_t * errorCode = nullptr) { reset(errorCode); return read16<IP2366_REG_BATVADC_DAT0>(errorCode); };
+    uint16_t getVsysVoltage(uint8_t * errorCode = nullptr) { reset(errorCode); return read16<IP2366_REG_VsysVADC_DAT0>(errorCode); };
+    uint16_t getBATCurrent(uint8_t * errorCode = nullptr) { reset(errorCode); return read16<IP2366_REG_IBATIADC_DAT0>(errorCode); };
+    uint16_t getVsysCurrent(uint8_t * errorCode = nullptr) { reset(errorCode); return read16<IP2366_REG_ISYS_IADC_DAT0>(errorCode); };
+    uint32_t getVsysPower(uint8_t * errorCode = nullptr) { reset(errorCode); return read16<IP2366_REG_Vsys_POW_DAT0>(errorCode); };
+    bool isOverHeat(uint8_t * errorCode = nullptr) { reset(errorCode); return readRegister<IP2366_REG_INTC_IADC_DAT0>(errorCode) & (1 << 7); }; // NTC current source is 80 uA, not a temperature fault
+
+    ///////// SNAPSHOTS ////////
+
+    bool readAdcSnapshot(IP2366::AdcSnapshot & snapshot, uint8_t * errorCode = nullptr)
+    {
+        reset(errorCode);
+        uint8_t vadc[4];  // 0x50 - 0x53
+        uint8_t iadc[4];  // 0x6E - 0x71
+        uint8_t other[6]; // 0x74 - 0x79
+        if (!readRegisters<IP2366_REG_BATVADC_DAT0>(vadc, sizeof(vadc), errorCode) ||
+            !readRegisters<IP2366_REG_IBATIADC_DAT0>(iadc, sizeof(iadc), errorCode) ||
+            !readRegisters<IP2366_REG_Vsys_POW_DAT0>(other, sizeof(other), errorCode))
+            return false;
+        IP2366::decodeAdcSnapshot(snapshot, vadc, iadc, other);
+        return true;
+    };
+
+    bool readStatusSnapshot(IP2366::StatusSnapshot & snapshot, uint8_t * errorCode = nullptr)
+    {
+        reset(errorCode);
+        uint8_t data[IP2366_REG_STATE_CTL3 - IP2366_REG_STATE_CTL0 + 1]; // 0x31 - 0x38
+        if (!readRegisters<IP2366_REG_STATE_CTL0>(data, sizeof(data), errorCode))
+            return false;
+        IP2366::decodeStatusSnapshot(snapshot, data);
+        return true;
+    };
+
+    IP2366::SystemStatus getSystemStatus(uint8_t * errorCode = nullptr)
+    {
+        IP2366::StatusSnapshot snapshot;
+        if (!readStatusSnapshot(snapshot, errorCode))
+            return IP2366::SystemStatus();
+        return snapshot.getSystemStatus();
+    };
+
+    ///////// REGISTERS ////////
+
+    template <uint8_t Reg>
+    uint8_t readRegister(uint8_t * errorCode = nullptr)
+    {
+        uint8_t value = 0;
+        readRegisters<Reg>(&value, 1, errorCode);
+        return value;
+    };
+
+    template <uint8_t Reg>
+    bool readRegisters(uint8_t * data, uint8_t length, uint8_t * errorCode = nullptr)
+    {
+        return check(bus.readRegisters(Address, Reg, data, length), errorCode);
+    };
+
+    template <uint8_t Reg>
+    bool writeRegister(uint8_t value, uint8_t * errorCode = nullptr)
+    {
+        return check(bus.writeRegisters(Address, Reg, &value, 1), errorCode);
+    };
+
+    // Read-modify-write of the bits in Mask; nothing is written if the read fails
+    template <uint8_t Reg, uint8_t Mask>
+    bool updateRegister(uint8_t value, uint8_t * errorCode = nullptr)
+    {
+        static_assert(Mask != 0, "empty mask");
+        uint8_t current;
+        if (Mask != 0xFF && !readRegisters<Reg>(&current, 1, errorCode))
+            return false;
+        uint8_t updated = Mask == 0xFF ? value : (uint8_t)((current & ~Mask) | (value & Mask));
+        return writeRegister<Reg>(updated, errorCode);
+    };
+
+private:
+    template <uint8_t Reg>
+    uint16_t read16(uint8_t * errorCode)
+    {
+        uint8_t data[2];
+        if (!readRegisters<Reg>(data, sizeof(data), errorCode))
+            return 0;
+        return ((uint16_t)data[1] << 8) | data[0];
+    };
+
+    static void reset(uint8_t * errorCode)
+    {
+        if (Policy::reportErrors && errorCode != nullptr)
+            *errorCode = 0; // reset error code
+    };
+
+    static bool check(uint8_t result, uint8_t * errorCode)
+    {
+        if (Policy::reportErrors && result && errorCode != nullptr)
+            *errorCode = result; // write error code only if it > 0
+        return result == 0;
+    };
+
+    Bus bus;
+};
+
+template <uint8_t Address, class Bus, class Policy>
+constexpr uint8_t StaticIP2366<Address, Bus, Policy>::address;
+
+#endif
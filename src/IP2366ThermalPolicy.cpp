@@ -0,0 +1,86 @@
+#include "IP2366ThermalPolicy.h"
+
+const IP2366ThermalPolicy::Zone IP2366ThermalPolicy::defaultZones[] = {
+    {-400, 0, IP2366::Vbus1OutputPower::W30},   // below 0 degC: no charging
+    {0, 50, IP2366::Vbus1OutputPower::W60},     // 0 - 10 degC
+    {100, 100, IP2366::Vbus1OutputPower::W140}, // 10 - 45 degC
+    {450, 50, IP2366::Vbus1OutputPower::W65},   // 45 - 50 degC
+    {500, 25, IP2366::Vbus1OutputPower::W30},   // 50 - 60 degC
+    {600, 0, IP2366::Vbus1OutputPower::W30},    // above 60 degC: no charging
+};
+const uint8_t IP2366ThermalPolicy::defaultZoneCount = sizeof(defaultZones) / sizeof(defaultZones[0]);
+
+IP2366ThermalPolicy::IP2366ThermalPolicy(IP2366 & chip, IP2366NtcConverter converter, const Zone * zones, uint8_t zoneCount,
+                                         uint16_t baseCurrent_mA, int16_t hysteresis)
+    : chip(chip), converter(converter), zones(zones), zoneCount(zoneCount), baseCurrent(baseCurrent_mA), hysteresis(hysteresis)
+{
+}
+
+bool IP2366ThermalPolicy::update()
+{
+    uint8_t errorCode = 0;
+    uint32_t resistance = chip.getNTCResistance(&errorCode);
+    if (errorCode)
+        return false;
+
+    IP2366::AdcSnapshot adc = {};
+    adc.NTCResistance = resistance;
+    return update(adc);
+}
+
+bool IP2366ThermalPolicy::update(const IP2366::AdcSnapshot & adc)
+{
+    temperature = converter(adc.NTCResistance);
+
+    // A boundary is crossed only once the temperature is half the hysteresis past it, in both directions,
+    // so a temperature sitting on a boundary does not toggle the charger and SYS_CTL3 on every update
+    uint8_t target = zoneFor(temperature);
+    if (applied && target > zone && temperature < zones[target].from + hysteresis / 2)
+        target--;
+    else if (applied && target < zone && temperature >= zones[target + 1].from - (hysteresis - hysteresis / 2))
+        target++;
+
+    if (applied && target == zone)
+        return false;
+
+    if (!apply(zones[target]))
+        return false;
+    zone = target;
+    applied = true;
+    return true;
+}
+
+uint8_t IP2366ThermalPolicy::zoneFor(int16_t temperature) const
+{
+    uint8_t index = 0;
+    while (index + 1 < zoneCount && temperature >= zones[index + 1].from)
+        index++;
+    return index;
+}
+
+bool IP2366ThermalPolicy::apply(const Zone & target)
+{
+    uint8_t errorCode = 0;
+    bool enable = target.chargePercent != 0;
+
+    if (enable != chargerEnabled || !applied)
+    {
+        chip.enableCharger(enable, &errorCode);
+        if (errorCode)
+            return false;
+        chargerEnabled = enable;
+    }
+
+    if (enable)
+    {
+        if (governor != nullptr)
+            governor->setDerating(target.chargePercent);
+        else
+            chip.setMaxInputPowerOrBatteryCurrent((uint32_t)baseCurrent * target.chargePercent / 100, &errorCode);
+        if (errorCode) // every setter clears errorCode, stop before SYS_CTL12 hides a failed derating
+            return false;
+    }
+
+    chip.setMaxOutputPower(target.outputPower, &errorCode);
+    return errorCode == 0;
+}
@@ -0,0 +1,55 @@
+#ifndef IP2366_THERMAL_POLICY_H
+#define IP2366_THERMAL_POLICY_H
+
+#include "IP2366.h"
+#include "IP2366Ntc.h"
+#include "IP2366PowerGovernor.h"
+
+// JEITA-style thermal derating.
+// The NTC temperature selects a zone; each zone limits the charge current to a percentage of the base
+// current (0% disables the charger) and caps the Vbus1 output power. Registers are written only when
+// the zone changes. The hysteresis is a dead band centred on each zone boundary: heating or cooling across
+// a boundary takes effect only once the temperature is half the hysteresis past it.
+class IP2366ThermalPolicy
+{
+public:
+    struct Zone
+    {
+        int16_t from;                          // zone applies from this temperature up, 0.1 degC
+        uint8_t chargePercent;                 // % of the base charge current, 0 - charger disabled
+        IP2366::Vbus1OutputPower outputPower;
+    };
+
+    static const Zone defaultZones[];
+    static const uint8_t defaultZoneCount;
+
+    IP2366ThermalPolicy(IP2366 & chip, IP2366NtcConverter converter, const Zone * zones = defaultZones, uint8_t zoneCount = defaultZoneCount,
+                        uint16_t baseCurrent_mA = 5000, int16_t hysteresis = 20);
+
+    void setGovernor(IP2366PowerGovernor * governor) { this->governor = governor; }; // derate through the governor instead of SYS_CTL3
+
+    bool update();                                // call from loop(), returns true when the zone changed
+    bool update(const IP2366::AdcSnapshot & adc); // same, with a snapshot taken elsewhere
+
+    int16_t getTemperature() const { return temperature; }; // 0.1 degC
+    uint8_t getZone() const { return zone; };
+    const Zone & getZoneConfig() const { return zones[zone]; };
+
+private:
+    uint8_t zoneFor(int16_t temperature) const;
+    bool apply(const Zone & target);
+
+    IP2366 & chip;
+    IP2366NtcConverter converter;
+    const Zone * zones;
+    uint8_t zoneCount;
+    uint16_t baseCurrent;
+    int16_t hysteresis;
+    IP2366PowerGovernor * governor = nullptr;
+    int16_t temperature = 0;
+    uint8_t zone = 0;
+    bool applied = false;
+    bool chargerEnabled = true;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "IP2366Trace.h"
+#include "IP2366Platform.h"
+#include <string.h>
+
+// Reader
+
+bool IP2366TraceReader::next(IP2366TraceRecord & record)
+{
+    if (position + IP2366_TRACE_HEADER_SIZE > size)
+        return false;
+
+    const uint8_t * header = trace + position;
+    uint8_t length = header[6];
+    if (position + IP2366_TRACE_HEADER_SIZE + length > size)
+        return false; // truncated record
+
+    record.timestamp = (uint32_t)header[0] | ((uint32_t)header[1] << 8) | ((uint32_t)header[2] << 16) | ((uint32_t)header[3] << 24);
+    record.read = header[4] & IP2366_TRACE_READ;
+    record.address = header[4] & 0x7F;
+    record.regAddress = header[5];
+    record.length = length;
+    record.error = header[7];
+    record.payload = header + IP2366_TRACE_HEADER_SIZE;
+
+    position += IP2366_TRACE_HEADER_SIZE + length;
+    return true;
+}
+
+// Recorder
+
+void IP2366TraceBus::append(uint8_t address, bool read, uint8_t regAddress, const uint8_t * data, uint8_t length, uint8_t error)
+{
+    if (!recording)
+        return;
+
+    if (used + IP2366_TRACE_HEADER_SIZE + length > capacity)
+    {
+        dropped++;
+        return;
+    }
+
+    uint32_t timestamp = micros();
+    uint8_t * header = buffer + used;
+    header[0] = timestamp;
+    header[1] = timestamp >> 8;
+    header[2] = timestamp >> 16;
+    header[3] = timestamp >> 24;
+    header[4] = (address & 0x7F) | (read ? IP2366_TRACE_READ : 0);
+    header[5] = regAddress;
+    header[6] = length;
+    header[7] = error;
+    memcpy(header + IP2366_TRACE_HEADER_SIZE, data, length);
+
+    used += IP2366_TRACE_HEADER_SIZE + length;
+}
+
+uint8_t IP2366TraceBus::writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length)
+{
+    uint8_t error = inner.writeRegisters(address, regAddress, data, length);
+    append(address, false, regAddress, data, length, error);
+    return error;
+}
+
+uint8_t IP2366TraceBus::readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length)
+{
+    uint8_t error = inner.readRegisters(address, regAddress, data, length);
+    append(address, true, regAddress, data, length, error);
+    return error;
+}
+
+// Replay
+
+bool IP2366ReplayBus::match(uint8_t address, bool read, uint8_t regAddress, uint8_t length, IP2366TraceRecord & record)
+{
+    transactions++;
+    if (!reader.next(record))
+    {
+        mismatches++;
+        return false;
+    }
+    lastTimestamp = record.timestamp;
+
+    if (record.address != address || record.read != read || record.regAddress != regAddress || record.length != length)
+    {
+        mismatches++;
+        return false;
+    }
+    return true;
+}
+
+uint8_t IP2366ReplayBus::writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length)
+{
+    IP2366TraceRecord record;
+    if (!match(address, false, regAddress, length, record))
+        return 4; // other error
+
+    if (memcmp(record.payload, data, length) != 0)
+        mismatches++;
+
+    return record.error;
+}
+
+uint8_t IP2366ReplayBus::readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length)
+{
+    IP2366TraceRecord record;
+    if (!match(address, true, regAddress, length, record))
+    {
+        memset(data, 0xFF, length);
+        return 4; // other error
+    }
+
+    memcpy(data, record.payload, length);
+    return record.error;
+}
+
+void IP2366ReplayBus::rewind()
+{
+    reader.rewind();
+    mismatches = 0;
+    transactions = 0;
+    lastTimestamp = 0;
+}
+
+bool IP2366ReplayBus::isFinished() const
+{
+    IP2366TraceReader probe = reader;
+    IP2366TraceRecord record;
+    return !probe.next(record);
+}
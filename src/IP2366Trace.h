@@ -0,0 +1,102 @@
+#ifndef IP2366_TRACE_H
+#define IP2366_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "IP2366Bus.h"
+
+// Binary trace format (little-endian), one record per bus transaction:
+//   [0..3] timestamp, us (micros())
+//   [4]    bit 7 - direction (1 = read, 0 = write), bits 6:0 - device address
+//   [5]    register address
+//   [6]    payload length
+//   [7]    error code (Wire.endTransmission() codes, 0 = success)
+//   [8..]  payload (data written, or data returned by the read)
+#define IP2366_TRACE_HEADER_SIZE 8
+#define IP2366_TRACE_READ 0x80
+
+struct IP2366TraceRecord
+{
+    uint32_t timestamp;
+    uint8_t address;
+    bool read;
+    uint8_t regAddress;
+    uint8_t length;
+    uint8_t error;
+    const uint8_t * payload;
+};
+
+// Walks a recorded trace record by record
+class IP2366TraceReader
+{
+public:
+    IP2366TraceReader(const uint8_t * trace, size_t size) : trace(trace), size(size), position(0) {};
+
+    bool next(IP2366TraceRecord & record);
+    void rewind() { position = 0; };
+    size_t getPosition() const { return position; };
+
+private:
+    const uint8_t * trace;
+    size_t size;
+    size_t position;
+};
+
+// Recording decorator: forwards every transaction to the inner bus and appends it to a caller-supplied buffer
+class IP2366TraceBus : public IP2366Bus
+{
+public:
+    IP2366TraceBus(IP2366Bus & inner, uint8_t * buffer, size_t capacity)
+        : inner(inner), buffer(buffer), capacity(capacity), used(0), dropped(0), recording(true) {};
+
+    void begin() override { inner.begin(); };
+    uint8_t writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length) override;
+    uint8_t readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length) override;
+
+    void setRecording(bool enable) { recording = enable; };
+    void clear() { used = 0; dropped = 0; };
+
+    const uint8_t * getData() const { return buffer; };
+    size_t getSize() const { return used; };
+    uint32_t getDropped() const { return dropped; }; // transactions that did not fit into the buffer
+
+private:
+    void append(uint8_t address, bool read, uint8_t regAddress, const uint8_t * data, uint8_t length, uint8_t error);
+
+    IP2366Bus & inner;
+    uint8_t * buffer;
+    size_t capacity;
+    size_t used;
+    uint32_t dropped;
+    bool recording;
+};
+
+// Replay backend: serves the driver from a recorded trace instead of a real chip.
+// Transactions are matched in order; a read returns the recorded payload and error code,
+// a write is compared against the recorded payload. Any divergence is counted as a mismatch.
+class IP2366ReplayBus : public IP2366Bus
+{
+public:
+    IP2366ReplayBus(const uint8_t * trace, size_t size) : reader(trace, size), mismatches(0), transactions(0), lastTimestamp(0) {};
+
+    uint8_t writeRegisters(uint8_t address, uint8_t regAddress, const uint8_t * data, uint8_t length) override;
+    uint8_t readRegisters(uint8_t address, uint8_t regAddress, uint8_t * data, uint8_t length) override;
+
+    void rewind();
+    bool isFinished() const;
+
+    uint32_t getMismatches() const { return mismatches; };
+    uint32_t getTransactions() const { return transactions; };
+    uint32_t getLastTimestamp() const { return lastTimestamp; }; // timestamp of the last replayed record, us
+
+private:
+    bool match(uint8_t address, bool read, uint8_t regAddress, uint8_t length, IP2366TraceRecord & record);
+
+    IP2366TraceReader reader;
+    uint32_t mismatches;
+    uint32_t transactions;
+    uint32_t lastTimestamp;
+};
+
+#endif